@@ -40,7 +40,10 @@ namespace xpp {
  */
 class InverseKinematicsHyq1 : public InverseKinematics {
 public:
-  InverseKinematicsHyq1() = default;
+  /**
+   * @brief Uses the leg geometry generated from the robot's URDF.
+   */
+  InverseKinematicsHyq1();
   virtual ~InverseKinematicsHyq1() = default;
 
   /**
@@ -49,6 +52,16 @@ public:
    */
   Joints GetAllJointAngles(const EndeffectorsPos& pos_B) const override;
 
+  /**
+   * @brief The analytic foot Jacobians expressed in the base frame (B).
+   */
+  Jacobians GetJacobians(const Joints& q) const override;
+
+  /**
+   * @brief The time derivatives of GetJacobians() for joint velocities qd.
+   */
+  Jacobians GetJacobianDerivatives(const Joints& q, const Joints& qd) const override;
+
   /**
    * @brief Number of endeffectors (feet, hands) this implementation expects.
    */
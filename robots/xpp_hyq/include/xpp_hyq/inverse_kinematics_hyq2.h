@@ -41,7 +41,10 @@ namespace xpp {
  */
 class InverseKinematicsHyq2 : public InverseKinematics {
 public:
-  InverseKinematicsHyq2() = default;
+  /**
+   * @brief Uses the leg geometry generated from the robot's URDF.
+   */
+  InverseKinematicsHyq2();
   virtual ~InverseKinematicsHyq2() = default;
 
   /**
@@ -50,6 +53,16 @@ public:
    */
   Joints GetAllJointAngles(const EndeffectorsPos& pos_B) const override;
 
+  /**
+   * @brief The analytic foot Jacobians expressed in the base frame (B).
+   */
+  Jacobians GetJacobians(const Joints& q) const override;
+
+  /**
+   * @brief The time derivatives of GetJacobians() for joint velocities qd.
+   */
+  Jacobians GetJacobianDerivatives(const Joints& q, const Joints& qd) const override;
+
   /**
    * @brief Number of endeffectors (feet, hands) this implementation expects.
    */
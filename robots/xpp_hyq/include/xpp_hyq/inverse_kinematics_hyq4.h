@@ -40,7 +40,10 @@ namespace xpp {
  */
 class InverseKinematicsHyq4 : public InverseKinematics {
 public:
-  InverseKinematicsHyq4() = default;
+  /**
+   * @brief Uses the leg geometry generated from the robot's URDF.
+   */
+  InverseKinematicsHyq4();
   virtual ~InverseKinematicsHyq4() = default;
 
   /**
@@ -49,13 +52,22 @@ public:
    */
   Joints GetAllJointAngles(const EndeffectorsPos& pos_b) const override;
 
+  /**
+   * @brief The analytic foot Jacobians expressed in the base frame (B).
+   */
+  Jacobians GetJacobians(const Joints& q) const override;
+
+  /**
+   * @brief The time derivatives of GetJacobians() for joint velocities qd.
+   */
+  Jacobians GetJacobianDerivatives(const Joints& q, const Joints& qd) const override;
+
   /**
    * @brief Number of endeffectors (feet, hands) this implementation expects.
    */
   int GetEECount() const override { return 4; };
 
 private:
-  Vector3d base2hip_LF_ = Vector3d(0.3735, 0.207, 0.0);
   HyqlegInverseKinematics leg;
 };
 
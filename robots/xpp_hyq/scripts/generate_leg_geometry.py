@@ -0,0 +1,169 @@
+#!/usr/bin/env python
+"""
+Generates the geometry of HyQ legs from a URDF as C++ compile-time constants.
+
+Usage: generate_leg_geometry.py robot.urdf[.xacro] name root_link foot_link... -o out.h
+
+Walks the kinematic chain from root_link to every foot_link and checks that
+it has the structure HyqlegInverseKinematics solves for: a hip
+abduction/adduction joint (HAA) around x, followed by hip and knee
+flexion/extension joints (HFE, KFE) around y, with the leg pointing straight
+down for zero joint angles. All fixed transforms of the URDF are evaluated
+here, so the generated header contains only the resulting lengths and the
+HAA position of every leg in the root frame.
+"""
+
+from __future__ import print_function
+
+import argparse
+import math
+import os
+import sys
+import xml.etree.ElementTree as ET
+
+TOLERANCE = 1e-6
+
+
+def load_urdf(path):
+    if path.endswith('.xacro'):
+        import xacro
+        return ET.fromstring(xacro.process_file(path, in_order=True).toxml())
+    return ET.parse(path).getroot()
+
+
+def matmul(A, B):
+    return [[sum(A[i][k]*B[k][j] for k in range(4)) for j in range(4)] for i in range(4)]
+
+
+def get_transform(xyz, rpy):
+    """Homogeneous transform of a URDF origin (fixed axes X, then Y, then Z)."""
+    r, p, y = rpy
+    cr, sr = math.cos(r), math.sin(r)
+    cp, sp = math.cos(p), math.sin(p)
+    cy, sy = math.cos(y), math.sin(y)
+    return [[cy*cp, cy*sp*sr - sy*cr, cy*sp*cr + sy*sr, xyz[0]],
+            [sy*cp, sy*sp*sr + cy*cr, sy*sp*cr - cy*sr, xyz[1]],
+            [-sp,   cp*sr,            cp*cr,            xyz[2]],
+            [0.0,   0.0,              0.0,              1.0]]
+
+
+def get_vector(element, attribute, default):
+    if element is None or element.get(attribute) is None:
+        return default
+    return [float(v) for v in element.get(attribute).split()]
+
+
+def distance(a, b):
+    return math.sqrt(sum((x-y)**2 for x, y in zip(a, b)))
+
+
+def is_parallel(axis, unit):
+    return abs(abs(sum(a*u for a, u in zip(axis, unit))) - 1.0) < TOLERANCE
+
+
+def is_below(upper, lower):
+    return abs(upper[0]-lower[0]) < TOLERANCE and abs(upper[1]-lower[1]) < TOLERANCE \
+        and lower[2] < upper[2]
+
+
+def get_leg(urdf, root_link, foot_link):
+    """Returns HAA position, HAA->HFE distance, thigh and shank length."""
+    joint_of_child = dict((j.find('child').get('link'), j) for j in urdf.findall('joint'))
+
+    chain = []
+    link = foot_link
+    while link != root_link:
+        if link not in joint_of_child:
+            sys.exit('error: %s is not attached to %s' % (foot_link, root_link))
+        chain.insert(0, joint_of_child[link])
+        link = chain[0].find('parent').get('link')
+
+    # joint positions and axes in the root frame for zero joint angles
+    T = get_transform([0, 0, 0], [0, 0, 0])
+    positions, axes = [], []
+    for joint in chain:
+        origin = joint.find('origin')
+        T = matmul(T, get_transform(get_vector(origin, 'xyz', [0, 0, 0]),
+                                    get_vector(origin, 'rpy', [0, 0, 0])))
+        if joint.get('type') == 'fixed':
+            continue
+        if joint.get('type') not in ('revolute', 'continuous'):
+            sys.exit('error: joint %s is not revolute' % joint.get('name'))
+        axis = get_vector(joint.find('axis'), 'xyz', [1, 0, 0])
+        positions.append([T[i][3] for i in range(3)])
+        axes.append([sum(T[i][k]*axis[k] for k in range(3)) for i in range(3)])
+    foot = [T[i][3] for i in range(3)]
+
+    if len(positions) != 3:
+        sys.exit('error: %s has %d instead of 3 joints' % (foot_link, len(positions)))
+    haa, hfe, kfe = positions
+    if not (is_parallel(axes[0], [1, 0, 0]) and is_parallel(axes[1], [0, 1, 0])
+            and is_parallel(axes[2], [0, 1, 0])):
+        sys.exit('error: joint axes of %s are not x, y, y' % foot_link)
+    if not (is_below(haa, hfe) and is_below(hfe, kfe) and is_below(kfe, foot)):
+        sys.exit('error: %s is not pointing straight down for zero joint angles' % foot_link)
+
+    return haa, distance(haa, hfe), distance(hfe, kfe), distance(kfe, foot)
+
+
+def fmt(value):
+    return repr(round(value, 10) + 0.0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generates HyQ leg geometry constants from a URDF.')
+    parser.add_argument('urdf')
+    parser.add_argument('name', help='C++ namespace (inside xpp) of the constants')
+    parser.add_argument('root_link')
+    parser.add_argument('foot_links', nargs='+')
+    parser.add_argument('-o', '--output', required=True)
+    args = parser.parse_args()
+
+    urdf = load_urdf(args.urdf)
+    legs = [get_leg(urdf, args.root_link, foot) for foot in args.foot_links]
+
+    # a robot uses one HyqlegInverseKinematics for all legs
+    dims = legs[0][1:]
+    for foot, leg in zip(args.foot_links, legs):
+        if any(abs(a-b) > TOLERANCE for a, b in zip(leg[1:], dims)):
+            sys.exit('error: %s has different dimensions than %s' % (foot, args.foot_links[0]))
+
+    guard = 'XPP_HYQ_%s_GEOMETRY_H_' % args.name.upper()
+    lines = [
+        '// Generated by generate_leg_geometry.py from %s, do not edit.' % os.path.basename(args.urdf),
+        '',
+        '#ifndef %s' % guard,
+        '#define %s' % guard,
+        '',
+        '#include <xpp_hyq/hyqleg_inverse_kinematics.h>',
+        '',
+        'namespace xpp {',
+        'namespace %s {' % args.name,
+        '',
+        '/// dimensions shared by all legs [m].',
+        'constexpr HyqlegGeometry kLegGeometry = { %s, %s, %s };' % tuple(fmt(d) for d in dims),
+        '',
+        '/// position of the HAA joint of every leg in the %s frame [m].' % args.root_link,
+        'constexpr double kBaseToHaa[%d][3] = {' % len(legs),
+    ]
+    for foot, leg in zip(args.foot_links, legs):
+        lines.append('  { %s, %s, %s }, // %s' % (fmt(leg[0][0]), fmt(leg[0][1]), fmt(leg[0][2]), foot))
+    lines += [
+        '};',
+        '',
+        '} /* namespace %s */' % args.name,
+        '} /* namespace xpp */',
+        '',
+        '#endif /* %s */' % guard,
+        '',
+    ]
+
+    output_dir = os.path.dirname(args.output)
+    if output_dir and not os.path.isdir(output_dir):
+        os.makedirs(output_dir)
+    with open(args.output, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+if __name__ == '__main__':
+    main()
@@ -47,6 +47,8 @@ int main(int argc, char *argv[])
   CartesianJointConverter inv_kin_converter(ik,
 					    xpp_msgs::robot_state_desired,
 					    joint_desired_mono);
+  inv_kin_converter.SubscribeTrajectory(xpp_msgs::robot_trajectory_desired,
+                                        "xpp/joint_trajectory_mono_des");
 
   std::vector<UrdfVisualizer::URDFName> joint_names(HyqlegJointCount);
   joint_names.at(HAA) = "haa_joint";
@@ -50,6 +50,8 @@ int main(int argc, char *argv[])
   CartesianJointConverter inv_kin_converter(ik,
 					    xpp_msgs::robot_state_desired,
 					    joint_desired_biped);
+  inv_kin_converter.SubscribeTrajectory(xpp_msgs::robot_trajectory_desired,
+                                        "xpp/joint_trajectory_biped_des");
 
   int n_ee = ik->GetEECount();
   int n_j  = HyqlegJointCount;
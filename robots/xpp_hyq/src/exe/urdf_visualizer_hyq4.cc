@@ -33,12 +33,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string>
 
 #include <ros/init.h>
+#include <ros/node_handle.h>
 
 #include <xpp_hyq/inverse_kinematics_hyq4.h>
 #include <xpp_msgs/topic_names.h>
 #include <xpp_states/joints.h>
 #include <xpp_states/endeffector_mappings.h>
 
+#include <xpp_vis/cached_inverse_kinematics.h>
 #include <xpp_vis/cartesian_joint_converter.h>
 #include <xpp_vis/urdf_visualizer.h>
 
@@ -51,10 +53,25 @@ int main(int argc, char *argv[])
 
   const std::string joint_desired_hyq = "xpp/joint_hyq_des";
 
-  auto hyq_ik = std::make_shared<InverseKinematicsHyq4>();
+  InverseKinematics::Ptr hyq_ik = std::make_shared<InverseKinematicsHyq4>();
+
+  // reuse the joint angles of repeated foot positions, e.g. of looping bags.
+  double cache_resolution = 0.0;
+  int cache_capacity = 4096;
+  ::ros::NodeHandle("~").getParam("ik_cache_resolution", cache_resolution);
+  ::ros::NodeHandle("~").getParam("ik_cache_capacity", cache_capacity);
+  std::shared_ptr<CachedInverseKinematics> cached_ik;
+  if (cache_resolution > 0.0) {
+    cached_ik = std::make_shared<CachedInverseKinematics>(hyq_ik, cache_resolution,
+                                                          cache_capacity);
+    hyq_ik = cached_ik;
+  }
+
   CartesianJointConverter inv_kin_converter(hyq_ik,
 					    xpp_msgs::robot_state_desired,
 					    joint_desired_hyq);
+  inv_kin_converter.SubscribeTrajectory(xpp_msgs::robot_trajectory_desired,
+                                        "xpp/joint_trajectory_hyq_des");
 
   // urdf joint names
   int n_ee = hyq_ik->GetEECount();
@@ -79,6 +96,12 @@ int main(int argc, char *argv[])
 
   ::ros::spin();
 
+  if (cached_ik) {
+    auto stats = cached_ik->GetStats();
+    std::cout << "IK cache: " << stats.hits << " hits, " << stats.misses
+              << " misses (" << 100*stats.GetHitRate() << "%)" << std::endl;
+  }
+
   return 1;
 }
 
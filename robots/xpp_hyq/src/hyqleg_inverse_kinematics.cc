@@ -29,14 +29,23 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <xpp_hyq/hyqleg_inverse_kinematics.h>
 
+#include <algorithm>
 #include <cmath>
-#include <map>
 
 #include <xpp_states/cartesian_declarations.h>
 
 
 namespace xpp {
 
+constexpr double HyqlegInverseKinematics::kMinAngle[];
+constexpr double HyqlegInverseKinematics::kMaxAngle[];
+
+HyqlegInverseKinematics::HyqlegInverseKinematics (const HyqlegGeometry& geometry)
+    : hfe_to_haa_z(0.0, 0.0, geometry.haa_to_hfe),
+      length_thigh(geometry.length_thigh),
+      length_shank(geometry.length_shank)
+{
+}
 
 HyqlegInverseKinematics::Vector3d
 HyqlegInverseKinematics::GetJointAngles (const Vector3d& ee_pos_B, KneeBend bend) const
@@ -115,38 +124,205 @@ HyqlegInverseKinematics::GetJointAngles (const Vector3d& ee_pos_B, KneeBend bend
     return Vector3d(q_HAA_br, -q_HFE_br, -q_KFE_br);
 }
 
+// In the HFE frame the foot lies in the x-z plane at
+//   px = -lu*sin(q1) - ll*sin(q1+q2)
+//   pz = -lu*cos(q1) - ll*cos(q1+q2),
+// which is rotated by q0 around X into the hip-aa frame:
+//   ee_pos_H = (px, sin(q0)*(pz-h), cos(q0)*(pz-h)).
+// The backward knee bend is the mirrored solution with negated HFE, KFE.
+static const Eigen::Vector3d kBackward(1.0, -1.0, -1.0);
+
+HyqlegInverseKinematics::Vector3d
+HyqlegInverseKinematics::GetFootPosition (const Vector3d& q_in, KneeBend bend) const
+{
+  Vector3d q = bend == Forward? q_in : q_in.cwiseProduct(kBackward);
+  double lu = length_thigh;
+  double ll = length_shank;
+
+  double px = -lu*sin(q[HFE]) - ll*sin(q[HFE]+q[KFE]);
+  double zz = -lu*cos(q[HFE]) - ll*cos(q[HFE]+q[KFE]) - hfe_to_haa_z.z();
+  return Vector3d(px, sin(q[HAA])*zz, cos(q[HAA])*zz);
+}
+
+HyqlegInverseKinematics::Matrix3d
+HyqlegInverseKinematics::GetJacobian (const Vector3d& q_in, KneeBend bend) const
+{
+  Vector3d q = bend == Forward? q_in : q_in.cwiseProduct(kBackward);
+  double lu = length_thigh;
+  double ll = length_shank;
+
+  double s0 = sin(q[HAA]), c0 = cos(q[HAA]);
+  double s1 = sin(q[HFE]), c1 = cos(q[HFE]);
+  double s12 = sin(q[HFE]+q[KFE]), c12 = cos(q[HFE]+q[KFE]);
+  double zz = -lu*c1 - ll*c12 - hfe_to_haa_z.z();
+
+  // derivatives of px and pz w.r.t. q1 and q2
+  double px1 = -lu*c1 - ll*c12, px2 = -ll*c12;
+  double pz1 =  lu*s1 + ll*s12, pz2 =  ll*s12;
+
+  Matrix3d J;
+  J <<  0.0,     px1,    px2,
+        c0*zz,   s0*pz1, s0*pz2,
+       -s0*zz,   c0*pz1, c0*pz2;
+
+  // chain rule for the negated joints
+  return bend == Forward? J : J*kBackward.asDiagonal();
+}
+
+HyqlegInverseKinematics::Matrix3d
+HyqlegInverseKinematics::GetJacobianDerivative (const Vector3d& q_in,
+                                                const Vector3d& qd_in,
+                                                KneeBend bend) const
+{
+  Vector3d q  = bend == Forward? q_in  : q_in.cwiseProduct(kBackward);
+  Vector3d qd = bend == Forward? qd_in : qd_in.cwiseProduct(kBackward);
+  double lu = length_thigh;
+  double ll = length_shank;
+
+  double s0 = sin(q[HAA]), c0 = cos(q[HAA]);
+  double s1 = sin(q[HFE]), c1 = cos(q[HFE]);
+  double s12 = sin(q[HFE]+q[KFE]), c12 = cos(q[HFE]+q[KFE]);
+  double zz = -lu*c1 - ll*c12 - hfe_to_haa_z.z();
+
+  double pz1 =  lu*s1 + ll*s12, pz2 =  ll*s12;
+
+  // time derivatives of the above
+  double qd12 = qd[HFE] + qd[KFE];
+  double px1d = lu*s1*qd[HFE] + ll*s12*qd12, px2d = ll*s12*qd12;
+  double pz1d = lu*c1*qd[HFE] + ll*c12*qd12, pz2d = ll*c12*qd12;
+  double zzd  = pz1*qd[HFE] + pz2*qd[KFE];
+  double s0d  = c0*qd[HAA], c0d = -s0*qd[HAA];
+
+  Matrix3d Jd;
+  Jd <<  0.0,              px1d,                 px2d,
+         c0d*zz + c0*zzd,  s0d*pz1 + s0*pz1d,    s0d*pz2 + s0*pz2d,
+        -s0d*zz - s0*zzd,  c0d*pz1 + c0*pz1d,    c0d*pz2 + c0*pz2d;
+
+  return bend == Forward? Jd : Jd*kBackward.asDiagonal();
+}
+
 void
 HyqlegInverseKinematics::EnforceLimits (double& val, HyqJointID joint) const
 {
-  // totally exaggerated joint angle limits
-  const static double haa_min = -180;
-  const static double haa_max =  90;
-
-  const static double hfe_min = -90;
-  const static double hfe_max =  90;
-
-  const static double kfe_min = -180;
-  const static double kfe_max =  0;
-
-  // reduced joint angles for optimization
-  static const std::map<HyqJointID, double> max_range {
-    {HAA, haa_max/180.0*M_PI},
-    {HFE, hfe_max/180.0*M_PI},
-    {KFE, kfe_max/180.0*M_PI}
-  };
-
-  // reduced joint angles for optimization
-  static const std::map<HyqJointID, double> min_range {
-    {HAA, haa_min/180.0*M_PI},
-    {HFE, hfe_min/180.0*M_PI},
-    {KFE, kfe_min/180.0*M_PI}
-  };
-
-  double max = max_range.at(joint);
-  val = val>max? max : val;
-
-  double min = min_range.at(joint);
-  val = val<min? min : val;
+  val = std::min(std::max(val, kMinAngle[joint]), kMaxAngle[joint]);
+}
+
+// Cephes rational approximation of atan(a) for a in [0,1], which is accurate
+// to machine precision in double.
+template<typename Array>
+static Array
+AtanUnit (const Array& a)
+{
+  using T = typename Array::Scalar;
+  const T P[] = { -8.750608600031904122785E-1, -1.615753718733365076637E1,
+                  -7.500855792314704667340E1,  -1.228866684490136173410E2,
+                  -6.485021904942025371773E1 };
+  const T Q[] = {  2.485846490142306297962E1,   1.650270098316988542046E2,
+                   4.328810604912902668951E2,   4.853903996359136964868E2,
+                   1.945506571482613964425E2 };
+
+  // atan(a) = pi/4 + atan((a-1)/(a+1)) keeps the argument small
+  auto large = a > T(0.66);
+  Array u = large.select((a - T(1))/(a + T(1)), a);
+  Array z = u.square();
+
+  Array p = Array::Constant(P[0]);
+  Array q = z + Q[0];
+  for (int i=1; i<5; ++i) {
+    p = p*z + P[i];
+    q = q*z + Q[i];
+  }
+
+  return u + u*z*p/q + large.select(Array::Constant(T(M_PI/4)), Array::Zero());
+}
+
+template<typename Array>
+static Array
+Atan2 (const Array& y, const Array& x)
+{
+  using T = typename Array::Scalar;
+  Array ax = x.abs();
+  Array ay = y.abs();
+  Array mx = ax.max(ay);
+
+  Array r = AtanUnit<Array>((mx > T(0)).select(ax.min(ay)/mx, Array::Zero()));
+  r = (ay > ax).select(T(M_PI/2) - r, r);
+  r = (x < T(0)).select(T(M_PI) - r, r);
+  return (y < T(0)).select(-r, r);
+}
+
+// acos(c) for c in [-1,1]
+template<typename Array>
+static Array
+Acos (const Array& c)
+{
+  using T = typename Array::Scalar;
+  return Atan2<Array>(((T(1) - c)*(T(1) + c)).sqrt(), c);
+}
+
+template<typename T>
+Eigen::Matrix<T,3,Eigen::Dynamic>
+HyqlegInverseKinematics::SolveBatch (const Eigen::Matrix<T,3,Eigen::Dynamic>& ee_pos_H,
+                                     KneeBend bend) const
+{
+  // fixed-size blocks stay in cache and need no allocations
+  static constexpr int kBlock = 64;
+  using Array = Eigen::Array<T,1,kBlock>;
+
+  const T lu = length_thigh;
+  const T ll = length_shank;
+  const T sign = bend == Forward? T(1) : T(-1);
+
+  int n = ee_pos_H.cols();
+  Eigen::Matrix<T,3,Eigen::Dynamic> q(3, n);
+
+  for (int first=0; first<n; first+=kBlock) {
+    int size = std::min(kBlock, n-first);
+
+    // the last block is padded with a regular foot position
+    Array x = Array::Zero(), y = Array::Zero(), z = Array::Constant(T(-0.5));
+    x.head(size) = ee_pos_H.row(X).segment(first, size).array();
+    y.head(size) = ee_pos_H.row(Y).segment(first, size).array();
+    z.head(size) = ee_pos_H.row(Z).segment(first, size).array();
+
+    Array q_HAA = -Atan2<Array>(y, -z);
+
+    // the rotation by q_HAA around X moves the foot into the x-z plane,
+    // so instead of building the rotation matrix only z changes.
+    Array zr = T(hfe_to_haa_z.z()) - (y.square() + z.square()).sqrt();
+
+    Array tmp1  = x.square() + zr.square();
+    Array alpha = Atan2<Array>(-zr, x) - T(0.5*M_PI);
+
+    // tmp1=0 results in inf, which is clamped as in the single foot version
+    Array cos_beta  = ((lu*lu + tmp1 - ll*ll)/(2*lu*tmp1.sqrt())).min(T(1)).max(T(-1));
+    Array cos_gamma = ((ll*ll + lu*lu - tmp1)/(2*ll*lu)).min(T(1)).max(T(-1));
+
+    Array q_HFE = alpha + Acos<Array>(cos_beta);
+    Array q_KFE = Acos<Array>(cos_gamma) - T(M_PI);
+
+    q_HAA = q_HAA.min(T(kMaxAngle[HAA])).max(T(kMinAngle[HAA]));
+    q_HFE = q_HFE.min(T(kMaxAngle[HFE])).max(T(kMinAngle[HFE]));
+    q_KFE = q_KFE.min(T(kMaxAngle[KFE])).max(T(kMinAngle[KFE]));
+
+    q.row(HAA).segment(first, size) = q_HAA.head(size).matrix();
+    q.row(HFE).segment(first, size) = sign*q_HFE.head(size).matrix();
+    q.row(KFE).segment(first, size) = sign*q_KFE.head(size).matrix();
+  }
+
+  return q;
+}
+
+HyqlegInverseKinematics::Matrix3Xd
+HyqlegInverseKinematics::GetJointAnglesBatch (const Matrix3Xd& ee_pos_H, KneeBend bend) const
+{
+  return SolveBatch<double>(ee_pos_H, bend);
+}
+
+HyqlegInverseKinematics::Matrix3Xf
+HyqlegInverseKinematics::GetJointAnglesBatch (const Matrix3Xf& ee_pos_H, KneeBend bend) const
+{
+  return SolveBatch<float>(ee_pos_H, bend);
 }
 
 } /* namespace xpp */
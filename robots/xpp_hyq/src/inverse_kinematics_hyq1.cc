@@ -28,19 +28,43 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ******************************************************************************/
 
 #include <xpp_hyq/inverse_kinematics_hyq1.h>
+#include <xpp_hyq/hyq1_geometry.h>
 
 #include <cmath>
 #include <iostream>
 
 namespace xpp {
 
+InverseKinematicsHyq1::InverseKinematicsHyq1 ()
+    : leg(hyq1::kLegGeometry)
+{
+}
+
 Joints
 InverseKinematicsHyq1::GetAllJointAngles(const EndeffectorsPos& x_B) const
 {
-  Eigen::Vector3d offset_base_to_hip(0.0, 0.0, 0.15);
-  Eigen::VectorXd q0 = leg.GetJointAngles(x_B.at(0) + offset_base_to_hip);
+  Eigen::Map<const Vector3d> base2hip(hyq1::kBaseToHaa[0]);
+  Joints q(GetEECount(), HyqlegJointCount);
+  q.at(0) = leg.GetJointAngles(x_B.at(0) - base2hip);
+
+  return q;
+}
 
-  return Joints({q0});
+InverseKinematics::Jacobians
+InverseKinematicsHyq1::GetJacobians(const Joints& q) const
+{
+  // the hip is only translated w.r.t. the base, so J_B = J_H
+  Jacobians J(GetEECount());
+  J.at(0) = leg.GetJacobian(q.at(0));
+  return J;
+}
+
+InverseKinematics::Jacobians
+InverseKinematicsHyq1::GetJacobianDerivatives(const Joints& q, const Joints& qd) const
+{
+  Jacobians Jd(GetEECount());
+  Jd.at(0) = leg.GetJacobianDerivative(q.at(0), qd.at(0));
+  return Jd;
 }
 
 
@@ -28,6 +28,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ******************************************************************************/
 
 #include <xpp_hyq/inverse_kinematics_hyq2.h>
+#include <xpp_hyq/hyq2_geometry.h>
 
 #include <cmath>
 #include <iostream>
@@ -37,21 +38,48 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xpp {
 
+InverseKinematicsHyq2::InverseKinematicsHyq2 ()
+    : leg(hyq2::kLegGeometry)
+{
+}
+
 Joints
 InverseKinematicsHyq2::GetAllJointAngles(const EndeffectorsPos& x_B) const
 {
   using namespace biped;
-  std::vector<Eigen::VectorXd> q_vec;
+  Joints q(GetEECount(), HyqlegJointCount);
 
   // make sure always exactly 2 elements
   auto x_biped_B = x_B.ToImpl();
   x_biped_B.resize(2, x_biped_B.front());
 
-  q_vec.push_back(leg.GetJointAngles(x_biped_B.at(L) + Vector3d(0.0, -0.1, 0.15)));
-  q_vec.push_back(leg.GetJointAngles(x_biped_B.at(R) + Vector3d(0.0,  0.1, 0.15)));
+  for (auto ee : {L, R}) {
+    Eigen::Map<const Vector3d> base2hip(hyq2::kBaseToHaa[ee]);
+    q.at(ee) = leg.GetJointAngles(x_biped_B.at(ee) - base2hip);
+  }
+
+  return q;
+}
+
+InverseKinematics::Jacobians
+InverseKinematicsHyq2::GetJacobians(const Joints& q) const
+{
+  // the hips are only translated w.r.t. the base, so J_B = J_H
+  Jacobians J(GetEECount());
+  for (auto ee : J.GetEEsOrdered())
+    J.at(ee) = leg.GetJacobian(q.at(ee));
 
+  return J;
+}
+
+InverseKinematics::Jacobians
+InverseKinematicsHyq2::GetJacobianDerivatives(const Joints& q, const Joints& qd) const
+{
+  Jacobians Jd(GetEECount());
+  for (auto ee : Jd.GetEEsOrdered())
+    Jd.at(ee) = leg.GetJacobianDerivative(q.at(ee), qd.at(ee));
 
-  return Joints(q_vec);
+  return Jd;
 }
 
 } /* namespace xpp */
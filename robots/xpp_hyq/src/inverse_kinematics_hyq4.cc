@@ -28,51 +28,99 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ******************************************************************************/
 
 #include <xpp_hyq/inverse_kinematics_hyq4.h>
+#include <xpp_hyq/hyq4_geometry.h>
 
 #include <xpp_states/cartesian_declarations.h>
 #include <xpp_states/endeffector_mappings.h>
 
 namespace xpp {
 
+// Every HyQ leg is the left-front leg mirrored about the base's x-z and/or
+// y-z plane, with the knees of the hind legs bending backwards.
+static void
+GetLegMirror(EndeffectorID ee, Eigen::Vector3d& mirror,
+             HyqlegInverseKinematics::KneeBend& bend)
+{
+  using namespace quad;
+  bend = HyqlegInverseKinematics::Forward;
+  switch (ee) {
+    case LF:
+      mirror = Eigen::Vector3d( 1, 1,1);
+      break;
+    case RF:
+      mirror = Eigen::Vector3d( 1,-1,1);
+      break;
+    case LH:
+      mirror = Eigen::Vector3d(-1, 1,1);
+      bend = HyqlegInverseKinematics::Backward;
+      break;
+    case RH:
+      mirror = Eigen::Vector3d(-1,-1,1);
+      bend = HyqlegInverseKinematics::Backward;
+      break;
+    default: // joint angles for this foot do not exist
+      mirror = Eigen::Vector3d( 1, 1,1);
+      break;
+  }
+}
+
+InverseKinematicsHyq4::InverseKinematicsHyq4 ()
+    : leg(hyq4::kLegGeometry)
+{
+}
+
 Joints
 InverseKinematicsHyq4::GetAllJointAngles(const EndeffectorsPos& x_B) const
 {
   Vector3d ee_pos_H; // foothold expressed in hip frame
-  std::vector<Eigen::VectorXd> q_vec;
+  Joints q(GetEECount(), HyqlegJointCount);
 
   // make sure always exactly 4 elements
   auto pos_B = x_B.ToImpl();
   pos_B.resize(4, pos_B.front());
 
   for (int ee=0; ee<pos_B.size(); ++ee) {
+    Vector3d mirror;
+    HyqlegInverseKinematics::KneeBend bend;
+    GetLegMirror(ee, mirror, bend);
+
+    Eigen::Map<const Vector3d> base2hip(hyq4::kBaseToHaa[ee]);
+    ee_pos_H = (pos_B.at(ee) - base2hip).cwiseProduct(mirror);
+    q.at(ee) = leg.GetJointAngles(ee_pos_H, bend);
+  }
+
+  return q;
+}
+
+InverseKinematics::Jacobians
+InverseKinematicsHyq4::GetJacobians(const Joints& q) const
+{
+  Jacobians J(GetEECount());
+  for (auto ee : J.GetEEsOrdered()) {
+    Vector3d mirror;
+    HyqlegInverseKinematics::KneeBend bend;
+    GetLegMirror(ee, mirror, bend);
+
+    // the mirroring is its own inverse, so d(pos_B)/dq = M * d(pos_H)/dq
+    J.at(ee) = mirror.asDiagonal()*leg.GetJacobian(q.at(ee), bend);
+  }
+
+  return J;
+}
+
+InverseKinematics::Jacobians
+InverseKinematicsHyq4::GetJacobianDerivatives(const Joints& q, const Joints& qd) const
+{
+  Jacobians Jd(GetEECount());
+  for (auto ee : Jd.GetEEsOrdered()) {
+    Vector3d mirror;
+    HyqlegInverseKinematics::KneeBend bend;
+    GetLegMirror(ee, mirror, bend);
 
-    HyqlegInverseKinematics::KneeBend bend = HyqlegInverseKinematics::Forward;
-
-    using namespace quad;
-    switch (ee) {
-      case LF:
-        ee_pos_H = pos_B.at(ee);
-        break;
-      case RF:
-        ee_pos_H = pos_B.at(ee).cwiseProduct(Eigen::Vector3d(1,-1,1));
-        break;
-      case LH:
-        ee_pos_H = pos_B.at(ee).cwiseProduct(Eigen::Vector3d(-1,1,1));
-        bend = HyqlegInverseKinematics::Backward;
-        break;
-      case RH:
-        ee_pos_H = pos_B.at(ee).cwiseProduct(Eigen::Vector3d(-1,-1,1));
-        bend = HyqlegInverseKinematics::Backward;
-        break;
-      default: // joint angles for this foot do not exist
-        break;
-    }
-
-    ee_pos_H -= base2hip_LF_;
-    q_vec.push_back(leg.GetJointAngles(ee_pos_H, bend));
+    Jd.at(ee) = mirror.asDiagonal()*leg.GetJacobianDerivative(q.at(ee), qd.at(ee), bend);
   }
 
-  return Joints(q_vec);
+  return Jd;
 }
 
 } /* namespace xpp */
@@ -0,0 +1,157 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include <xpp_hyq/hyqleg_inverse_kinematics.h>
+#include <xpp_hyq/hyq4_geometry.h>
+
+using namespace xpp;
+
+using Matrix3Xd = HyqlegInverseKinematics::Matrix3Xd;
+using Matrix3Xf = HyqlegInverseKinematics::Matrix3Xf;
+
+// foot positions around the workspace of the leg, including unreachable ones.
+static Matrix3Xd
+GetFootPositions (int n)
+{
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> xy(-0.5, 0.5), z(-0.8, 0.3);
+  Matrix3Xd pos(3, n);
+  for (int i=0; i<n; ++i)
+    pos.col(i) << xy(gen), xy(gen), z(gen);
+
+  pos.col(0) << 0.0, 0.0, -0.6; // straight below
+  pos.col(1) << 0.0, 0.0, 0.0;  // at the hip
+  return pos;
+}
+
+TEST(HyqlegInverseKinematics, BatchMatchesSingle)
+{
+  HyqlegInverseKinematics leg(hyq4::kLegGeometry);
+  Matrix3Xd pos = GetFootPositions(1000);
+
+  for (auto bend : {HyqlegInverseKinematics::Forward, HyqlegInverseKinematics::Backward}) {
+    Matrix3Xd q = leg.GetJointAnglesBatch(pos, bend);
+    Matrix3Xf q_float = leg.GetJointAnglesBatch(Matrix3Xf(pos.cast<float>()), bend);
+
+    for (int i=0; i<pos.cols(); ++i) {
+      if (i == 1)
+        continue; // HAA undefined, see below
+      Eigen::Vector3d q_single = leg.GetJointAngles(pos.col(i), bend);
+      EXPECT_TRUE(q.col(i).isApprox(q_single, 1e-12) || (q.col(i)-q_single).norm() < 1e-12)
+          << pos.col(i).transpose();
+      EXPECT_LT((q_float.col(i).cast<double>() - q_single).norm(), 1e-5);
+    }
+  }
+
+  // at the hip the HAA angle depends on the sign of zero, but the
+  // remaining joints don't
+  Matrix3Xd q_hip = leg.GetJointAnglesBatch(Matrix3Xd(pos.col(1)));
+  EXPECT_TRUE(q_hip.col(0).tail(2).isApprox(leg.GetJointAngles(pos.col(1)).tail(2)));
+}
+
+TEST(HyqlegInverseKinematics, EnforceLimits)
+{
+  HyqlegInverseKinematics leg(hyq4::kLegGeometry);
+  for (int j=0; j<HyqlegJointCount; ++j) {
+    auto joint = static_cast<HyqJointID>(j);
+    double q = 10.0;
+    leg.EnforceLimits(q, joint);
+    EXPECT_EQ(HyqlegInverseKinematics::kMaxAngle[j], q);
+    q = -10.0;
+    leg.EnforceLimits(q, joint);
+    EXPECT_EQ(HyqlegInverseKinematics::kMinAngle[j], q);
+  }
+}
+
+TEST(HyqlegInverseKinematics, BatchTiming)
+{
+  HyqlegInverseKinematics leg(hyq4::kLegGeometry);
+  int n = 100000;
+  Matrix3Xd pos = GetFootPositions(n);
+  Matrix3Xf pos_float = pos.cast<float>();
+
+  using Clock = std::chrono::steady_clock;
+  auto t0 = Clock::now();
+  Matrix3Xd q_single(3, n);
+  for (int i=0; i<n; ++i)
+    q_single.col(i) = leg.GetJointAngles(pos.col(i));
+  auto t1 = Clock::now();
+  Matrix3Xd q = leg.GetJointAnglesBatch(pos);
+  auto t2 = Clock::now();
+  Matrix3Xf q_float = leg.GetJointAnglesBatch(pos_float);
+  auto t3 = Clock::now();
+
+  auto ns = [n](Clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()/double(n);
+  };
+  std::cout << "single: " << ns(t1-t0) << " ns, batch: " << ns(t2-t1)
+            << " ns, batch float: " << ns(t3-t2) << " ns per foot" << std::endl;
+
+  EXPECT_EQ(n, q.cols());
+  EXPECT_EQ(n, q_float.cols());
+}
+
+TEST(HyqlegInverseKinematics, ForwardKinematics)
+{
+  HyqlegInverseKinematics leg(hyq4::kLegGeometry);
+  for (auto bend : {HyqlegInverseKinematics::Forward, HyqlegInverseKinematics::Backward}) {
+    for (Eigen::Vector3d pos : { Eigen::Vector3d( 0.0,  0.0,  -0.6),
+                                 Eigen::Vector3d( 0.1,  0.05, -0.5),
+                                 Eigen::Vector3d(-0.2, -0.1,  -0.4) }) {
+      Eigen::Vector3d q = leg.GetJointAngles(pos, bend);
+      EXPECT_TRUE(leg.GetFootPosition(q, bend).isApprox(pos, 1e-9)) << pos.transpose();
+    }
+  }
+}
+
+TEST(HyqlegInverseKinematics, JacobianMatchesFiniteDifferences)
+{
+  HyqlegInverseKinematics leg(hyq4::kLegGeometry);
+  Eigen::Vector3d q(0.2, 0.6, -1.3), qd(0.5, -1.0, 2.0);
+  double h = 1e-6;
+
+  for (auto bend : {HyqlegInverseKinematics::Forward, HyqlegInverseKinematics::Backward}) {
+    Eigen::Matrix3d J = leg.GetJacobian(q, bend);
+    for (int j=0; j<3; ++j) {
+      Eigen::Vector3d dq = Eigen::Vector3d::Unit(j)*h;
+      Eigen::Vector3d diff = (leg.GetFootPosition(q+dq, bend) - leg.GetFootPosition(q-dq, bend))/(2*h);
+      EXPECT_TRUE(J.col(j).isApprox(diff, 1e-6)) << j;
+    }
+
+    Eigen::Matrix3d Jd = leg.GetJacobianDerivative(q, qd, bend);
+    Eigen::Matrix3d Jd_diff = (leg.GetJacobian(q+h*qd, bend) - leg.GetJacobian(q-h*qd, bend))/(2*h);
+    EXPECT_TRUE(Jd.isApprox(Jd_diff, 1e-6));
+  }
+}
@@ -0,0 +1,110 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <xpp_hyq/inverse_kinematics_hyq4.h>
+#include <xpp_states/endeffector_mappings.h>
+
+using namespace xpp;
+
+static EndeffectorsPos
+GetNominalStance ()
+{
+  using namespace quad;
+  EndeffectorsPos pos_B(4);
+  pos_B.at(LF) = Eigen::Vector3d( 0.35,  0.25, -0.55);
+  pos_B.at(RF) = Eigen::Vector3d( 0.40, -0.20, -0.60);
+  pos_B.at(LH) = Eigen::Vector3d(-0.30,  0.22, -0.58);
+  pos_B.at(RH) = Eigen::Vector3d(-0.38, -0.18, -0.52);
+  return pos_B;
+}
+
+// the Jacobian must map the change of the IK solution back to the
+// displacement of the foot, for every leg and its mirroring/knee bend.
+TEST(InverseKinematicsHyq4, JacobianMatchesInverseKinematics)
+{
+  InverseKinematicsHyq4 ik;
+  EndeffectorsPos pos_B = GetNominalStance();
+  auto J = ik.GetJacobians(ik.GetAllJointAngles(pos_B));
+  ASSERT_EQ(4, J.GetEECount());
+
+  double h = 1e-6;
+  for (int dim=0; dim<3; ++dim) {
+    EndeffectorsPos pos_plus = pos_B, pos_minus = pos_B;
+    for (auto ee : pos_B.GetEEsOrdered()) {
+      pos_plus.at(ee)(dim)  += h;
+      pos_minus.at(ee)(dim) -= h;
+    }
+
+    Joints q_plus  = ik.GetAllJointAngles(pos_plus);
+    Joints q_minus = ik.GetAllJointAngles(pos_minus);
+    for (auto ee : pos_B.GetEEsOrdered()) {
+      Eigen::VectorXd dq = (q_plus.at(ee) - q_minus.at(ee))/(2*h);
+      Eigen::Vector3d dx = J.at(ee)*dq;
+      EXPECT_TRUE(dx.isApprox(Eigen::Vector3d::Unit(dim), 1e-5)) << "ee " << ee << ": " << dx.transpose();
+    }
+  }
+}
+
+TEST(InverseKinematicsHyq4, JacobianDerivativeMatchesFiniteDifferences)
+{
+  InverseKinematicsHyq4 ik;
+  Joints q  = ik.GetAllJointAngles(GetNominalStance());
+  Joints qd(4, 3);
+  qd.SetAll(Eigen::Vector3d(0.3, -0.8, 1.5));
+
+  double h = 1e-6;
+  Joints q_plus(4, 3), q_minus(4, 3);
+  q_plus.SetFromVec(q.ToVec() + h*qd.ToVec());
+  q_minus.SetFromVec(q.ToVec() - h*qd.ToVec());
+
+  auto Jd       = ik.GetJacobianDerivatives(q, qd);
+  auto J_plus   = ik.GetJacobians(q_plus);
+  auto J_minus  = ik.GetJacobians(q_minus);
+  for (auto ee : Jd.GetEEsOrdered()) {
+    Eigen::MatrixXd Jd_diff = (J_plus.at(ee) - J_minus.at(ee))/(2*h);
+    EXPECT_TRUE(Jd.at(ee).isApprox(Jd_diff, 1e-6)) << "ee " << ee;
+  }
+}
+
+// hyq.urdf.xacro: HFE 0.082 below HAA, thigh and shank 0.35 long.
+TEST(InverseKinematicsHyq4, StretchedLegsMatchUrdf)
+{
+  using namespace quad;
+  InverseKinematicsHyq4 ik;
+  EndeffectorsPos pos_B(4);
+  pos_B.at(LF) = Eigen::Vector3d( 0.3735,  0.207, -0.782);
+  pos_B.at(RF) = Eigen::Vector3d( 0.3735, -0.207, -0.782);
+  pos_B.at(LH) = Eigen::Vector3d(-0.3735,  0.207, -0.782);
+  pos_B.at(RH) = Eigen::Vector3d(-0.3735, -0.207, -0.782);
+
+  Joints q = ik.GetAllJointAngles(pos_B);
+  EXPECT_LT(q.ToVec().cwiseAbs().maxCoeff(), 1e-6) << q.ToVec().transpose();
+}
@@ -0,0 +1,114 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+
+#include <xpp_msgs/RobotStateCartesian.h>
+#include <xpp_msgs/topic_names.h>
+#include <xpp_states/convert.h>
+#include <xpp_states/trajectory_decimator.h>
+
+
+using namespace xpp;
+
+/**
+ * Rewrites a bag with fewer robot states, keeping all other messages.
+ *
+ * Usage: decimate_bag in.bag out.bag [base_pos ee_pos base_angle ee_force]
+ *
+ * The optional tolerances are in [m], [m], [rad] and [N]. The visualizers
+ * show each received state until the next one arrives, so the tolerances
+ * bound the deviation from the last kept state (TrajectoryDecimator::kHold).
+ */
+int main(int argc, char *argv[])
+{
+  if (argc != 3 && argc != 7) {
+    std::cerr << "Usage: decimate_bag in.bag out.bag [base_pos ee_pos base_angle ee_force]" << std::endl;
+    return 1;
+  }
+
+  TrajectoryDecimator::Tolerances tol;
+  if (argc == 7) {
+    tol.base_pos   = std::atof(argv[3]);
+    tol.ee_pos     = std::atof(argv[4]);
+    tol.base_angle = std::atof(argv[5]);
+    tol.ee_force   = std::atof(argv[6]);
+  }
+
+  const std::string topic = xpp_msgs::robot_state_desired;
+
+  rosbag::Bag bag_in;
+  bag_in.open(argv[1], rosbag::bagmode::Read);
+
+  // decimate with the time at which the states were recorded, as this is
+  // the time they are played back at.
+  std::vector<RobotStateCartesian> states;
+  std::vector<ros::Time> stamps;
+  rosbag::View state_view(bag_in, rosbag::TopicQuery(topic));
+  for (const rosbag::MessageInstance& m : state_view) {
+    auto msg = m.instantiate<xpp_msgs::RobotStateCartesian>();
+    if (!msg)
+      continue;
+    states.push_back(Convert::ToXpp(*msg));
+    states.back().t_global_ = (m.getTime() - state_view.getBeginTime()).toSec();
+    stamps.push_back(m.getTime());
+  }
+
+  std::vector<int> kept = TrajectoryDecimator(tol, TrajectoryDecimator::kHold).GetKeptIndices(states);
+  std::vector<bool> keep(states.size(), false);
+  for (int k : kept)
+    keep.at(k) = true;
+
+  rosbag::Bag bag_out;
+  bag_out.open(argv[2], rosbag::bagmode::Write);
+
+  int k = 0;
+  rosbag::View view(bag_in);
+  for (const rosbag::MessageInstance& m : view) {
+    if (m.getTopic() == topic && m.isType<xpp_msgs::RobotStateCartesian>()) {
+      if (!keep.at(k++))
+        continue;
+    }
+    bag_out.write(m.getTopic(), m.getTime(), m, m.getConnectionHeader());
+  }
+
+  bag_out.close();
+  bag_in.close();
+
+  std::cout << "Kept " << kept.size() << " of " << states.size()
+            << " states on " << topic << "." << std::endl;
+
+  return 0;
+}
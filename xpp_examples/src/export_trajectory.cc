@@ -0,0 +1,125 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+
+#include <xpp_msgs/RobotStateCartesian.h>
+#include <xpp_msgs/topic_names.h>
+#include <xpp_states/convert.h>
+#include <xpp_states/trajectory_exporter.h>
+
+
+using namespace xpp;
+
+static std::ofstream file;
+static std::unique_ptr<TrajectoryExporter> exporter;
+static TrajectoryExporter::Format format;
+
+// the exporter is created with the first state, when the number of
+// endeffectors is known. States with a different number are skipped.
+static void
+Export (const xpp_msgs::RobotStateCartesian& msg)
+{
+  RobotStateCartesian state = Convert::ToXpp(msg);
+  int n_ee = state.ee_motion_.GetEECount();
+  if (!exporter)
+    exporter.reset(new TrajectoryExporter(file, n_ee, format));
+
+  if (n_ee != exporter->GetEECount()) {
+    ROS_WARN_STREAM("Skipping state at t=" << state.t_global_ << " with " << n_ee
+                    << " instead of " << exporter->GetEECount() << " endeffectors.");
+    return;
+  }
+  exporter->Write(state);
+}
+
+/**
+ * Exports robot states as a table with one column per channel.
+ *
+ * Usage: export_trajectory out.csv|out.bin [in.bag]
+ *
+ * Reads the states from the bag or, without a bag, from the live topic
+ * until the node is shut down. Files ending in .csv are written as CSV,
+ * all others in the binary columnar format of xpp::TrajectoryExporter.
+ */
+int main(int argc, char *argv[])
+{
+  if (argc != 2 && argc != 3) {
+    std::cerr << "Usage: export_trajectory out.csv|out.bin [in.bag]" << std::endl;
+    return 1;
+  }
+
+  std::string path = argv[1];
+  bool csv = path.size() >= 4 && path.compare(path.size()-4, 4, ".csv") == 0;
+  format = csv? TrajectoryExporter::CSV : TrajectoryExporter::Binary;
+
+  file.open(path, std::ios::binary);
+  if (!file) {
+    std::cerr << "Can't open " << path << std::endl;
+    return 1;
+  }
+
+  const std::string topic = xpp_msgs::robot_state_desired;
+
+  if (argc == 3) {
+    rosbag::Bag bag;
+    bag.open(argv[2], rosbag::bagmode::Read);
+
+    // the view reads the messages one by one, so the whole bag is never
+    // held in memory.
+    rosbag::View view(bag, rosbag::TopicQuery(topic));
+    for (const rosbag::MessageInstance& m : view) {
+      auto msg = m.instantiate<xpp_msgs::RobotStateCartesian>();
+      if (msg)
+        Export(*msg);
+    }
+    bag.close();
+  }
+  else {
+    ros::init(argc, argv, "export_trajectory");
+    ros::NodeHandle n;
+    ros::Subscriber sub = n.subscribe<xpp_msgs::RobotStateCartesian>(topic, 1000,
+        [](const xpp_msgs::RobotStateCartesian::ConstPtr& msg) { Export(*msg); });
+    ROS_INFO_STREAM("Exporting " << topic << " to " << path << ", stop with Ctrl-C.");
+    ros::spin();
+  }
+
+  if (exporter)
+    exporter->Close();
+  std::cout << "Wrote " << topic << " to " << path << "." << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,184 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <urdf/model.h>
+
+#include <xpp_msgs/RobotStateCartesian.h>
+#include <xpp_msgs/topic_names.h>
+#include <xpp_states/convert.h>
+#include <xpp_vis/dls_inverse_kinematics.h>
+
+
+using namespace xpp;
+
+// solves for all states once, every one starting from the nominal joint
+// angles (cold) or from the previous state's solution (warm).
+static void
+Benchmark (const DlsInverseKinematics& ik, const std::vector<EndeffectorsPos>& feet_B,
+           bool warm)
+{
+  using Clock = std::chrono::steady_clock;
+
+  Joints q = ik.GetNominalJoints();
+  long total_iterations = 0;
+  int max_iterations = 0;
+
+  auto start = Clock::now();
+  for (const auto& pos_B : feet_B) {
+    int iterations = 0;
+    q = ik.GetAllJointAngles(pos_B, warm? q : ik.GetNominalJoints(), &iterations);
+    total_iterations += iterations;
+    max_iterations = std::max(max_iterations, iterations);
+  }
+  double us = std::chrono::duration<double, std::micro>(Clock::now()-start).count();
+
+  int n = feet_B.size();
+  std::cout << (warm? "warm" : "cold") << " start: "
+            << double(total_iterations)/n << " iterations per state (max "
+            << max_iterations << "), " << us/n << " us per state" << std::endl;
+}
+
+// "lf_foot:0,0.6,-1.2" -> the link lf_foot and the given nominal joint angles.
+static std::string
+ParseEndeffector (const std::string& arg, std::vector<double>& q_nominal)
+{
+  size_t colon = arg.find(':');
+  q_nominal.clear();
+  if (colon == std::string::npos)
+    return arg;
+
+  std::stringstream angles(arg.substr(colon+1));
+  for (std::string q; std::getline(angles, q, ',');)
+    q_nominal.push_back(std::stod(q));
+  return arg.substr(0, colon);
+}
+
+// the middle of the joint limits, which keeps e.g. legs away from the
+// singular stretched configuration at q=0.
+static Eigen::VectorXd
+GetMiddleOfLimits (const KinematicChain& chain)
+{
+  Eigen::VectorXd q = Eigen::VectorXd::Zero(chain.GetJointCount());
+  for (int i=0; i<q.rows(); ++i) {
+    const auto& joint = chain.GetJoint(i);
+    if (std::isfinite(joint.lower) && std::isfinite(joint.upper))
+      q(i) = 0.5*(joint.lower + joint.upper);
+  }
+  return q;
+}
+
+/**
+ * Compares cold- and warm-started numerical inverse kinematics on a bag.
+ *
+ * Usage: ik_benchmark robot.urdf in.bag base_link ee_link[:q_1,...,q_n]...
+ *
+ * The URDF must be expanded already, e.g. for HyQ through
+ *   xacro hyq.urdf.xacro > hyq.urdf
+ *   ik_benchmark hyq.urdf hyq.bag base lf_foot rf_foot lh_foot rh_foot
+ * with the endeffector links in the order of the robot states in the bag.
+ *
+ * Cold starts begin from the nominal joint angles, which can be given after
+ * each link, e.g. lf_foot:0,0.6,-1.2. By default they are in the middle of
+ * the joint limits, for HyQ with bent knees.
+ */
+int main(int argc, char *argv[])
+{
+  if (argc < 5) {
+    std::cerr << "Usage: ik_benchmark robot.urdf in.bag base_link ee_link[:q_1,...,q_n]..." << std::endl;
+    return 1;
+  }
+
+  urdf::Model model;
+  if (!model.initFile(argv[1])) {
+    std::cerr << "Can't parse " << argv[1] << std::endl;
+    return 1;
+  }
+
+  std::vector<KinematicChain> chains;
+  std::vector<std::vector<double>> q_given;
+  for (int i=4; i<argc; ++i) {
+    q_given.emplace_back();
+    std::string ee_link = ParseEndeffector(argv[i], q_given.back());
+    chains.push_back(KinematicChain::FromUrdf(model, argv[3], ee_link));
+  }
+  DlsInverseKinematics ik(chains);
+
+  // starting from q=0, i.e. stretched legs, the solver is at a singularity
+  // and may end on either knee branch.
+  Joints q_nominal = ik.GetNominalJoints();
+  for (auto ee : q_nominal.GetEEsOrdered()) {
+    const auto& q = q_given.at(ee);
+    if (q.empty())
+      q_nominal.at(ee) = GetMiddleOfLimits(chains.at(ee));
+    else if (int(q.size()) == q_nominal.at(ee).rows())
+      q_nominal.at(ee) = Eigen::Map<const Eigen::VectorXd>(q.data(), q.size());
+    else {
+      std::cerr << "Expected " << q_nominal.at(ee).rows() << " nominal joint angles for "
+                << argv[4+ee] << std::endl;
+      return 1;
+    }
+  }
+  ik.SetNominalJoints(q_nominal);
+
+  // feet expressed in base frame, as the inverse kinematics expects them
+  std::vector<EndeffectorsPos> feet_B;
+  rosbag::Bag bag;
+  bag.open(argv[2], rosbag::bagmode::Read);
+  rosbag::View view(bag, rosbag::TopicQuery(xpp_msgs::robot_state_desired));
+  for (const rosbag::MessageInstance& m : view) {
+    auto msg = m.instantiate<xpp_msgs::RobotStateCartesian>();
+    if (!msg)
+      continue;
+
+    RobotStateCartesian state = Convert::ToXpp(*msg);
+    Eigen::Matrix3d B_R_W = state.base_.ang.q.normalized().toRotationMatrix().transpose();
+    EndeffectorsPos pos_B(ik.GetEECount());
+    for (auto ee : pos_B.GetEEsOrdered())
+      pos_B.at(ee) = B_R_W*(state.ee_motion_.at(ee).p_ - state.base_.lin.p_);
+    feet_B.push_back(pos_B);
+  }
+  bag.close();
+
+  std::cout << "Solving " << feet_B.size() << " states of " << argv[2]
+            << " for " << ik.GetEECount() << " endeffectors." << std::endl;
+  Benchmark(ik, feet_B, false);
+  Benchmark(ik, feet_B, true);
+
+  return 0;
+}
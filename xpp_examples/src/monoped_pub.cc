@@ -32,8 +32,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <xpp_msgs/RobotStateCartesian.h>
 #include <xpp_msgs/topic_names.h>
 
-#include <xpp_states/convert.h>
 #include <xpp_states/robot_state_cartesian.h>
+#include <xpp_states/serialization.h>
 
 
 using namespace xpp;
@@ -65,7 +65,8 @@ int main(int argc, char *argv[])
     hopper.ee_forces_.at(0).z() = 100; // N
     hopper.ee_contact_.at(0) = true;
 
-    state_pub.publish(Convert::ToRos(hopper));
+    // serialized directly, without converting to xpp_msgs first
+    state_pub.publish(hopper);
 
     ros::spinOnce();
     ros::Duration(dt).sleep(); // pause loop so visualization has correct speed.
@@ -47,12 +47,18 @@ static const std::string robot_state_current("/xpp/state_curr");
 // the desired state that comes from the optimizer
 static const std::string robot_state_desired("/xpp/state_des");
 
+// the desired state as RobotStateCartesianCompact (float32) message
+static const std::string robot_state_desired_compact("/xpp/state_des_compact");
+
 // desired joint state (equivalent to desired cartesian state
 static const std::string joint_desired("/xpp/joint_des");
 
 // sequence of desired states coming from the optimizer
 static const std::string robot_trajectory_desired("/xpp/trajectory_des");
 
+// sequence of desired joint states (equivalent to desired cartesian trajectory)
+static const std::string joint_trajectory_desired("/xpp/joint_trajectory_des");
+
 // parameters describing the robot kinematics
 static const std::string robot_parameters("/xpp/params");
 
@@ -0,0 +1,169 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef _XPP_STATES_CARTESIAN_TRAJECTORY_H_
+#define _XPP_STATES_CARTESIAN_TRAJECTORY_H_
+
+#include <array>
+#include <vector>
+
+#include <xpp_states/state.h>
+#include <xpp_states/robot_state_cartesian.h>
+
+namespace xpp {
+
+/**
+ * @brief A sequence of Cartesian robot states stored column by column.
+ *
+ * Instead of a std::vector<RobotStateCartesian>, where every state owns its
+ * own endeffector containers, every scalar quantity (e.g. the z-force of the
+ * left-front foot) is stored in one contiguous array over all timesteps.
+ * Scanning a single quantity over a long trajectory therefore reads
+ * consecutive memory. The contact flags of all endeffectors are packed into
+ * one bitmask per timestep, so gait events (touchdown = ~prev & curr) can be
+ * found with word-wide operations.
+ *
+ * Single states can be read through the lightweight %StateRef, which
+ * offers the same quantities as a %RobotStateCartesian without copying
+ * the whole trajectory.
+ */
+class CartesianTrajectory {
+public:
+  using Channel   = std::vector<double>;         ///< one scalar over time.
+  using Channel3d = std::array<Channel, kDim3d>; ///< x,y,z over time.
+  using ChannelMap = Eigen::Map<const VectorXd>;
+  enum QuaternionCoeffs { QW=0, QX, QY, QZ };
+
+  /**
+   * @brief Read-only proxy to the state at a specific timestep.
+   */
+  class StateRef {
+  public:
+    StateRef(const CartesianTrajectory& traj, int k) : traj_(traj), k_(k) {};
+
+    double t_global() const;
+    State3d base() const;
+    StateLin3d ee_motion(EndeffectorID ee) const;
+    Vector3d ee_forces(EndeffectorID ee) const;
+    bool ee_contact(EndeffectorID ee) const;
+    EndeffectorsContact ee_contact() const;
+    int GetEECount() const { return traj_.GetEECount(); };
+
+    /**
+     * @brief Copies the referenced timestep into a full robot state.
+     */
+    RobotStateCartesian ToState() const;
+    operator RobotStateCartesian() const { return ToState(); };
+
+  private:
+    const CartesianTrajectory& traj_;
+    int k_;
+  };
+
+  /**
+   * @brief Constructs an empty trajectory for a robot with n_ee endeffectors.
+   */
+  explicit CartesianTrajectory(int n_ee = 0);
+
+  /**
+   * @brief Constructs the columnar representation of a sequence of states.
+   *
+   * Attention: Each state must have the same number of endeffectors.
+   */
+  explicit CartesianTrajectory(const std::vector<RobotStateCartesian>& states);
+  ~CartesianTrajectory() = default;
+
+  /**
+   * @brief Reserves memory in every channel for n states.
+   */
+  void Reserve(int n);
+
+  /**
+   * @brief Resizes every channel to hold n (zero initialized) states.
+   */
+  void Resize(int n);
+
+  /**
+   * @brief Appends a state at the end of the trajectory.
+   * @throws std::invalid_argument if the number of endeffectors differs.
+   */
+  void PushBack(const RobotStateCartesian& state);
+
+  /**
+   * @brief Overwrites the state stored at timestep k.
+   * @throws std::invalid_argument if the number of endeffectors differs.
+   */
+  void SetState(int k, const RobotStateCartesian& state);
+
+  /**
+   * @brief Read-only access to the state at timestep k.
+   */
+  StateRef at(int k) const { return StateRef(*this, k); };
+  StateRef operator[](int k) const { return at(k); };
+
+  /**
+   * @brief Converts back to the row-wise representation (copies everything).
+   */
+  std::vector<RobotStateCartesian> ToStates() const;
+
+  int size() const { return t_global_.size(); };
+  bool empty() const { return t_global_.empty(); };
+  int GetEECount() const { return ee_pos_.size(); };
+
+  // contiguous views of individual channels over the whole trajectory.
+  ChannelMap GetTimes() const { return Map(t_global_); };
+  ChannelMap GetBasePos(Coords3D dim) const { return Map(base_pos_.at(dim)); };
+  ChannelMap GetBaseVel(Coords3D dim) const { return Map(base_vel_.at(dim)); };
+  ChannelMap GetBaseAcc(Coords3D dim) const { return Map(base_acc_.at(dim)); };
+  ChannelMap GetEEPos(EndeffectorID ee, Coords3D dim) const { return Map(ee_pos_.at(ee).at(dim)); };
+  ChannelMap GetEEVel(EndeffectorID ee, Coords3D dim) const { return Map(ee_vel_.at(ee).at(dim)); };
+  ChannelMap GetEEAcc(EndeffectorID ee, Coords3D dim) const { return Map(ee_acc_.at(ee).at(dim)); };
+  ChannelMap GetEEForce(EndeffectorID ee, Coords3D dim) const { return Map(ee_forces_.at(ee).at(dim)); };
+  const std::vector<EndeffectorsContact::Mask>& GetContactMasks() const { return ee_contact_; };
+
+  // the raw channels, e.g. for conversion to/from other representations.
+  Channel t_global_;
+  Channel3d base_pos_, base_vel_, base_acc_;
+  std::array<Channel, 4> base_ori_; ///< quaternion w,x,y,z maps base to world.
+  Channel3d base_w_, base_wd_;
+
+  std::vector<Channel3d> ee_pos_, ee_vel_, ee_acc_;
+  std::vector<Channel3d> ee_forces_;
+  std::vector<EndeffectorsContact::Mask> ee_contact_; ///< bit ee set if in contact.
+
+private:
+  static ChannelMap Map(const Channel& c) { return ChannelMap(c.data(), c.size()); };
+
+  template<typename Fn> void ForEachChannel(Fn fn);
+  void CheckEECount(const RobotStateCartesian& state) const;
+};
+
+} /* namespace xpp */
+
+#endif /* _XPP_STATES_CARTESIAN_TRAJECTORY_H_ */
@@ -0,0 +1,126 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef _XPP_STATES_CONTACT_SCHEDULE_H_
+#define _XPP_STATES_CONTACT_SCHEDULE_H_
+
+#include <vector>
+
+#include <xpp_states/robot_state_cartesian.h>
+
+namespace xpp {
+
+/**
+ * @brief The alternating stance and swing phases of each endeffector.
+ *
+ * Instead of a contact flag per state, only the times at which the contact
+ * of an endeffector changes are stored (run-length encoding). A phase
+ * starts at the first state with the new contact flag and lasts until the
+ * next change, the last phase until the last state.
+ *
+ * Queries for a time are answered by binary search in O(log phases).
+ */
+class ContactSchedule {
+public:
+  using States = std::vector<RobotStateCartesian>;
+
+  struct Phase {
+    double t_start;
+    double t_end;
+    bool contact;
+    double GetDuration() const { return t_end - t_start; };
+  };
+
+  struct PhaseStats {
+    int count = 0;
+    double min = 0.0; ///< shortest duration [s].
+    double max = 0.0; ///< longest duration [s].
+    double mean = 0.0;
+  };
+
+  /**
+   * @param states  States ordered by time, at least one.
+   * @throws std::invalid_argument if there are no states or a state has
+   *         a different number of endeffectors than the first one.
+   */
+  explicit ContactSchedule(const States& states);
+  ~ContactSchedule() = default;
+
+  bool IsInContact(EndeffectorID ee, double t) const;
+  EndeffectorsContact GetContacts(double t) const;
+
+  /**
+   * @returns the first time after t at which ee touches down (lifts off),
+   *          infinity if it doesn't anymore.
+   */
+  double GetNextTouchdown(EndeffectorID ee, double t) const;
+  double GetNextLiftoff(EndeffectorID ee, double t) const;
+
+  /**
+   * @brief The phase of ee at time t.
+   */
+  Phase GetPhase(EndeffectorID ee, double t) const;
+  std::vector<Phase> GetPhases(EndeffectorID ee) const;
+
+  /**
+   * @brief Durations of all stance (contact=true) or swing phases of ee.
+   */
+  PhaseStats GetPhaseStats(EndeffectorID ee, bool contact) const;
+
+  /**
+   * @brief The fraction of [t0,t1] that ee is in contact.
+   */
+  double GetDutyFactor(EndeffectorID ee, double t0, double t1) const;
+  double GetDutyFactor(EndeffectorID ee) const;
+
+  int GetEECount() const { return ees_.size(); };
+  double GetStartTime() const { return t_start_; };
+  double GetEndTime() const { return t_end_; };
+
+private:
+  struct Timeline {
+    bool first_contact;
+    std::vector<double> t_switch;    ///< start of each phase.
+    std::vector<double> t_stance;    ///< total stance time before each phase.
+    PhaseStats stance, swing;
+  };
+
+  std::vector<Timeline> ees_;
+  double t_start_, t_end_;
+
+  const Timeline& GetTimeline(EndeffectorID ee) const;
+  int GetPhaseIndex(const Timeline& tl, double t) const;
+  bool IsContactPhase(const Timeline& tl, int phase) const;
+  double GetPhaseEnd(const Timeline& tl, int phase) const;
+  double GetStanceTimeUntil(const Timeline& tl, double t) const;
+};
+
+} /* namespace xpp */
+
+#endif /* _XPP_STATES_CONTACT_SCHEDULE_H_ */
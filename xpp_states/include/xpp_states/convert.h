@@ -30,15 +30,23 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef XPP_ROS_CONVERSIONS_H_
 #define XPP_ROS_CONVERSIONS_H_
 
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include <xpp_msgs/StateLin3d.h>
 #include <xpp_msgs/State6d.h>
 #include <xpp_msgs/RobotStateCartesian.h>
+#include <xpp_msgs/RobotStateCartesianCompact.h>
 #include <xpp_msgs/RobotStateCartesianTrajectory.h>
+#include <xpp_msgs/RobotStateCartesianTrajectoryDelta.h>
 
 #include <xpp_states/state.h>
 #include <xpp_states/robot_state_cartesian.h>
+#include <xpp_states/cartesian_trajectory.h>
+#include <xpp_states/trajectory_delta.h>
 
 namespace xpp {
 
@@ -50,10 +58,71 @@ namespace xpp {
  */
 struct Convert {
 
-static StateLin3d
-ToXpp(const xpp_msgs::StateLin3d& ros)
+/**
+ * @brief Minimum number of trajectory points converted by each thread.
+ *
+ * Shorter trajectories are converted in the calling thread, as starting
+ * threads would cost more than the conversion itself.
+ */
+static constexpr int kMinPointsPerThread = 1000;
+
+/**
+ * @brief Calls fn(k_start, k_end) for contiguous intervals covering 0...n-1,
+ * one per thread for large n.
+ *
+ * An exception thrown by fn is rethrown in the calling thread once all
+ * threads have finished, just as if the points had been converted in order.
+ */
+template<typename Fn>
+static void
+ForEachInterval(int n, const Fn& fn)
+{
+  int n_threads = std::min<int>(std::thread::hardware_concurrency(),
+                                n/kMinPointsPerThread);
+  if (n_threads <= 1) {
+    fn(0, n);
+    return;
+  }
+
+  std::vector<std::exception_ptr> errors(n_threads);
+  std::vector<std::thread> threads;
+  threads.reserve(n_threads);
+  for (int i=0; i<n_threads; ++i) {
+    int k_start = static_cast<long>(n)*i/n_threads;
+    int k_end   = static_cast<long>(n)*(i+1)/n_threads;
+    threads.emplace_back([&fn, &errors, i, k_start, k_end]() {
+      try {
+        fn(k_start, k_end);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  for (const auto& error : errors)
+    if (error)
+      std::rethrow_exception(error);
+}
+
+/**
+ * @brief Calls fn(k) for k=0...n-1, split across threads for large n.
+ */
+template<typename Fn>
+static void
+ForEachPoint(int n, const Fn& fn)
+{
+  ForEachInterval(n, [&fn](int k_start, int k_end) {
+    for (int k=k_start; k<k_end; ++k)
+      fn(k);
+  });
+}
+
+static void
+ToXpp(const xpp_msgs::StateLin3d& ros, StateLin3d& point)
 {
-  StateLin3d point;
   point.p_.x() = ros.pos.x;
   point.p_.y() = ros.pos.y;
   point.p_.z() = ros.pos.z;
@@ -65,14 +134,19 @@ ToXpp(const xpp_msgs::StateLin3d& ros)
   point.a_.x() = ros.acc.x;
   point.a_.y() = ros.acc.y;
   point.a_.z() = ros.acc.z;
+}
 
+static StateLin3d
+ToXpp(const xpp_msgs::StateLin3d& ros)
+{
+  StateLin3d point;
+  ToXpp(ros, point);
   return point;
 }
 
-static xpp_msgs::StateLin3d
-ToRos(const StateLin3d& xpp)
+static void
+ToRos(const StateLin3d& xpp, xpp_msgs::StateLin3d& ros)
 {
-  xpp_msgs::StateLin3d ros;
   ros.pos.x = xpp.p_.x();
   ros.pos.y = xpp.p_.y();
   ros.pos.z = xpp.p_.z();
@@ -84,7 +158,13 @@ ToRos(const StateLin3d& xpp)
   ros.acc.x = xpp.a_.x();
   ros.acc.y = xpp.a_.y();
   ros.acc.z = xpp.a_.z();
+}
 
+static xpp_msgs::StateLin3d
+ToRos(const StateLin3d& xpp)
+{
+  xpp_msgs::StateLin3d ros;
+  ToRos(xpp, ros);
   return ros;
 }
 
@@ -145,11 +225,9 @@ ToRos(const Eigen::Quaterniond xpp)
   return ros;
 }
 
-static xpp_msgs::State6d
-ToRos(const State3d& xpp)
+static void
+ToRos(const State3d& xpp, xpp_msgs::State6d& msg)
 {
-  xpp_msgs::State6d msg;
-
   msg.pose.position = ToRos<geometry_msgs::Point>(xpp.lin.p_);
   msg.twist.linear  = ToRos<geometry_msgs::Vector3>(xpp.lin.v_);
   msg.accel.linear  = ToRos<geometry_msgs::Vector3>(xpp.lin.a_);
@@ -157,15 +235,19 @@ ToRos(const State3d& xpp)
   msg.pose.orientation = ToRos(xpp.ang.q);
   msg.twist.angular    = ToRos<geometry_msgs::Vector3>(xpp.ang.w);
   msg.accel.angular    = ToRos<geometry_msgs::Vector3>(xpp.ang.wd);
+}
 
+static xpp_msgs::State6d
+ToRos(const State3d& xpp)
+{
+  xpp_msgs::State6d msg;
+  ToRos(xpp, msg);
   return msg;
 }
 
-static State3d
-ToXpp(const xpp_msgs::State6d& ros)
+static void
+ToXpp(const xpp_msgs::State6d& ros, State3d& xpp)
 {
-  State3d xpp;
-
   xpp.lin.p_ = ToXpp(ros.pose.position);
   xpp.lin.v_ = ToXpp(ros.twist.linear);
   xpp.lin.a_ = ToXpp(ros.accel.linear);
@@ -173,70 +255,337 @@ ToXpp(const xpp_msgs::State6d& ros)
   xpp.ang.q = ToXpp(ros.pose.orientation);
   xpp.ang.w = ToXpp(ros.twist.angular);
   xpp.ang.wd = ToXpp(ros.accel.angular);
+}
 
+static State3d
+ToXpp(const xpp_msgs::State6d& ros)
+{
+  State3d xpp;
+  ToXpp(ros, xpp);
   return xpp;
 }
 
-static xpp_msgs::RobotStateCartesian
-ToRos(const RobotStateCartesian& xpp)
+static void
+ToRos(const RobotStateCartesian& xpp, xpp_msgs::RobotStateCartesian& ros)
 {
-  xpp_msgs::RobotStateCartesian ros;
-
-  ros.base            = ToRos(xpp.base_);
+  ToRos(xpp.base_, ros.base);
   ros.time_from_start = ros::Duration(xpp.t_global_);
 
+  int n_ee = xpp.ee_contact_.GetEECount();
+  ros.ee_motion.resize(n_ee);
+  ros.ee_contact.resize(n_ee);
+  ros.ee_forces.resize(n_ee);
+
   for (auto ee : xpp.ee_contact_.GetEEsOrdered()) {
-    ros.ee_motion. push_back(ToRos(xpp.ee_motion_.at(ee)));
-    ros.ee_contact.push_back(xpp.ee_contact_.at(ee));
-    ros.ee_forces. push_back(ToRos<geometry_msgs::Vector3>(xpp.ee_forces_.at(ee)));
+    ToRos(xpp.ee_motion_.at(ee), ros.ee_motion.at(ee));
+    ros.ee_contact.at(ee) = xpp.ee_contact_.at(ee);
+    ros.ee_forces.at(ee)  = ToRos<geometry_msgs::Vector3>(xpp.ee_forces_.at(ee));
   }
+}
 
+static xpp_msgs::RobotStateCartesian
+ToRos(const RobotStateCartesian& xpp)
+{
+  xpp_msgs::RobotStateCartesian ros;
+  ToRos(xpp, ros);
   return ros;
 }
 
-static RobotStateCartesian
-ToXpp(const xpp_msgs::RobotStateCartesian& ros)
+static void
+ToXpp(const xpp_msgs::RobotStateCartesian& ros, RobotStateCartesian& xpp)
 {
-
   int n_ee = ros.ee_motion.size();
-  RobotStateCartesian xpp(n_ee);
+  xpp.ee_motion_.SetCount(n_ee);
+  xpp.ee_forces_.SetCount(n_ee);
+  xpp.ee_contact_.SetCount(n_ee);
 
-  xpp.base_     = ToXpp(ros.base);
+  ToXpp(ros.base, xpp.base_);
   xpp.t_global_ = ros.time_from_start.toSec();
 
   for (auto ee : xpp.ee_contact_.GetEEsOrdered()) {
-    xpp.ee_motion_.at(ee)  = ToXpp(ros.ee_motion.at(ee));
+    ToXpp(ros.ee_motion.at(ee), xpp.ee_motion_.at(ee));
     xpp.ee_contact_.at(ee) = ros.ee_contact.at(ee);
     xpp.ee_forces_.at(ee)  = ToXpp(ros.ee_forces.at(ee));
   }
+}
+
+static RobotStateCartesian
+ToXpp(const xpp_msgs::RobotStateCartesian& ros)
+{
+  RobotStateCartesian xpp(ros.ee_motion.size());
+  ToXpp(ros, xpp);
+  return xpp;
+}
+
+/**
+ * @brief Fills the compact message, rounding all values to float precision.
+ */
+static void
+ToRos(const RobotStateCartesian& xpp, xpp_msgs::RobotStateCartesianCompact& ros)
+{
+  using Vec3f = Eigen::Map<Eigen::Vector3f>;
+  using Vec4f = Eigen::Map<Eigen::Vector4f>;
+
+  ros.time_from_start = ros::Duration(xpp.t_global_);
+
+  Vec3f(ros.base_pos.data())     = xpp.base_.lin.p_.cast<float>();
+  Vec4f(ros.base_ori.data())     = xpp.base_.ang.q.coeffs().cast<float>();
+  Vec3f(ros.base_vel.data())     = xpp.base_.lin.v_.cast<float>();
+  Vec3f(ros.base_ang_vel.data()) = xpp.base_.ang.w.cast<float>();
+  Vec3f(ros.base_acc.data())     = xpp.base_.lin.a_.cast<float>();
+  Vec3f(ros.base_ang_acc.data()) = xpp.base_.ang.wd.cast<float>();
+
+  int n_ee = xpp.ee_motion_.GetEECount();
+  ros.ee_pos.resize(3*n_ee);
+  ros.ee_vel.resize(3*n_ee);
+  ros.ee_acc.resize(3*n_ee);
+  ros.ee_forces.resize(3*n_ee);
+
+  for (auto ee : xpp.ee_motion_.GetEEsOrdered()) {
+    const auto& m = xpp.ee_motion_.at(ee);
+    Vec3f(&ros.ee_pos[3*ee])    = m.p_.cast<float>();
+    Vec3f(&ros.ee_vel[3*ee])    = m.v_.cast<float>();
+    Vec3f(&ros.ee_acc[3*ee])    = m.a_.cast<float>();
+    Vec3f(&ros.ee_forces[3*ee]) = xpp.ee_forces_.at(ee).cast<float>();
+  }
+
+  ros.ee_contact = xpp.ee_contact_.GetMask();
+}
+
+static xpp_msgs::RobotStateCartesianCompact
+ToRosCompact(const RobotStateCartesian& xpp)
+{
+  xpp_msgs::RobotStateCartesianCompact ros;
+  ToRos(xpp, ros);
+  return ros;
+}
+
+static void
+ToXpp(const xpp_msgs::RobotStateCartesianCompact& ros, RobotStateCartesian& xpp)
+{
+  using Vec3f = Eigen::Map<const Eigen::Vector3f>;
+  using Vec4f = Eigen::Map<const Eigen::Vector4f>;
+
+  int n_values = ros.ee_pos.size();
+  if (n_values%3 != 0 || ros.ee_vel.size() != ros.ee_pos.size()
+                      || ros.ee_acc.size() != ros.ee_pos.size()
+                      || ros.ee_forces.size() != ros.ee_pos.size())
+    throw std::length_error("xpp::Convert: endeffector channels of compact state differ in length");
+
+  int n_ee = n_values/3;
+  xpp.ee_motion_.SetCount(n_ee);
+  xpp.ee_forces_.SetCount(n_ee);
+  xpp.ee_contact_ = EndeffectorsContact::FromMask(n_ee, ros.ee_contact);
+
+  xpp.t_global_ = ros.time_from_start.toSec();
+
+  xpp.base_.lin.p_ = Vec3f(ros.base_pos.data()).cast<double>();
+  xpp.base_.lin.v_ = Vec3f(ros.base_vel.data()).cast<double>();
+  xpp.base_.lin.a_ = Vec3f(ros.base_acc.data()).cast<double>();
+  xpp.base_.ang.q.coeffs() = Vec4f(ros.base_ori.data()).cast<double>();
+  if (xpp.base_.ang.q.squaredNorm() > 0.0)
+    xpp.base_.ang.q.normalize(); // undo rounding to float, unless unset
+  xpp.base_.ang.w  = Vec3f(ros.base_ang_vel.data()).cast<double>();
+  xpp.base_.ang.wd = Vec3f(ros.base_ang_acc.data()).cast<double>();
+
+  for (auto ee : xpp.ee_motion_.GetEEsOrdered()) {
+    auto& m = xpp.ee_motion_.at(ee);
+    m.p_ = Vec3f(&ros.ee_pos[3*ee]).cast<double>();
+    m.v_ = Vec3f(&ros.ee_vel[3*ee]).cast<double>();
+    m.a_ = Vec3f(&ros.ee_acc[3*ee]).cast<double>();
+    xpp.ee_forces_.at(ee) = Vec3f(&ros.ee_forces[3*ee]).cast<double>();
+  }
+}
 
+static RobotStateCartesian
+ToXpp(const xpp_msgs::RobotStateCartesianCompact& ros)
+{
+  RobotStateCartesian xpp(ros.ee_pos.size()/3);
+  ToXpp(ros, xpp);
   return xpp;
 }
 
+/**
+ * @brief Fills a preallocated message, reusing the memory of its points.
+ */
+static void
+ToRos(const std::vector<RobotStateCartesian>& xpp,
+      xpp_msgs::RobotStateCartesianTrajectory& ros)
+{
+  ros.points.resize(xpp.size());
+  ForEachPoint(xpp.size(), [&](int k) { ToRos(xpp[k], ros.points[k]); });
+}
+
 static xpp_msgs::RobotStateCartesianTrajectory
 ToRos(const std::vector<RobotStateCartesian>& xpp)
 {
   xpp_msgs::RobotStateCartesianTrajectory msg;
-
-  for (const auto state : xpp) {
-    auto state_msg = ToRos(state);
-    msg.points.push_back(state_msg);
-  }
-
+  ToRos(xpp, msg);
   return msg;
 }
 
+/**
+ * @brief Fills a caller-owned vector, which is only resized if necessary.
+ */
+static void
+ToXpp(const xpp_msgs::RobotStateCartesianTrajectory& ros,
+      std::vector<RobotStateCartesian>& xpp)
+{
+  xpp.resize(ros.points.size(), RobotStateCartesian(0));
+  ForEachPoint(xpp.size(), [&](int k) { ToXpp(ros.points[k], xpp[k]); });
+}
+
 static std::vector<RobotStateCartesian>
 ToXpp(const xpp_msgs::RobotStateCartesianTrajectory& ros)
 {
-  std::vector<RobotStateCartesian> xpp_vec;
+  std::vector<RobotStateCartesian> xpp;
+  ToXpp(ros, xpp);
+  return xpp;
+}
 
-  for (const auto ros_state : ros.points) {
-    auto xpp = ToXpp(ros_state);
-    xpp_vec.push_back(xpp);
-  }
+static void
+ToRos(const TrajectoryDelta& xpp, xpp_msgs::RobotStateCartesianTrajectoryDelta& ros)
+{
+  ros.base_version = xpp.base_version_;
+  ros.version      = xpp.version_;
+  ros.t_start      = ros::Duration(xpp.t_start_);
+  ros.t_end        = ros::Duration(xpp.t_end_);
 
-  return xpp_vec;
+  ros.points.resize(xpp.points_.size());
+  ForEachPoint(xpp.points_.size(), [&](int k) { ToRos(xpp.points_[k], ros.points[k]); });
+}
+
+static xpp_msgs::RobotStateCartesianTrajectoryDelta
+ToRos(const TrajectoryDelta& xpp)
+{
+  xpp_msgs::RobotStateCartesianTrajectoryDelta ros;
+  ToRos(xpp, ros);
+  return ros;
+}
+
+static void
+ToXpp(const xpp_msgs::RobotStateCartesianTrajectoryDelta& ros, TrajectoryDelta& xpp)
+{
+  xpp.base_version_ = ros.base_version;
+  xpp.version_      = ros.version;
+  xpp.t_start_      = ros.t_start.toSec();
+  xpp.t_end_        = ros.t_end.toSec();
+
+  xpp.points_.resize(ros.points.size(), RobotStateCartesian(0));
+  ForEachPoint(xpp.points_.size(), [&](int k) { ToXpp(ros.points[k], xpp.points_[k]); });
+}
+
+static TrajectoryDelta
+ToXpp(const xpp_msgs::RobotStateCartesianTrajectoryDelta& ros)
+{
+  TrajectoryDelta xpp;
+  ToXpp(ros, xpp);
+  return xpp;
+}
+
+static void
+ToRos(const CartesianTrajectory& xpp, xpp_msgs::RobotStateCartesianTrajectory& msg)
+{
+  int n_ee = xpp.GetEECount();
+  msg.points.resize(xpp.size());
+
+  ForEachPoint(xpp.size(), [&](int k) {
+    auto state = xpp.at(k);
+    auto& ros  = msg.points[k];
+
+    ToRos(state.base(), ros.base);
+    ros.time_from_start = ros::Duration(state.t_global());
+
+    ros.ee_motion.resize(n_ee);
+    ros.ee_contact.resize(n_ee);
+    ros.ee_forces.resize(n_ee);
+    for (int ee=0; ee<n_ee; ++ee) {
+      ToRos(state.ee_motion(ee), ros.ee_motion[ee]);
+      ros.ee_contact[ee] = state.ee_contact(ee);
+      ros.ee_forces[ee]  = ToRos<geometry_msgs::Vector3>(state.ee_forces(ee));
+    }
+  });
+}
+
+static xpp_msgs::RobotStateCartesianTrajectory
+ToRos(const CartesianTrajectory& xpp)
+{
+  xpp_msgs::RobotStateCartesianTrajectory msg;
+  ToRos(xpp, msg);
+  return msg;
+}
+
+/**
+ * @brief Fills the columnar trajectory directly from the message.
+ * @throws std::invalid_argument if the points differ in their number of
+ *         endeffectors, as the columns hold the same endeffectors throughout.
+ */
+static void
+ToXpp(const xpp_msgs::RobotStateCartesianTrajectory& ros, CartesianTrajectory& xpp)
+{
+  using Traj = CartesianTrajectory;
+
+  int n = ros.points.size();
+  int n_ee = ros.points.empty()? 0 : ros.points.front().ee_motion.size();
+  for (const auto& p : ros.points)
+    if (int(p.ee_motion.size()) != n_ee || int(p.ee_forces.size()) != n_ee
+                                        || int(p.ee_contact.size()) != n_ee)
+      throw std::invalid_argument("xpp::Convert: points of trajectory differ in number of endeffectors");
+
+  xpp = CartesianTrajectory(n_ee);
+  xpp.Resize(n);
+
+  ForEachPoint(n, [&](int k) {
+    const auto& p = ros.points.at(k);
+    const auto& b = p.base;
+
+    xpp.t_global_[k] = p.time_from_start.toSec();
+
+    xpp.base_pos_[X][k] = b.pose.position.x;
+    xpp.base_pos_[Y][k] = b.pose.position.y;
+    xpp.base_pos_[Z][k] = b.pose.position.z;
+    xpp.base_vel_[X][k] = b.twist.linear.x;
+    xpp.base_vel_[Y][k] = b.twist.linear.y;
+    xpp.base_vel_[Z][k] = b.twist.linear.z;
+    xpp.base_acc_[X][k] = b.accel.linear.x;
+    xpp.base_acc_[Y][k] = b.accel.linear.y;
+    xpp.base_acc_[Z][k] = b.accel.linear.z;
+
+    xpp.base_ori_[Traj::QW][k] = b.pose.orientation.w;
+    xpp.base_ori_[Traj::QX][k] = b.pose.orientation.x;
+    xpp.base_ori_[Traj::QY][k] = b.pose.orientation.y;
+    xpp.base_ori_[Traj::QZ][k] = b.pose.orientation.z;
+    xpp.base_w_[X][k]  = b.twist.angular.x;
+    xpp.base_w_[Y][k]  = b.twist.angular.y;
+    xpp.base_w_[Z][k]  = b.twist.angular.z;
+    xpp.base_wd_[X][k] = b.accel.angular.x;
+    xpp.base_wd_[Y][k] = b.accel.angular.y;
+    xpp.base_wd_[Z][k] = b.accel.angular.z;
+
+    EndeffectorsContact contact(n_ee);
+
+    for (int ee=0; ee<n_ee; ++ee) {
+      const auto& m = p.ee_motion.at(ee);
+      const auto& f = p.ee_forces.at(ee);
+
+      xpp.ee_pos_[ee][X][k] = m.pos.x;
+      xpp.ee_pos_[ee][Y][k] = m.pos.y;
+      xpp.ee_pos_[ee][Z][k] = m.pos.z;
+      xpp.ee_vel_[ee][X][k] = m.vel.x;
+      xpp.ee_vel_[ee][Y][k] = m.vel.y;
+      xpp.ee_vel_[ee][Z][k] = m.vel.z;
+      xpp.ee_acc_[ee][X][k] = m.acc.x;
+      xpp.ee_acc_[ee][Y][k] = m.acc.y;
+      xpp.ee_acc_[ee][Z][k] = m.acc.z;
+
+      xpp.ee_forces_[ee][X][k] = f.x;
+      xpp.ee_forces_[ee][Y][k] = f.y;
+      xpp.ee_forces_[ee][Z][k] = f.z;
+
+      contact.at(ee) = p.ee_contact.at(ee);
+    }
+    xpp.ee_contact_[k] = contact.GetMask();
+  });
 }
 
 };
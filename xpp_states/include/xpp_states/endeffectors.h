@@ -30,8 +30,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef _XPP_STATES_ENDEFFECTORS_H_
 #define _XPP_STATES_ENDEFFECTORS_H_
 
-#include <deque>
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 #include <xpp_states/state.h>
@@ -40,6 +44,137 @@ namespace xpp {
 
 using EndeffectorID = uint;
 
+/**
+ * @brief The number of endeffectors that fit into the default storage.
+ */
+static constexpr int kMaxEndeffectors = 8;
+
+/**
+ * @brief Creates a value-initialized T.
+ *
+ * T() leaves fixed-size Eigen types uninitialized, so these are set to zero.
+ */
+template<typename T, typename Enable = void>
+struct ValueInitialized {
+  static T Get() { return T(); };
+};
+
+template<typename T>
+struct ValueInitialized<T, typename std::enable_if<
+    std::is_base_of<Eigen::DenseBase<T>, T>::value &&
+    T::SizeAtCompileTime != Eigen::Dynamic>::type> {
+  static T Get() { return T::Zero(); };
+};
+
+
+/**
+ * @brief Fixed-capacity sequence container stored inline (no heap).
+ *
+ * Offers the subset of the STL-sequence interface used for endeffectors. The
+ * elements live inside the object itself, so creating or copying
+ * endeffector values never allocates memory. Exceeding the capacity throws
+ * std::length_error, accessing a non-existing element std::out_of_range.
+ */
+template<typename T, int Capacity>
+class InlineContainer {
+public:
+  using value_type     = T;
+  using iterator       = T*;
+  using const_iterator = const T*;
+
+  InlineContainer (int n = 0) { resize(n); };
+
+  void resize(int n)
+  {
+    if (n < 0 || n > Capacity)
+      throw std::length_error("xpp::InlineContainer: capacity exceeded");
+    if (n > size_)
+      std::fill(data_+size_, data_+n, ValueInitialized<T>::Get()); // as std::vector
+    size_ = n;
+  }
+
+  void resize(int n, const T& value)
+  {
+    T val = value; // value might reference an element of this container
+    int n_prev = size_;
+    resize(n);
+    std::fill(data_+std::min(n_prev, n), data_+n, val);
+  }
+
+  int  size()  const { return size_; };
+  bool empty() const { return size_ == 0; };
+  static constexpr int capacity() { return Capacity; };
+
+  T& at(int i)
+  {
+    if (i < 0 || i >= size_)
+      throw std::out_of_range("xpp::InlineContainer::at");
+    return data_[i];
+  }
+
+  const T& at(int i) const
+  {
+    if (i < 0 || i >= size_)
+      throw std::out_of_range("xpp::InlineContainer::at");
+    return data_[i];
+  }
+
+  T&       operator[](int i)       { return data_[i]; };
+  const T& operator[](int i) const { return data_[i]; };
+  T&       front()       { return data_[0]; };
+  const T& front() const { return data_[0]; };
+  T&       back()        { return data_[size_-1]; };
+  const T& back()  const { return data_[size_-1]; };
+
+  iterator       begin()       { return data_; };
+  iterator       end()         { return data_+size_; };
+  const_iterator begin() const { return data_; };
+  const_iterator end()   const { return data_+size_; };
+
+private:
+  T data_[Capacity]; // elements up to size_ initialized by resize().
+  int size_ = 0;
+};
+
+
+/**
+ * @brief The endeffector IDs 0,...,n-1 that can be iterated without allocation.
+ *
+ * Can be used in range-based for loops and converted to a std::vector of
+ * IDs, e.g. to define a specific endeffector order.
+ */
+class EndeffectorRange {
+public:
+  class Iterator {
+  public:
+    explicit Iterator (EndeffectorID ee) : ee_(ee) {};
+    EndeffectorID operator*() const { return ee_; };
+    Iterator& operator++() { ++ee_; return *this; };
+    bool operator!=(const Iterator& other) const { return ee_ != other.ee_; };
+    bool operator==(const Iterator& other) const { return ee_ == other.ee_; };
+  private:
+    EndeffectorID ee_;
+  };
+
+  explicit EndeffectorRange (int n_ee) : n_ee_(n_ee) {};
+
+  Iterator begin() const { return Iterator(0); };
+  Iterator end()   const { return Iterator(n_ee_); };
+  int size() const { return n_ee_; };
+
+  operator std::vector<EndeffectorID>() const
+  {
+    std::vector<EndeffectorID> vec(n_ee_);
+    for (int i=0; i<n_ee_; ++i)
+      vec.at(i) = i;
+    return vec;
+  }
+
+private:
+  int n_ee_;
+};
+
+
 /**
  * @brief Data structure to assign values to each endeffector.
  *
@@ -53,13 +188,17 @@ using EndeffectorID = uint;
  *
  * The idea is that this class is an enhanced STL container, but complies to the
  * same interface, (e.g at()). However, in case this unified interface is
- * burdensome, you can always access the underlying STL-deque container directly.
+ * burdensome, you can always access the underlying container directly.
+ *
+ * By default the values are stored inline for up to kMaxEndeffectors
+ * endeffectors, so no heap memory is used. Robots with more endeffectors can
+ * choose a different storage policy, e.g. Endeffectors<T, std::deque<T>>.
  */
-template<typename T>
+template<typename T, typename ContainerT = InlineContainer<T, kMaxEndeffectors>>
 class Endeffectors {
 public:
-  using Container     = std::deque<T>;   // only to avoid faulty std::vector<bool>
-  using EndeffectorsT = Endeffectors<T>;
+  using Container     = ContainerT;
+  using EndeffectorsT = Endeffectors<T, ContainerT>;
 
   Endeffectors (int n_ee = 0);
   virtual ~Endeffectors () = default;
@@ -82,7 +221,7 @@ public:
   /**
    * @returns All endeffector IDs from 0 to the number of endeffectors.
    */
-  std::vector<EndeffectorID> GetEEsOrdered() const;
+  EndeffectorRange GetEEsOrdered() const;
 
   /**
    * @brief Read/write access to the endeffector stored at index ee.
@@ -105,7 +244,7 @@ public:
   bool operator!=(const Endeffectors& other) const;
 
   /**
-   * @returns a returns a copy(!) of the underlying STL-deque container.
+   * @returns a returns a copy(!) of the underlying container.
    */
   Container ToImpl() const;
 
@@ -145,95 +284,208 @@ public:
  * Says if an endeffector is currently touching the environment or not.
  * This is often an important criteria for motion planning, as only in the
  * contact state can forces be exerted that move the body.
+ *
+ * The flags are packed into a single bitmask (bit ee set if endeffector ee
+ * is in contact), so counting contacts and detecting gait events between
+ * two states are single word operations, e.g.
+ *
+ *   touchdown = ~prev & curr;
+ *   liftoff   = prev & ~curr;
  */
-class EndeffectorsContact : public Endeffectors<bool> {
+class EndeffectorsContact {
 public:
+  using Mask = uint32_t;
+  static constexpr int kMaxCount = 8*sizeof(Mask);
+
+  /**
+   * @brief Read/write reference to the contact flag of one endeffector.
+   */
+  class Reference {
+  public:
+    Reference (Mask& mask, EndeffectorID ee) : mask_(mask), bit_(Mask(1) << ee) {};
+    operator bool() const { return mask_ & bit_; };
+    Reference& operator=(bool in_contact)
+    {
+      mask_ = in_contact? (mask_ | bit_) : (mask_ & ~bit_);
+      return *this;
+    }
+    Reference& operator=(const Reference& other) { return *this = bool(other); };
+  private:
+    Mask& mask_;
+    Mask bit_;
+  };
+
   /**
    * @brief Constructs a state, the default being 0 feet, none in contact.
    * @param  n_ee  Number of endeffectors.
    * @param  in_contact  True if all legs should be in contact, false otherwise.
    */
   EndeffectorsContact (int n_ee=0, bool in_contact=false)
-      :Endeffectors(n_ee) { SetAll(in_contact);};
+  {
+    SetCount(n_ee);
+    SetAll(in_contact);
+  }
+
+  /**
+   * @brief Constructs the contact state directly from a bitmask.
+   */
+  static EndeffectorsContact FromMask(int n_ee, Mask mask)
+  {
+    EndeffectorsContact c(n_ee);
+    c.mask_ = mask & c.GetAllMask();
+    return c;
+  }
+
+  void SetCount(int n_ee)
+  {
+    if (n_ee < 0 || n_ee > kMaxCount)
+      throw std::length_error("xpp::EndeffectorsContact: too many endeffectors");
+    n_ee_ = n_ee;
+    mask_ &= GetAllMask(); // clear flags of removed endeffectors
+  }
+
+  void SetAll(bool in_contact) { mask_ = in_contact? GetAllMask() : 0; };
+  int GetEECount() const { return n_ee_; };
+  EndeffectorRange GetEEsOrdered() const { return EndeffectorRange(n_ee_); };
+
+  /**
+   * @brief Read/write access to the contact flag of endeffector ee.
+   */
+  Reference at(EndeffectorID ee)
+  {
+    CheckRange(ee);
+    return Reference(mask_, ee);
+  }
+
+  /**
+   * @brief Read access to the contact flag of endeffector ee.
+   */
+  bool at(EndeffectorID ee) const
+  {
+    CheckRange(ee);
+    return (mask_ >> ee) & 1;
+  }
 
   /**
    * @brief The number of endeffectors in contact with the environment.
    */
-  int GetContactCount() const
+  int GetContactCount() const { return std::bitset<kMaxCount>(mask_).count(); };
+
+  /**
+   * @brief Bit ee is set if endeffector ee is in contact.
+   */
+  Mask GetMask() const { return mask_; };
+
+  bool operator==(const EndeffectorsContact& other) const
   {
-    int count = 0;
-    for (auto ee : GetEEsOrdered())
-      if (at(ee))
-        count++;
+    return n_ee_ == other.n_ee_ && mask_ == other.mask_;
+  }
+  bool operator!=(const EndeffectorsContact& other) const { return !(*this == other); };
+
+  EndeffectorsContact operator~() const { return FromMask(n_ee_, ~mask_); };
+  EndeffectorsContact operator&(const EndeffectorsContact& rhs) const { return FromMask(n_ee_, mask_ & rhs.mask_); };
+  EndeffectorsContact operator|(const EndeffectorsContact& rhs) const { return FromMask(n_ee_, mask_ | rhs.mask_); };
+  EndeffectorsContact operator^(const EndeffectorsContact& rhs) const { return FromMask(n_ee_, mask_ ^ rhs.mask_); };
 
-    return count;
+  /**
+   * @returns The endeffectors that are in contact now, but were not before.
+   */
+  static EndeffectorsContact GetTouchdowns(const EndeffectorsContact& prev,
+                                           const EndeffectorsContact& curr)
+  {
+    return ~prev & curr;
   }
+
+  /**
+   * @returns The endeffectors that were in contact before, but are not now.
+   */
+  static EndeffectorsContact GetLiftoffs(const EndeffectorsContact& prev,
+                                         const EndeffectorsContact& curr)
+  {
+    return prev & ~curr;
+  }
+
+private:
+  Mask GetAllMask() const { return n_ee_ == kMaxCount? ~Mask(0) : (Mask(1) << n_ee_) - 1; };
+
+  void CheckRange(EndeffectorID ee) const
+  {
+    if (ee >= static_cast<EndeffectorID>(n_ee_))
+      throw std::out_of_range("xpp::EndeffectorsContact::at");
+  }
+
+  Mask mask_ = 0;
+  int n_ee_  = 0;
 };
 
+inline std::ostream& operator<<(std::ostream& stream, const EndeffectorsContact& c)
+{
+  for (EndeffectorID ee : c.GetEEsOrdered())
+    stream << c.at(ee) << ", ";
+
+  return stream;
+}
+
 
 // implementations
-template<typename T>
-Endeffectors<T>::Endeffectors (int n_ee)
+template<typename T, typename C>
+Endeffectors<T,C>::Endeffectors (int n_ee)
 {
   SetCount(n_ee);
 }
 
-template<typename T>
+template<typename T, typename C>
 void
-Endeffectors<T>::SetCount (int n_ee)
+Endeffectors<T,C>::SetCount (int n_ee)
 {
   ee_.resize(n_ee);
 }
 
-template<typename T>
+template<typename T, typename C>
 void
-Endeffectors<T>::SetAll (const T& value)
+Endeffectors<T,C>::SetAll (const T& value)
 {
   std::fill(ee_.begin(), ee_.end(), value);
 }
 
-template<typename T>
+template<typename T, typename C>
 T&
-Endeffectors<T>::at (EndeffectorID idx)
+Endeffectors<T,C>::at (EndeffectorID idx)
 {
   return ee_.at(idx);
 }
 
-template<typename T>
+template<typename T, typename C>
 const T&
-Endeffectors<T>::at (EndeffectorID idx) const
+Endeffectors<T,C>::at (EndeffectorID idx) const
 {
   return ee_.at(idx);
 }
 
-template<typename T>
+template<typename T, typename C>
 int
-Endeffectors<T>::GetEECount () const
+Endeffectors<T,C>::GetEECount () const
 {
   return ee_.size();
 }
 
-template<typename T>
-typename Endeffectors<T>::Container
-Endeffectors<T>::ToImpl () const
+template<typename T, typename C>
+typename Endeffectors<T,C>::Container
+Endeffectors<T,C>::ToImpl () const
 {
   return ee_;
 }
 
-template<typename T>
-std::vector<EndeffectorID>
-Endeffectors<T>::GetEEsOrdered () const
+template<typename T, typename C>
+EndeffectorRange
+Endeffectors<T,C>::GetEEsOrdered () const
 {
-  std::vector<EndeffectorID> vec;
-  for (int i=0; i<ee_.size(); ++i)
-    vec.push_back(i);
-
-  return vec;
+  return EndeffectorRange(ee_.size());
 }
 
-template<typename T>
-const typename Endeffectors<T>::EndeffectorsT
-Endeffectors<T>::operator - (const EndeffectorsT& rhs) const
+template<typename T, typename C>
+const typename Endeffectors<T,C>::EndeffectorsT
+Endeffectors<T,C>::operator - (const EndeffectorsT& rhs) const
 {
   EndeffectorsT result(ee_.size());
   for (auto i : GetEEsOrdered())
@@ -242,9 +494,9 @@ Endeffectors<T>::operator - (const EndeffectorsT& rhs) const
   return result;
 }
 
-template<typename T>
-const typename Endeffectors<T>::EndeffectorsT
-Endeffectors<T>::operator / (double scalar) const
+template<typename T, typename C>
+const typename Endeffectors<T,C>::EndeffectorsT
+Endeffectors<T,C>::operator / (double scalar) const
 {
   EndeffectorsT result(ee_.size());
   for (auto i : GetEEsOrdered())
@@ -253,8 +505,8 @@ Endeffectors<T>::operator / (double scalar) const
   return result;
 }
 
-template <typename T>
-std::ostream& operator<<(std::ostream& stream, Endeffectors<T> endeffectors)
+template <typename T, typename C>
+std::ostream& operator<<(std::ostream& stream, const Endeffectors<T,C>& endeffectors)
 {
   for (EndeffectorID ee : endeffectors.GetEEsOrdered())
     stream << endeffectors.at(ee) << ", ";
@@ -262,9 +514,9 @@ std::ostream& operator<<(std::ostream& stream, Endeffectors<T> endeffectors)
   return stream;
 }
 
-template<typename T>
+template<typename T, typename C>
 bool
-Endeffectors<T>::operator!=(const Endeffectors& other) const
+Endeffectors<T,C>::operator!=(const Endeffectors& other) const
 {
   for (auto ee : GetEEsOrdered()) {
     if (ee_.at(ee) != other.at(ee))
@@ -0,0 +1,126 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef _XPP_STATES_FOOTHOLD_MAP_H_
+#define _XPP_STATES_FOOTHOLD_MAP_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include <xpp_states/robot_state_cartesian.h>
+
+namespace xpp {
+
+/**
+ * @brief All positions at which endeffectors touched the ground.
+ *
+ * The footholds are stored in a uniform grid with the deduplication
+ * tolerance as cell size. A foothold closer than this tolerance to an
+ * existing one is not added again, so a foot standing still over many
+ * states is stored only once. Adding a foothold and finding the footholds
+ * within a radius or box only visits the grid cells around it, independent
+ * of the number of stored footholds.
+ */
+class FootholdMap {
+public:
+  struct Foothold {
+    Vector3d pos;
+    EndeffectorID ee; ///< the endeffector that first touched it.
+    double t;         ///< the time it was first touched [s].
+  };
+
+  /**
+   * @param  tolerance  Footholds closer than this are considered equal [m].
+   */
+  explicit FootholdMap(double tolerance = 0.02);
+  ~FootholdMap() = default;
+
+  /**
+   * @brief Adds the positions of all endeffectors in contact.
+   * @returns the number of new footholds.
+   */
+  int Add(const RobotStateCartesian& state);
+
+  /**
+   * @brief As above, e.g. with the values read from a RobotStateCartesianView.
+   * @returns the number of new footholds.
+   */
+  int Add(const EndeffectorsPos& pos, const EndeffectorsContact& contact, double t);
+
+  /**
+   * @returns false if the position is a duplicate of an existing foothold.
+   */
+  bool Add(const Vector3d& pos, EndeffectorID ee, double t);
+
+  /**
+   * @returns the indices of all footholds within radius of center.
+   */
+  std::vector<int> FindInRadius(const Vector3d& center, double radius) const;
+
+  /**
+   * @returns the indices of all footholds inside the axis aligned box.
+   */
+  std::vector<int> FindInBox(const Vector3d& min, const Vector3d& max) const;
+
+  const Foothold& at(int i) const { return footholds_.at(i); };
+  const std::vector<Foothold>& GetFootholds() const { return footholds_; };
+  int GetCount() const { return footholds_.size(); };
+  double GetTolerance() const { return tolerance_; };
+
+  void Clear();
+
+private:
+  struct Cell {
+    int x, y, z;
+    bool operator==(const Cell& c) const { return x == c.x && y == c.y && z == c.z; };
+  };
+
+  struct CellHash {
+    size_t operator()(const Cell& c) const
+    {
+      return (size_t(c.x)*73856093) ^ (size_t(c.y)*19349663) ^ (size_t(c.z)*83492791);
+    }
+  };
+
+  double tolerance_;
+  std::vector<Foothold> footholds_;
+  std::unordered_map<Cell, std::vector<int>, CellHash> grid_;
+
+  Cell GetCell(const Vector3d& pos) const;
+
+  /**
+   * @brief Calls visit(i) for every foothold in the cells overlapping the box.
+   */
+  template<typename Fn>
+  void ForEachInBox(const Vector3d& min, const Vector3d& max, Fn visit) const;
+};
+
+} /* namespace xpp */
+
+#endif /* _XPP_STATES_FOOTHOLD_MAP_H_ */
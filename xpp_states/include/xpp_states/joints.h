@@ -44,14 +44,18 @@ namespace xpp {
  * joints are grouped in this fashion. They can also be transformed to or set
  * from an undiscriminative Eigen::VectorXd. This however is not recommended,
  * as this Cartesian <->joint relationship is then lost/hidden.
+ *
+ * All joint values are stored in one contiguous Eigen vector, starting with
+ * the joints of endeffector 0. The joints of a single endeffector are
+ * accessed through a view into this vector, so no values are copied.
  */
-class Joints : public Endeffectors<VectorXd> {
+class Joints {
 public:
-  using Base = Endeffectors<VectorXd>;
-  using Base::GetEECount;
-  using Base::at;
-  using EEOrder = std::vector<EndeffectorID>;
-  using JointID = uint;
+  using EEOrder     = std::vector<EndeffectorID>;
+  using JointID     = uint;
+  using EEJoints    = Eigen::VectorBlock<VectorXd>;
+  using EEJointsConst = Eigen::VectorBlock<const VectorXd>;
+  using Permutation = Eigen::PermutationMatrix<Eigen::Dynamic>;
 
   /**
    * @brief  Constructs joint values all set to value.
@@ -73,22 +77,57 @@ public:
    * Attention: Each endeffector must have the same number of joints.
    */
   explicit Joints (const std::vector<VectorXd>& joints);
-  virtual ~Joints () = default;
+  ~Joints () = default;
+
+  /**
+   * @brief Read/write view of the joint values of endeffector ee.
+   * @throws std::out_of_range if ee does not exist.
+   */
+  EEJoints at(EndeffectorID ee);
+
+  /**
+   * @brief Read-only view of the joint values of endeffector ee.
+   * @throws std::out_of_range if ee does not exist.
+   */
+  EEJointsConst at(EndeffectorID ee) const;
+
+  /**
+   * @brief Read/write view of the joint values of endeffector ee (unchecked).
+   */
+  EEJoints operator[](EndeffectorID ee);
+
+  /**
+   * @brief Read-only view of the joint values of endeffector ee (unchecked).
+   */
+  EEJointsConst operator[](EndeffectorID ee) const;
+
+  /**
+   * @brief Sets each endeffector's joints to the same values.
+   */
+  void SetAll(const VectorXd& q_ee);
 
   /**
-   * @brief Converts joint values to Eigen vector.
+   * @brief All joint values as one Eigen vector (no copy).
    *
    * The endeffectors are starting from zero and for each endeffector
    * the joints are appended in the order they where inserted.
    */
-  VectorXd ToVec() const;
+  const VectorXd& ToVec() const;
 
   /**
    * @brief Converts joint values to Eigen vector according to specific order.
    * @param ee_order  The order in which the endeffector's joints are appended.
+   * @throws std::out_of_range if an endeffector in ee_order does not exist.
    */
   VectorXd ToVec(const EEOrder& ee_order) const;
 
+  /**
+   * @brief Converts joint values to Eigen vector according to a permutation.
+   * @param P  The permutation precomputed through GetPermutation().
+   * @throws std::invalid_argument if P has a different size.
+   */
+  VectorXd ToVec(const Permutation& P) const;
+
   /**
    * @brief Sets joints values from Eigen vector.
    * @param q The Eigen Vector of joint values.
@@ -96,6 +135,7 @@ public:
    * The vector q is interpreted as if the top n_joints_per_leg values
    * rows belong to endeffector 0, the next n_joints_per_leg values to
    * endeffector 1 and so on.
+   * @throws std::invalid_argument if q has a different number of joints.
    */
   void SetFromVec(const VectorXd& q);
 
@@ -103,25 +143,51 @@ public:
    * @brief Sets joint values from Eigen vector in specific order.
    * @param q         The Eigen Vector of joint values.
    * @param ee_order  Describes the internal order of q.
+   * @throws std::invalid_argument if q does not match ee_order.
    */
   void SetFromVec(const VectorXd& q, const EEOrder& ee_order);
 
+  /**
+   * @brief Sets joint values from Eigen vector in specific order.
+   * @param q  The Eigen Vector of joint values.
+   * @param P  The permutation precomputed through GetPermutation().
+   * @throws std::invalid_argument if q or P have a different size.
+   */
+  void SetFromVec(const VectorXd& q, const Permutation& P);
+
+  /**
+   * @brief Builds the permutation that reorders the joints into ee_order.
+   *
+   * Compute this once and reuse it for every conversion, so reordering
+   * reduces to a single pass over the joint values.
+   * @throws std::invalid_argument if ee_order does not contain every
+   *         endeffector exactly once.
+   */
+  Permutation GetPermutation(const EEOrder& ee_order) const;
+
   /**
    * @returns read/write access of the joint value at index joint.
+   * @throws std::out_of_range if joint does not exist.
    */
   double& GetJoint(JointID joint);
 
   /**
    * @returns read access of the joint value at index joint.
+   * @throws std::out_of_range if joint does not exist.
    */
   double GetJoint(JointID joint) const;
 
+  int GetEECount() const;
+  EndeffectorRange GetEEsOrdered() const;
   int GetNumJoints() const;
   int GetNumJointsPerEE() const;
 
 private:
+  int n_ee_;
   int n_joints_per_leg_;
-  int n_joints_;
+  VectorXd q_;
+
+  void CheckSize(int n_joints) const;
 };
 
 } /* namespace xpp */
@@ -52,6 +52,11 @@ public:
    * @param  n_ee  Number of endeffectors.
    */
   RobotStateCartesian(int n_ee);
+
+  /**
+   * @brief  Constructs a state without endeffectors, e.g. to deserialize into.
+   */
+  RobotStateCartesian() : RobotStateCartesian(0) {};
   ~RobotStateCartesian() = default;
 
   State3d base_;
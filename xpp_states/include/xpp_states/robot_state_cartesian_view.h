@@ -0,0 +1,164 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef _XPP_STATES_ROBOT_STATE_CARTESIAN_VIEW_H_
+#define _XPP_STATES_ROBOT_STATE_CARTESIAN_VIEW_H_
+
+#include <cstddef>
+#include <type_traits>
+
+#include <Eigen/Dense>
+
+#include <xpp_msgs/RobotStateCartesian.h>
+
+#include <xpp_states/state.h>
+#include <xpp_states/endeffectors.h>
+
+namespace xpp {
+
+/**
+ * @brief Read-only view of a RobotStateCartesian message as xpp types.
+ *
+ * Instead of copying the message into a RobotStateCartesian
+ * (see Convert::ToXpp()), the accessors map Eigen types directly onto the
+ * double fields of the message. The view only holds a reference, so the
+ * message must outlive it.
+ *
+ * see also robot_state_cartesian.h.
+ */
+class RobotStateCartesianView {
+public:
+  using Msg       = xpp_msgs::RobotStateCartesian;
+  using Vec3Map   = Eigen::Map<const Vector3d>;
+  using QuatMap   = Eigen::Map<const Eigen::Quaterniond>;
+
+  explicit RobotStateCartesianView(const Msg& msg) : msg_(msg) {};
+  ~RobotStateCartesianView() = default;
+
+  double GetTime() const { return msg_.time_from_start.toSec(); };
+
+  Vec3Map GetBasePos()    const { return Map(msg_.base.pose.position); };
+  Vec3Map GetBaseVel()    const { return Map(msg_.base.twist.linear);  };
+  Vec3Map GetBaseAcc()    const { return Map(msg_.base.accel.linear);  };
+  QuatMap GetBaseOri()    const { return Map(msg_.base.pose.orientation); };
+  Vec3Map GetBaseAngVel() const { return Map(msg_.base.twist.angular); };
+  Vec3Map GetBaseAngAcc() const { return Map(msg_.base.accel.angular); };
+
+  int GetEECount() const { return msg_.ee_motion.size(); };
+
+  Vec3Map GetEEPos(EndeffectorID ee)   const { return Map(msg_.ee_motion.at(ee).pos); };
+  Vec3Map GetEEVel(EndeffectorID ee)   const { return Map(msg_.ee_motion.at(ee).vel); };
+  Vec3Map GetEEAcc(EndeffectorID ee)   const { return Map(msg_.ee_motion.at(ee).acc); };
+  Vec3Map GetEEForce(EndeffectorID ee) const { return Map(msg_.ee_forces.at(ee));     };
+  bool    IsInContact(EndeffectorID ee) const { return msg_.ee_contact.at(ee);       };
+
+  /**
+   * @brief The contact flags of all endeffectors as a bitmask.
+   */
+  EndeffectorsContact GetContact() const;
+
+  /**
+   * @brief Gathers the endeffector positions into an inline container.
+   *
+   * For functions that expect Endeffectors, this copies only the positions
+   * and does not allocate.
+   */
+  Endeffectors<Vector3d> GetEEPositions() const;
+
+  /**
+   * @brief Gathers the endeffector forces into an inline container.
+   */
+  Endeffectors<Vector3d> GetEEForces() const;
+
+  const Msg& GetMsg() const { return msg_; };
+
+private:
+  const Msg& msg_;
+
+  template<typename T>
+  static Vec3Map Map(const T& ros);
+  static QuatMap Map(const geometry_msgs::Quaternion& ros);
+};
+
+
+// implementations
+template<typename T>
+RobotStateCartesianView::Vec3Map
+RobotStateCartesianView::Map(const T& ros)
+{
+  static_assert(std::is_standard_layout<T>::value
+                && offsetof(T, y) == offsetof(T, x) + sizeof(double)
+                && offsetof(T, z) == offsetof(T, y) + sizeof(double),
+                "x, y, z of message must be contiguous to be mapped.");
+  return Vec3Map(&ros.x);
+}
+
+inline RobotStateCartesianView::QuatMap
+RobotStateCartesianView::Map(const geometry_msgs::Quaternion& ros)
+{
+  // Eigen stores quaternion coefficients in the same x, y, z, w order.
+  using T = geometry_msgs::Quaternion;
+  static_assert(std::is_standard_layout<T>::value
+                && offsetof(T, y) == offsetof(T, x) + sizeof(double)
+                && offsetof(T, z) == offsetof(T, y) + sizeof(double)
+                && offsetof(T, w) == offsetof(T, z) + sizeof(double),
+                "x, y, z, w of message must be contiguous to be mapped.");
+  return QuatMap(&ros.x);
+}
+
+inline EndeffectorsContact
+RobotStateCartesianView::GetContact() const
+{
+  EndeffectorsContact contact(GetEECount());
+  for (auto ee : contact.GetEEsOrdered())
+    contact.at(ee) = IsInContact(ee);
+  return contact;
+}
+
+inline Endeffectors<Vector3d>
+RobotStateCartesianView::GetEEPositions() const
+{
+  Endeffectors<Vector3d> pos(GetEECount());
+  for (auto ee : pos.GetEEsOrdered())
+    pos.at(ee) = GetEEPos(ee);
+  return pos;
+}
+
+inline Endeffectors<Vector3d>
+RobotStateCartesianView::GetEEForces() const
+{
+  Endeffectors<Vector3d> f(GetEECount());
+  for (auto ee : f.GetEEsOrdered())
+    f.at(ee) = GetEEForce(ee);
+  return f;
+}
+
+} /* namespace xpp */
+
+#endif /* _XPP_STATES_ROBOT_STATE_CARTESIAN_VIEW_H_ */
@@ -52,6 +52,11 @@ public:
    * @param  n_joints_per_ee  Number of joints for each endeffector.
    */
   RobotStateJoint (int n_ee, int n_joints_per_ee);
+
+  /**
+   * @brief  Constructs a state without joints, e.g. to deserialize into.
+   */
+  RobotStateJoint () : RobotStateJoint(0, 0) {};
   virtual ~RobotStateJoint () = default;
 
   State3d base_;
@@ -0,0 +1,388 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef XPP_STATES_SERIALIZATION_H_
+#define XPP_STATES_SERIALIZATION_H_
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ros/message_traits.h>
+#include <ros/serialization.h>
+#include <std_msgs/Header.h>
+
+#include <xpp_msgs/RobotStateCartesian.h>
+#include <xpp_msgs/RobotStateCartesianTrajectory.h>
+#include <xpp_msgs/RobotStateJoint.h>
+
+#include <xpp_states/state.h>
+#include <xpp_states/robot_state_cartesian.h>
+#include <xpp_states/robot_state_joint.h>
+
+/**
+ * @file serialization.h
+ *
+ * ROS message traits and serializers that let xpp states be published and
+ * subscribed to directly, e.g.
+ *
+ *   ros::Publisher pub = n.advertise<xpp::RobotStateCartesian>(topic, 1);
+ *   pub.publish(state);
+ *
+ * The bytes on the wire are identical to those of the corresponding
+ * xpp_msgs message, so either side can keep using the message types:
+ *
+ *   xpp::RobotStateCartesian           <-> xpp_msgs::RobotStateCartesian
+ *   xpp::RobotStateJoint               <-> xpp_msgs::RobotStateJoint
+ *   xpp::RobotStateCartesianTrajectory <-> xpp_msgs::RobotStateCartesianTrajectory
+ *
+ * Values are written straight from the Eigen storage, without building the
+ * message first (see Convert::ToRos()).
+ */
+
+namespace xpp {
+
+/**
+ * @brief A sequence of Cartesian states sent as a trajectory message.
+ *
+ * Wrapping the states in their own type leaves the serialization of any
+ * other std::vector<RobotStateCartesian> untouched.
+ */
+struct RobotStateCartesianTrajectory {
+  std::vector<RobotStateCartesian> points;
+};
+
+} // namespace xpp
+
+
+namespace ros {
+namespace message_traits {
+
+/**
+ * @brief Makes xpp type Xpp report the md5sum, name and definition of Msg.
+ */
+template<typename Xpp, typename Msg>
+struct XppMessageTraits {
+  struct MD5Sum {
+    static const char* value()           { return message_traits::MD5Sum<Msg>::value(); };
+    static const char* value(const Xpp&) { return value(); };
+  };
+  struct DataType {
+    static const char* value()           { return message_traits::DataType<Msg>::value(); };
+    static const char* value(const Xpp&) { return value(); };
+  };
+  struct Definition {
+    static const char* value()           { return message_traits::Definition<Msg>::value(); };
+    static const char* value(const Xpp&) { return value(); };
+  };
+};
+
+using XppCartTraits = XppMessageTraits<xpp::RobotStateCartesian,
+                                       xpp_msgs::RobotStateCartesian>;
+using XppJointTraits = XppMessageTraits<xpp::RobotStateJoint,
+                                        xpp_msgs::RobotStateJoint>;
+using XppTrajTraits = XppMessageTraits<xpp::RobotStateCartesianTrajectory,
+                                       xpp_msgs::RobotStateCartesianTrajectory>;
+
+template<> struct MD5Sum<xpp::RobotStateCartesian>     : XppCartTraits::MD5Sum {};
+template<> struct DataType<xpp::RobotStateCartesian>   : XppCartTraits::DataType {};
+template<> struct Definition<xpp::RobotStateCartesian> : XppCartTraits::Definition {};
+
+template<> struct MD5Sum<xpp::RobotStateJoint>     : XppJointTraits::MD5Sum {};
+template<> struct DataType<xpp::RobotStateJoint>   : XppJointTraits::DataType {};
+template<> struct Definition<xpp::RobotStateJoint> : XppJointTraits::Definition {};
+
+template<> struct MD5Sum<xpp::RobotStateCartesianTrajectory>     : XppTrajTraits::MD5Sum {};
+template<> struct DataType<xpp::RobotStateCartesianTrajectory>   : XppTrajTraits::DataType {};
+template<> struct Definition<xpp::RobotStateCartesianTrajectory> : XppTrajTraits::Definition {};
+
+} // namespace message_traits
+
+
+namespace serialization {
+
+/**
+ * @brief Same layout as xpp_msgs::StateLin3d.
+ */
+template<>
+struct Serializer<xpp::StateLin3d> {
+  template<typename Stream, typename T>
+  inline static void allInOne(Stream& stream, T& m)
+  {
+    for (int i=0; i<3; ++i) stream.next(m.p_(i));
+    for (int i=0; i<3; ++i) stream.next(m.v_(i));
+    for (int i=0; i<3; ++i) stream.next(m.a_(i));
+  }
+
+  template<typename Stream>
+  inline static void write(Stream& stream, const xpp::StateLin3d& m) { allInOne(stream, m); };
+
+  template<typename Stream>
+  inline static void read(Stream& stream, xpp::StateLin3d& m) { allInOne(stream, m); };
+
+  inline static uint32_t serializedLength(const xpp::StateLin3d&) { return 9*sizeof(double); };
+};
+
+/**
+ * @brief Same layout as xpp_msgs::State6d (pose, twist, accel).
+ */
+template<>
+struct Serializer<xpp::State3d> {
+  template<typename Stream, typename T>
+  inline static void allInOne(Stream& stream, T& m)
+  {
+    for (int i=0; i<3; ++i) stream.next(m.lin.p_(i));
+    stream.next(m.ang.q.x());
+    stream.next(m.ang.q.y());
+    stream.next(m.ang.q.z());
+    stream.next(m.ang.q.w());
+    for (int i=0; i<3; ++i) stream.next(m.lin.v_(i));
+    for (int i=0; i<3; ++i) stream.next(m.ang.w(i));
+    for (int i=0; i<3; ++i) stream.next(m.lin.a_(i));
+    for (int i=0; i<3; ++i) stream.next(m.ang.wd(i));
+  }
+
+  template<typename Stream>
+  inline static void write(Stream& stream, const xpp::State3d& m) { allInOne(stream, m); };
+
+  template<typename Stream>
+  inline static void read(Stream& stream, xpp::State3d& m) { allInOne(stream, m); };
+
+  inline static uint32_t serializedLength(const xpp::State3d&) { return 19*sizeof(double); };
+};
+
+/**
+ * @brief Same layout as xpp_msgs::RobotStateCartesian.
+ */
+template<>
+struct Serializer<xpp::RobotStateCartesian> {
+  template<typename Stream>
+  inline static void write(Stream& stream, const xpp::RobotStateCartesian& m)
+  {
+    stream.next(ros::Duration(m.t_global_));
+    stream.next(m.base_);
+
+    stream.next(uint32_t(m.ee_motion_.GetEECount()));
+    for (auto ee : m.ee_motion_.GetEEsOrdered())
+      stream.next(m.ee_motion_.at(ee));
+
+    stream.next(uint32_t(m.ee_forces_.GetEECount()));
+    for (auto ee : m.ee_forces_.GetEEsOrdered())
+      for (int i=0; i<3; ++i)
+        stream.next(m.ee_forces_.at(ee)(i));
+
+    stream.next(uint32_t(m.ee_contact_.GetEECount()));
+    for (auto ee : m.ee_contact_.GetEEsOrdered())
+      stream.next(static_cast<uint8_t>(m.ee_contact_.at(ee)));
+  }
+
+  template<typename Stream>
+  inline static void read(Stream& stream, xpp::RobotStateCartesian& m)
+  {
+    ros::Duration t;
+    stream.next(t);
+    m.t_global_ = t.toSec();
+    stream.next(m.base_);
+
+    uint32_t n;
+    stream.next(n);
+    m.ee_motion_.SetCount(n);
+    for (auto ee : m.ee_motion_.GetEEsOrdered())
+      stream.next(m.ee_motion_.at(ee));
+
+    stream.next(n);
+    m.ee_forces_.SetCount(n);
+    for (auto ee : m.ee_forces_.GetEEsOrdered())
+      for (int i=0; i<3; ++i)
+        stream.next(m.ee_forces_.at(ee)(i));
+
+    stream.next(n);
+    m.ee_contact_.SetCount(n);
+    for (auto ee : m.ee_contact_.GetEEsOrdered()) {
+      uint8_t c;
+      stream.next(c);
+      m.ee_contact_.at(ee) = c;
+    }
+  }
+
+  inline static uint32_t serializedLength(const xpp::RobotStateCartesian& m)
+  {
+    return 8                                              // time_from_start
+        + 19*sizeof(double)                               // base
+        + 4 + m.ee_motion_.GetEECount()*9*sizeof(double)  // ee_motion
+        + 4 + m.ee_forces_.GetEECount()*3*sizeof(double)  // ee_forces
+        + 4 + m.ee_contact_.GetEECount();                 // ee_contact
+  }
+};
+
+/**
+ * @brief Same layout as xpp_msgs::RobotStateJoint.
+ *
+ * The joint positions, velocities and torques are written to the position,
+ * velocity and effort fields of the joint state, whose header and joint
+ * names are left empty. Joint accelerations are not part of the message.
+ */
+template<>
+struct Serializer<xpp::RobotStateJoint> {
+  template<typename Stream>
+  inline static void write(Stream& stream, const xpp::RobotStateJoint& m)
+  {
+    stream.next(ros::Duration(m.t_global_));
+    stream.next(m.base_);
+
+    stream.next(uint32_t(0));       // header.seq
+    stream.next(ros::Time());       // header.stamp
+    stream.next(std::string());     // header.frame_id
+    stream.next(uint32_t(0));       // name
+    WriteJoints(stream, m.q_);
+    WriteJoints(stream, m.qd_);
+    WriteJoints(stream, m.torques_);
+
+    stream.next(uint32_t(m.ee_contact_.GetEECount()));
+    for (auto ee : m.ee_contact_.GetEEsOrdered())
+      stream.next(static_cast<uint8_t>(m.ee_contact_.at(ee)));
+  }
+
+  template<typename Stream>
+  inline static void read(Stream& stream, xpp::RobotStateJoint& m)
+  {
+    ros::Duration t;
+    stream.next(t);
+    m.t_global_ = t.toSec();
+    stream.next(m.base_);
+
+    std_msgs::Header header;
+    std::vector<std::string> names;
+    stream.next(header);
+    stream.next(names);
+
+    Eigen::VectorXd q, qd, tau;
+    ReadVector(stream, q);
+    ReadVector(stream, qd);
+    ReadVector(stream, tau);
+
+    uint32_t n_ee;
+    stream.next(n_ee);
+    m.ee_contact_.SetCount(n_ee);
+    for (auto ee : m.ee_contact_.GetEEsOrdered()) {
+      uint8_t c;
+      stream.next(c);
+      m.ee_contact_.at(ee) = c;
+    }
+
+    int n_joints_per_ee = n_ee==0? 0 : q.size()/n_ee;
+    if (n_ee*n_joints_per_ee != q.size())
+      throw std::runtime_error("RobotStateJoint: joints not evenly divisible among endeffectors");
+
+    m.q_ = m.qd_ = m.qdd_ = m.torques_ = xpp::Joints(n_ee, n_joints_per_ee);
+    m.q_.SetFromVec(q);
+    if (qd.size() == q.size())
+      m.qd_.SetFromVec(qd);
+    if (tau.size() == q.size())
+      m.torques_.SetFromVec(tau);
+  }
+
+  inline static uint32_t serializedLength(const xpp::RobotStateJoint& m)
+  {
+    return 8                                              // time_from_start
+        + 19*sizeof(double)                               // base
+        + 4 + 8 + 4                                       // joint_state.header
+        + 4                                               // joint_state.name
+        + 4 + m.q_.GetNumJoints()*sizeof(double)          // joint_state.position
+        + 4 + m.qd_.GetNumJoints()*sizeof(double)         // joint_state.velocity
+        + 4 + m.torques_.GetNumJoints()*sizeof(double)    // joint_state.effort
+        + 4 + m.ee_contact_.GetEECount();                 // ee_contact
+  }
+
+private:
+  template<typename Stream>
+  inline static void WriteJoints(Stream& stream, const xpp::Joints& joints)
+  {
+    const Eigen::VectorXd& q = joints.ToVec();
+    stream.next(uint32_t(q.size()));
+    for (int i=0; i<q.size(); ++i)
+      stream.next(q(i));
+  }
+
+  template<typename Stream>
+  inline static void ReadVector(Stream& stream, Eigen::VectorXd& q)
+  {
+    uint32_t n;
+    stream.next(n);
+    q.resize(n);
+    for (int i=0; i<q.size(); ++i)
+      stream.next(q(i));
+  }
+};
+
+/**
+ * @brief Same layout as xpp_msgs::RobotStateCartesianTrajectory.
+ *
+ * The header of the message is sent empty.
+ */
+template<>
+struct Serializer<xpp::RobotStateCartesianTrajectory> {
+  template<typename Stream>
+  inline static void write(Stream& stream, const xpp::RobotStateCartesianTrajectory& m)
+  {
+    stream.next(uint32_t(0));   // header.seq
+    stream.next(ros::Time());   // header.stamp
+    stream.next(std::string()); // header.frame_id
+
+    stream.next(uint32_t(m.points.size()));
+    for (const auto& state : m.points)
+      stream.next(state);
+  }
+
+  template<typename Stream>
+  inline static void read(Stream& stream, xpp::RobotStateCartesianTrajectory& m)
+  {
+    std_msgs::Header header;
+    stream.next(header);
+
+    uint32_t n;
+    stream.next(n);
+    m.points.resize(n, xpp::RobotStateCartesian(0));
+    for (auto& state : m.points)
+      stream.next(state);
+  }
+
+  inline static uint32_t serializedLength(const xpp::RobotStateCartesianTrajectory& m)
+  {
+    uint32_t size = 4 + 8 + 4 + 4;
+    for (const auto& state : m.points)
+      size += Serializer<xpp::RobotStateCartesian>::serializedLength(state);
+    return size;
+  }
+};
+
+} // namespace serialization
+} // namespace ros
+
+#endif /* XPP_STATES_SERIALIZATION_H_ */
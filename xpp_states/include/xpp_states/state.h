@@ -37,9 +37,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace xpp {
 
-class StateLin1d;
-class StateLin2d;
-class StateLin3d;
+template<int N> class StateLin;
 class StateAng3d;
 class State3d;
 class State3dEuler;
@@ -81,6 +79,12 @@ public:
    * @brief Constructs object with position p, zeroing velocity and acc.
    */
   StateLinXd(const VectorXd& p);
+
+  /**
+   * @brief Constructs a dynamically sized copy of a fixed-size state.
+   */
+  template<int N>
+  StateLinXd(const StateLin<N>& state);
   virtual ~StateLinXd() = default;
 
   /**
@@ -111,32 +115,67 @@ public:
 };
 
 
-// some state classes of explicit dimensions for type safety as well as
-// conversions from the general base class.
-class StateLin1d  : public StateLinXd {
+/**
+ * @brief Represents position, velocity and acceleration in N dimensions.
+ *
+ * In contrast to %StateLinXd the dimension is fixed at compile time, so
+ * the state lives entirely on the stack (no heap allocations) and has no
+ * virtual functions. Copying it is a plain copy of 3*N doubles, which makes
+ * it cheap to store large numbers of these in trajectories.
+ */
+template<int N>
+class StateLin {
 public:
-  StateLin1d() : StateLinXd(1) {};
-  virtual ~StateLin1d() {};
-};
+  using Vector = Eigen::Matrix<double,N,1>;
+  static constexpr int kNumDim = N; ///< the number of dimensions this state represents.
 
-class StateLin2d  : public StateLinXd {
-public:
-  StateLin2d() : StateLinXd(2) {};
-  virtual ~StateLin2d() {};
-};
+  Vector p_, v_, a_; ///< position, velocity and acceleration
 
-class StateLin3d : public StateLinXd {
-public:
-  StateLin3d() : StateLinXd(3) {};
-  StateLin3d(const StateLinXd&);
-  virtual ~StateLin3d() {};
+  /**
+   * @brief Constructs a zero initialized state.
+   */
+  StateLin();
+
+  /**
+   * @brief Constructs object with specific position, velocity and acceleration.
+   */
+  explicit StateLin(const Vector& p, const Vector& v, const Vector& a);
 
   /**
-   * @brief Extracts only the 2-dimensional part (x,y) from this 3-D state.
+   * @brief Constructs object from the dynamically sized state of equal dimension.
    */
-  StateLin2d Get2D() const;
+  StateLin(const StateLinXd& state_xd);
+
+  /**
+   * @brief  Read either position, velocity of acceleration by index.
+   * @param  deriv  Index for that specific derivative (pos=0, vel=1, acc=2).
+   * @return  Read only N-dimensional position, velocity or acceleration.
+   */
+  const Vector& GetByIndex(MotionDerivative deriv) const;
+
+  /**
+   * @brief  Read and write either position, velocity of acceleration by index.
+   * @param  deriv  Index for that specific derivative (pos=0, vel=1, acc=2).
+   * @return  Read/write N-dimensional position, velocity or acceleration.
+   */
+  Vector& GetByIndex(MotionDerivative deriv);
+
+  /**
+   * @brief Extracts only the 2-dimensional part (x,y) from this state.
+   */
+  StateLin<kDim2d> Get2D() const;
+
+  bool operator==(const StateLin& other) const;
+  bool operator!=(const StateLin& other) const;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW_IF_VECTORIZABLE_FIXED_SIZE(double, N)
 };
 
+// some state classes of explicit dimensions for type safety.
+using StateLin1d = StateLin<1>;
+using StateLin2d = StateLin<kDim2d>;
+using StateLin3d = StateLin<kDim3d>;
+
 
 /**
  * @brief Angular state of an object in 3-dimensional space.
@@ -257,6 +296,27 @@ inline StateLinXd operator*(double mult, const StateLinXd& rhs)
   return ret;
 }
 
+template<int N>
+std::ostream& operator<<(std::ostream& out, const StateLin<N>& pos)
+{
+  out << "p=" << pos.p_.transpose() << "  "
+      << "v=" << pos.v_.transpose() << "  "
+      << "a=" << pos.a_.transpose();
+  return out;
+}
+
+template<int N>
+StateLin<N> operator+(const StateLin<N>& lhs, const StateLin<N>& rhs)
+{
+  return StateLin<N>(lhs.p_ + rhs.p_, lhs.v_ + rhs.v_, lhs.a_ + rhs.a_);
+}
+
+template<int N>
+StateLin<N> operator*(double mult, const StateLin<N>& rhs)
+{
+  return StateLin<N>(mult * rhs.p_, mult * rhs.v_, mult * rhs.a_);
+}
+
 inline bool StateLinXd::operator==(const StateLinXd &other) const
 {
   bool all_equal = (p_==other.p_
@@ -270,6 +330,90 @@ inline bool StateLinXd::operator!=(const StateLinXd &other) const
   return !(*this == other);
 }
 
+template<int N>
+StateLinXd::StateLinXd (const StateLin<N>& state)
+    :StateLinXd(state.p_, state.v_, state.a_)
+{
+}
+
+
+// implementations of fixed-size linear state
+template<int N>
+constexpr int StateLin<N>::kNumDim;
+
+template<int N>
+StateLin<N>::StateLin ()
+    :p_(Vector::Zero()), v_(Vector::Zero()), a_(Vector::Zero())
+{
+}
+
+template<int N>
+StateLin<N>::StateLin (const Vector& p, const Vector& v, const Vector& a)
+    :p_(p), v_(v), a_(a)
+{
+}
+
+template<int N>
+StateLin<N>::StateLin (const StateLinXd& state_xd)
+{
+  assert(state_xd.kNumDim == N);
+
+  p_ = state_xd.p_;
+  v_ = state_xd.v_;
+  a_ = state_xd.a_;
+}
+
+template<int N>
+const typename StateLin<N>::Vector&
+StateLin<N>::GetByIndex (MotionDerivative deriv) const
+{
+  switch (deriv) {
+    case kPos:  return p_;
+    case kVel:  return v_;
+    case kAcc:  return a_;
+    default: assert(false); // derivative not part of state
+  }
+  return p_;
+}
+
+template<int N>
+typename StateLin<N>::Vector&
+StateLin<N>::GetByIndex (MotionDerivative deriv)
+{
+  switch (deriv) {
+    case kPos:  return p_;
+    case kVel:  return v_;
+    case kAcc:  return a_;
+    default: assert(false); // derivative not part of state
+  }
+  return p_;
+}
+
+template<int N>
+StateLin<kDim2d>
+StateLin<N>::Get2D () const
+{
+  static_assert(N >= kDim2d, "state must have at least an x and y component");
+
+  return StateLin<kDim2d>(p_.template topRows<kDim2d>(),
+                          v_.template topRows<kDim2d>(),
+                          a_.template topRows<kDim2d>());
+}
+
+template<int N>
+bool
+StateLin<N>::operator== (const StateLin& other) const
+{
+  return p_==other.p_ && v_==other.v_ && a_==other.a_;
+}
+
+template<int N>
+bool
+StateLin<N>::operator!= (const StateLin& other) const
+{
+  return !(*this == other);
+}
+
 inline std::ostream& operator<<(std::ostream& out, const StateAng3d& ori)
 {
   Vector3d rpy_rad;
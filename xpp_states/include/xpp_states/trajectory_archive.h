@@ -0,0 +1,185 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef _XPP_STATES_TRAJECTORY_ARCHIVE_H_
+#define _XPP_STATES_TRAJECTORY_ARCHIVE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <xpp_states/robot_state_cartesian.h>
+
+namespace xpp {
+
+/**
+ * @brief Compact binary file format to archive Cartesian trajectories.
+ *
+ * The states are grouped into chunks. The first state of each chunk is a
+ * keyframe, stored with full precision. All following states only store
+ * the change to the previous state:
+ *  - time, positions, velocities, accelerations and forces as fixed-point
+ *    deltas (varint encoded, so small changes take a single byte),
+ *  - the base orientation in 6 bytes through the smallest-three encoding,
+ *  - the contact flags as a bitmask, one bit per endeffector.
+ * An index of all chunks at the end of the file allows to decode any
+ * chunk on its own. The values are written in the byte order of the host.
+ *
+ * Layout: header | chunk 0 | chunk 1 | ... | chunk index
+ */
+struct TrajectoryArchive {
+  /**
+   * @brief Step of the fixed-point encoding, i.e. twice the maximum error.
+   */
+  struct Resolution {
+    double time  = 1e-6; ///< [s]
+    double pos   = 1e-5; ///< [m]
+    double vel   = 1e-4; ///< [m/s], [rad/s]
+    double acc   = 1e-3; ///< [m/s^2], [rad/s^2]
+    double force = 1e-2; ///< [N]
+  };
+
+  /**
+   * @brief Where to find each chunk in the file.
+   */
+  struct ChunkInfo {
+    uint64_t offset;   ///< first byte of the chunk in the file.
+    uint32_t n_states; ///< number of states in the chunk.
+    double t_start;    ///< time of the keyframe [s].
+  };
+
+  static constexpr char kMagic[5] = "XPPA";
+  static constexpr uint32_t kFormatVersion = 1;
+  static constexpr int kHeaderSize = 72; ///< [bytes]
+};
+
+/**
+ * @brief Writes states to a trajectory archive file.
+ *
+ * The file is only complete after Close() (or destruction).
+ */
+class TrajectoryArchiveWriter {
+public:
+  using Resolution = TrajectoryArchive::Resolution;
+
+  /**
+   * @param  path        The file to create.
+   * @param  n_ee        The number of endeffectors of every state.
+   * @param  chunk_size  The number of states between two keyframes.
+   * @param  resolution  The precision of all but the keyframes.
+   */
+  TrajectoryArchiveWriter(const std::string& path, int n_ee,
+                          int chunk_size, const Resolution& resolution);
+  TrajectoryArchiveWriter(const std::string& path, int n_ee,
+                          int chunk_size = 100);
+  ~TrajectoryArchiveWriter();
+
+  /**
+   * @brief Appends the state to the archive.
+   */
+  void Write(const RobotStateCartesian& state);
+
+  /**
+   * @brief Writes the chunk index and closes the file.
+   */
+  void Close();
+
+private:
+  std::ofstream file_;
+  int n_ee_;
+  int chunk_size_;
+  Resolution resolution_;
+
+  std::vector<uint8_t> chunk_;  ///< the encoded states of the current chunk.
+  int n_chunk_states_;
+  double t_chunk_start_;
+  uint64_t n_states_;
+  std::vector<double> steps_;   ///< fixed-point step of each value.
+  std::vector<double> values_;  ///< values of the state being written.
+  std::vector<int64_t> prev_;   ///< quantized values of the previous state.
+  std::vector<TrajectoryArchive::ChunkInfo> index_;
+
+  void FlushChunk();
+};
+
+/**
+ * @brief Reads states from a trajectory archive file.
+ *
+ * Only the header and chunk index are read on construction, the chunks
+ * are read from the file when requested.
+ */
+class TrajectoryArchiveReader {
+public:
+  using States = std::vector<RobotStateCartesian>;
+  using Resolution = TrajectoryArchive::Resolution;
+
+  explicit TrajectoryArchiveReader(const std::string& path);
+  ~TrajectoryArchiveReader() = default;
+
+  /**
+   * @brief Decodes all states of one chunk and appends them to states.
+   */
+  void ReadChunk(int chunk, States& states);
+
+  /**
+   * @brief Decodes the complete trajectory.
+   */
+  States ReadAll();
+
+  /**
+   * @brief Decodes the state with index k, only reading its chunk.
+   */
+  RobotStateCartesian ReadState(int k);
+
+  /**
+   * @returns the chunk containing time t (the first/last for outside times).
+   */
+  int FindChunk(double t) const;
+
+  int GetStateCount() const { return n_states_; };
+  int GetChunkCount() const { return index_.size(); };
+  int GetEECount() const { return n_ee_; };
+  const Resolution& GetResolution() const { return resolution_; };
+
+private:
+  std::ifstream file_;
+  int n_ee_;
+  int chunk_size_;
+  int n_states_;
+  Resolution resolution_;
+  uint64_t index_offset_;
+  std::vector<TrajectoryArchive::ChunkInfo> index_;
+  std::vector<double> steps_;
+  std::vector<uint8_t> buffer_; ///< reused to read the chunks.
+};
+
+} /* namespace xpp */
+
+#endif /* _XPP_STATES_TRAJECTORY_ARCHIVE_H_ */
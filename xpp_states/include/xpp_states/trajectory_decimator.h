@@ -0,0 +1,113 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef _XPP_STATES_TRAJECTORY_DECIMATOR_H_
+#define _XPP_STATES_TRAJECTORY_DECIMATOR_H_
+
+#include <vector>
+
+#include <xpp_states/robot_state_cartesian.h>
+
+namespace xpp {
+
+/**
+ * @brief Removes states that can be recovered from the kept ones.
+ *
+ * How the removed states are recovered depends on the playback:
+ *
+ * kInterpolate: Works in the spirit of the Ramer-Douglas-Peucker algorithm.
+ * Between two kept states, the base position, endeffector positions and
+ * forces are interpolated linearly in time and the base orientation is
+ * slerped (as TrajectoryInterpolator does). The state that deviates most
+ * from this interpolation is kept and both halves are refined further,
+ * until every removed state is within the tolerances.
+ *
+ * kHold: The last kept state is shown until the next one arrives, as e.g.
+ * rviz_marker_node and the URDF visualizers do when replaying a bag. A state
+ * is kept as soon as it deviates from the last kept state by more than the
+ * tolerances, so no removed state differs more from what is shown.
+ *
+ * The first and last state and the states on both sides of every contact
+ * change are always kept.
+ */
+class TrajectoryDecimator {
+public:
+  using States = std::vector<RobotStateCartesian>;
+
+  /**
+   * @brief How the removed states are recovered from the kept ones.
+   */
+  enum Playback { kInterpolate, kHold };
+
+  /**
+   * @brief Maximum deviation of a removed state from its recovered value.
+   */
+  struct Tolerances {
+    double base_pos   = 0.005; ///< [m]
+    double base_angle = 0.01;  ///< [rad]
+    double ee_pos     = 0.005; ///< [m]
+    double ee_force   = 5.0;   ///< [N]
+  };
+
+  TrajectoryDecimator();
+  explicit TrajectoryDecimator(const Tolerances& tol,
+                               Playback playback = kInterpolate);
+  ~TrajectoryDecimator() = default;
+
+  /**
+   * @brief The indices of the states to keep, in increasing order.
+   * @param states  States ordered by time.
+   */
+  std::vector<int> GetKeptIndices(const States& states) const;
+
+  /**
+   * @brief The states that remain after decimation.
+   */
+  States Decimate(const States& states) const;
+
+private:
+  Tolerances tol_;
+  Playback playback_;
+
+  /**
+   * @brief Deviation of state k from interpolating i and j, relative to
+   * the tolerances (> 1 means it can't be removed).
+   */
+  double GetRelativeError(const States& states, int i, int j, int k) const;
+
+  /**
+   * @brief Marks the states between i and j that must be kept.
+   */
+  void Simplify(const States& states, int i, int j, std::vector<bool>& keep) const;
+  void SimplifyHold(const States& states, int i, int j, std::vector<bool>& keep) const;
+};
+
+} /* namespace xpp */
+
+#endif /* _XPP_STATES_TRAJECTORY_DECIMATOR_H_ */
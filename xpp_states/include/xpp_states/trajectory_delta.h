@@ -0,0 +1,144 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef _XPP_STATES_TRAJECTORY_DELTA_H_
+#define _XPP_STATES_TRAJECTORY_DELTA_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <xpp_states/robot_state_cartesian.h>
+
+namespace xpp {
+
+/**
+ * @brief The part of a re-planned trajectory that differs from the last plan.
+ *
+ * When re-planning in a receding horizon fashion, most of the new trajectory
+ * usually matches the previous one. Instead of sending the complete
+ * trajectory, only the points in the time window [t_start_, t_end_] are sent.
+ * They replace all points of the previous trajectory in this window.
+ *
+ * A delta with base_version_ = kFullVersion replaces the whole trajectory,
+ * e.g. to initialize a receiver. This value is reserved as marker, so
+ * trajectory versions start at 1.
+ *
+ * see also TrajectoryBuffer, Convert::ToRos(const TrajectoryDelta&, ...).
+ */
+class TrajectoryDelta {
+public:
+  using Version = uint32_t;
+  using States  = std::vector<RobotStateCartesian>;
+
+  static constexpr Version kFullVersion = 0;
+
+  /**
+   * @brief Builds the delta that turns prev into curr.
+   * @param prev  The trajectory the receiver already has.
+   * @param curr  The new trajectory.
+   * @param prev_version  The version of prev.
+   * @param tol  Max difference of two states at the same time to be equal.
+   * @throws std::invalid_argument if prev_version is kFullVersion.
+   *
+   * The window extends from the first to the last point of curr that does
+   * not match the point of prev at the same time. If curr ends before prev,
+   * the window extends to the end of prev, so the remaining points get
+   * removed. An empty curr removes all points of prev.
+   */
+  static TrajectoryDelta Between(const States& prev, const States& curr,
+                                 Version prev_version, double tol = 1e-9);
+
+  /**
+   * @brief Builds a delta that replaces the whole trajectory with curr.
+   * @throws std::invalid_argument if version is kFullVersion.
+   */
+  static TrajectoryDelta Full(const States& curr, Version version);
+
+  /**
+   * @brief True if this delta replaces the whole trajectory.
+   */
+  bool IsFull() const { return base_version_ == kFullVersion; };
+
+  /**
+   * @brief True if nothing has to be replaced.
+   */
+  bool IsEmpty() const { return points_.empty() && t_end_ < t_start_; };
+
+  /**
+   * @brief True if the two states are equal up to tol.
+   */
+  static bool IsSame(const RobotStateCartesian& a,
+                     const RobotStateCartesian& b, double tol);
+
+  Version base_version_ = kFullVersion; ///< version the delta is applied to.
+  Version version_      = kFullVersion; ///< version after applying the delta.
+  double t_start_ = 0.0;                ///< first replaced time [s].
+  double t_end_   = -1.0;               ///< last replaced time [s].
+  States points_;                       ///< points in [t_start_, t_end_].
+};
+
+/**
+ * @brief Receiver side trajectory that is kept up to date through deltas.
+ */
+class TrajectoryBuffer {
+public:
+  using States  = TrajectoryDelta::States;
+  using Version = TrajectoryDelta::Version;
+
+  TrajectoryBuffer() = default;
+  ~TrajectoryBuffer() = default;
+
+  /**
+   * @brief Splices the delta into the stored trajectory.
+   * @returns false if the delta is based on a different version or leads
+   * to the reserved version kFullVersion, in which case the buffer is left
+   * unchanged and a full trajectory is needed.
+   *
+   * The stored points are only moved if the number of points in the window
+   * changes, otherwise they are overwritten in place.
+   */
+  bool Apply(const TrajectoryDelta& delta);
+
+  /**
+   * @brief Replaces the stored trajectory.
+   * @throws std::invalid_argument if version is kFullVersion.
+   */
+  void Set(const States& points, Version version);
+
+  const States& GetPoints() const { return points_; };
+  Version GetVersion() const { return version_; };
+
+private:
+  States points_;
+  Version version_ = TrajectoryDelta::kFullVersion;
+};
+
+} /* namespace xpp */
+
+#endif /* _XPP_STATES_TRAJECTORY_DELTA_H_ */
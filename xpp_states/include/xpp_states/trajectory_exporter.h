@@ -0,0 +1,116 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef _XPP_STATES_TRAJECTORY_EXPORTER_H_
+#define _XPP_STATES_TRAJECTORY_EXPORTER_H_
+
+#include <deque>
+#include <future>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <xpp_states/robot_state_cartesian.h>
+
+namespace xpp {
+
+/**
+ * @brief Streams states into a flat table with one column per channel.
+ *
+ * The columns are t, the base (base_x, base_vx, base_ax, base_qw, base_wx,
+ * base_wdx, ...) and for every endeffector i its motion, force and contact
+ * flag (eei_x, eei_vx, eei_ax, eei_fx, ..., eei_contact), see GetColumnNames().
+ *
+ * The states are collected into chunks, which are encoded on background
+ * threads while the next chunk is filled. At most one chunk per thread is
+ * pending, so the memory stays constant independent of the number of
+ * states. The chunks are written in the order of the states.
+ *
+ * Formats:
+ *  - CSV:    a header line with the column names, then one line per state.
+ *            The values are printed with enough digits to be read back exactly.
+ *  - Binary: "XPPC", uint32 version, uint32 number of columns, the column
+ *            names each terminated by '\n', followed by chunks of
+ *            uint32 number of rows and the doubles of each column.
+ *            The values are written in the byte order of the host.
+ */
+class TrajectoryExporter {
+public:
+  enum Format { CSV, Binary };
+
+  /**
+   * @param  out         The stream to write to, must outlive the exporter.
+   * @param  n_ee        The number of endeffectors of every state.
+   * @param  format      CSV or binary columnar.
+   * @param  chunk_size  The number of states encoded together.
+   * @param  n_threads   The number of chunks encoded in parallel.
+   */
+  TrajectoryExporter(std::ostream& out, int n_ee, Format format,
+                     int chunk_size = 4096, int n_threads = 4);
+
+  /**
+   * @brief Closes the exporter if not done yet. Errors are only printed,
+   * call Close() to handle them.
+   */
+  ~TrajectoryExporter();
+
+  /**
+   * @brief Appends the state to the table.
+   */
+  void Write(const RobotStateCartesian& state);
+
+  /**
+   * @brief Encodes and writes all remaining states.
+   */
+  void Close();
+
+  int GetEECount() const { return n_ee_; };
+  int GetColumnCount() const { return n_columns_; };
+  static std::vector<std::string> GetColumnNames(int n_ee);
+
+private:
+  std::ostream& out_;
+  int n_ee_;
+  int n_columns_;
+  Format format_;
+  int chunk_size_;
+  int n_threads_;
+  bool closed_;
+
+  std::vector<double> rows_; ///< the values of the current chunk, by state.
+  std::deque<std::future<std::string>> pending_;
+
+  void WriteHeader();
+  void SubmitChunk();
+  void WriteOldestChunk();
+};
+
+} /* namespace xpp */
+
+#endif /* _XPP_STATES_TRAJECTORY_EXPORTER_H_ */
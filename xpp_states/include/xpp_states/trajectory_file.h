@@ -0,0 +1,175 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef _XPP_STATES_TRAJECTORY_FILE_H_
+#define _XPP_STATES_TRAJECTORY_FILE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <xpp_states/robot_state_cartesian.h>
+
+namespace xpp {
+
+/**
+ * @brief Uncompressed file format for O(1) access to long trajectories.
+ *
+ * The states are stored in blocks of fixed size. Inside each block every
+ * quantity is stored as a column (time, base, endeffector motion, forces,
+ * contacts), so e.g. only the base can be read without touching the rest.
+ * Since all blocks have the same size, the location of state k follows
+ * directly from k. An index with the start time of each block at the end
+ * of the file allows to find the state for a time in O(log n), or O(1) if
+ * the trajectory is uniformly sampled.
+ *
+ * Layout: header | block 0 | block 1 | ... | block start times
+ *
+ * In contrast to the TrajectoryArchive, the file is meant to be memory
+ * mapped, so opening it takes the same time independent of its size.
+ * The values are written in the byte order of the host.
+ */
+struct TrajectoryFileFormat {
+  static constexpr char kMagic[5] = "XPPT";
+  static constexpr uint32_t kFormatVersion = 1;
+  static constexpr int kHeaderSize = 64;  ///< [bytes]
+
+  /// base p, v, a, q (x,y,z,w), w, wd
+  static constexpr int kBaseValues = 19;
+  /// ee p, v, a
+  static constexpr int kEEMotionValues = 9;
+};
+
+/**
+ * @brief Writes states to a memory mappable trajectory file.
+ *
+ * Only a single block is kept in memory, so arbitrarily long trajectories
+ * can be written. The file is only complete after Close() (or destruction).
+ */
+class TrajectoryFileWriter {
+public:
+  /**
+   * @param  path        The file to create.
+   * @param  n_ee        The number of endeffectors of every state.
+   * @param  block_size  The number of states per block.
+   */
+  TrajectoryFileWriter(const std::string& path, int n_ee, int block_size = 4096);
+  ~TrajectoryFileWriter();
+
+  /**
+   * @brief Appends the state, which must not be earlier than the previous.
+   */
+  void Write(const RobotStateCartesian& state);
+
+  /**
+   * @brief Writes the time index and closes the file.
+   */
+  void Close();
+
+private:
+  std::ofstream file_;
+  int n_ee_;
+  int block_size_;
+
+  uint64_t n_states_;
+  double t_start_;
+  double dt_;           ///< sample time while uniformly sampled, else zero.
+  double t_prev_;
+
+  // columns of the current block
+  int n_block_states_;
+  std::vector<double> time_, base_, ee_motion_, ee_forces_;
+  std::vector<uint32_t> contact_;
+  std::vector<double> block_t_start_;
+
+  void FlushBlock();
+};
+
+/**
+ * @brief Read-only access to a memory mapped trajectory file.
+ *
+ * Opening the file only validates the header, all states are read on
+ * demand by the operating system.
+ */
+class TrajectoryFile {
+public:
+  explicit TrajectoryFile(const std::string& path);
+  ~TrajectoryFile();
+
+  TrajectoryFile(const TrajectoryFile&) = delete;
+  TrajectoryFile& operator=(const TrajectoryFile&) = delete;
+
+  /**
+   * @returns the state k with t_k <= t < t_{k+1} (clamped to the first/last).
+   */
+  int FindState(double t) const;
+
+  /**
+   * @brief The complete state with index k.
+   */
+  RobotStateCartesian GetState(int k) const;
+
+  /**
+   * @brief The state that is valid at time t, see FindState().
+   */
+  RobotStateCartesian GetStateAt(double t) const { return GetState(FindState(t)); };
+
+  double GetTime(int k) const;
+  State3d GetBase(int k) const;
+  EndeffectorsContact GetContact(int k) const;
+
+  int GetStateCount() const { return n_states_; };
+  int GetEECount() const { return n_ee_; };
+  double GetStartTime() const { return GetTime(0); };
+  double GetEndTime() const { return GetTime(n_states_-1); };
+  bool IsUniformlySampled() const { return dt_ > 0.0; };
+
+private:
+  const uint8_t* data_;  ///< the memory mapped file.
+  size_t size_;          ///< [bytes]
+
+  int n_ee_;
+  int block_size_;
+  int n_states_;
+  double dt_;
+  size_t block_bytes_;
+  const double* block_t_start_;
+
+  /**
+   * @returns the column that starts column_offset bytes into the block of
+   *          state k, and sets i to the index of k inside this block.
+   */
+  template<typename T>
+  const T* GetColumn(int k, size_t column_offset, int& i) const;
+};
+
+} /* namespace xpp */
+
+#endif /* _XPP_STATES_TRAJECTORY_FILE_H_ */
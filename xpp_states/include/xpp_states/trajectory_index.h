@@ -0,0 +1,130 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef _XPP_STATES_TRAJECTORY_INDEX_H_
+#define _XPP_STATES_TRAJECTORY_INDEX_H_
+
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <xpp_states/robot_state_cartesian.h>
+
+namespace xpp {
+
+/**
+ * @brief Answers range queries over channels of a sampled trajectory.
+ *
+ * A channel is any scalar of the state, e.g. the vertical force of one foot
+ * or the number of feet in contact. For each channel a segment tree
+ * of the minimum, maximum and sum is built once in O(n), after which
+ *  - the min/max/sum/mean over a time interval is found in O(log n),
+ *  - the first time at which the channel is below/above a value is found
+ *    in O(log n).
+ *
+ * Time intervals [t0, t1] include all samples with t0 <= t_k <= t1.
+ */
+class TrajectoryIndex {
+public:
+  using States  = std::vector<RobotStateCartesian>;
+  using Channel = std::function<double(const RobotStateCartesian&)>;
+  using Window  = std::pair<double,double>; ///< first and last time [s].
+
+  /**
+   * @brief Evaluates all channels for every state and builds their trees.
+   * @param states    States ordered by time.
+   * @param channels  The channels to query by name.
+   * @throws std::invalid_argument if the states are not ordered by time.
+   */
+  TrajectoryIndex(const States& states,
+                  const std::map<std::string, Channel>& channels);
+  ~TrajectoryIndex() = default;
+
+  /**
+   * @returns the channels base_z, contacts and eei_fz for each endeffector i.
+   */
+  static std::map<std::string, Channel> GetDefaultChannels(int n_ee);
+
+  /**
+   * @returns the extremum/sum/mean over [t0,t1], +-infinity/0/NaN if no sample.
+   */
+  double Min(const std::string& channel, double t0, double t1) const;
+  double Max(const std::string& channel, double t0, double t1) const;
+  double Sum(const std::string& channel, double t0, double t1) const;
+  double Mean(const std::string& channel, double t0, double t1) const;
+
+  /**
+   * @returns the first sample time >= t0 with a value < (>) value,
+   *          infinity if there is none.
+   */
+  double FindFirstBelow(const std::string& channel, double t0, double value) const;
+  double FindFirstAbove(const std::string& channel, double t0, double value) const;
+
+  /**
+   * @returns the time windows in which the channel is below value.
+   */
+  std::vector<Window> FindWindowsBelow(const std::string& channel, double value) const;
+
+  // commonly used channels
+  static Channel BasePos(int dim);
+  static Channel EEPos(EndeffectorID ee, int dim);
+  static Channel EEForce(EndeffectorID ee, int dim);
+  static Channel ContactCount();
+
+private:
+  /**
+   * @brief Complete binary trees, the leaves start at index size_.
+   */
+  struct Tree {
+    std::vector<double> min, max, sum;
+  };
+
+  std::vector<double> times_;
+  int size_; ///< number of leaves, the smallest power of two >= n.
+  std::map<std::string, Tree> trees_;
+
+  const Tree& GetTree(const std::string& channel) const;
+
+  /**
+   * @brief The first and one past the last sample in [t0,t1].
+   */
+  std::pair<int,int> GetRange(double t0, double t1) const;
+
+  /**
+   * @returns the first sample >= begin below (not below) value, or -1.
+   */
+  int FindFirstBelow(const Tree& tree, int begin, double value) const;
+  int FindFirstNotBelow(const Tree& tree, int begin, double value) const;
+};
+
+} /* namespace xpp */
+
+#endif /* _XPP_STATES_TRAJECTORY_INDEX_H_ */
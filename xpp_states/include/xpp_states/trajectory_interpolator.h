@@ -0,0 +1,123 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef _XPP_STATES_TRAJECTORY_INTERPOLATOR_H_
+#define _XPP_STATES_TRAJECTORY_INTERPOLATOR_H_
+
+#include <vector>
+
+#include <xpp_states/cartesian_trajectory.h>
+#include <xpp_states/robot_state_cartesian.h>
+
+namespace xpp {
+
+/**
+ * @brief Evaluates a sampled Cartesian trajectory at arbitrary times.
+ *
+ * Between two samples the linear states (base and endeffectors) are
+ * interpolated by the quintic Hermite polynomial that matches the stored
+ * position, velocity and acceleration at both samples. The base orientation
+ * is slerped, angular rates and forces are interpolated linearly and the
+ * contact flags keep the value of the previous sample (step).
+ *
+ * Times outside the trajectory are clamped to the first/last sample.
+ * For uniformly sampled trajectories the samples are found in O(1),
+ * otherwise in O(log n). A %Cursor additionally remembers the last sample
+ * for queries with increasing time, e.g. during playback.
+ *
+ * To build it from a xpp_msgs::RobotStateCartesianTrajectory, first convert
+ * it through Convert::ToXpp(msg, CartesianTrajectory&).
+ */
+class TrajectoryInterpolator {
+public:
+  /**
+   * @brief Remembers the last queried sample for monotonic time queries.
+   */
+  class Cursor {
+  public:
+    explicit Cursor(const TrajectoryInterpolator& interpolator)
+        : interpolator_(interpolator), k_(0) {};
+
+    /**
+     * @brief The state at time t, searching forward from the previous query.
+     */
+    RobotStateCartesian At(double t);
+
+  private:
+    const TrajectoryInterpolator& interpolator_;
+    int k_;
+  };
+
+  /**
+   * @throws std::invalid_argument if there are no states.
+   */
+  explicit TrajectoryInterpolator(const std::vector<RobotStateCartesian>& states);
+  explicit TrajectoryInterpolator(const CartesianTrajectory& trajectory);
+  ~TrajectoryInterpolator() = default;
+
+  /**
+   * @brief The interpolated state at time t.
+   */
+  RobotStateCartesian At(double t) const;
+
+  /**
+   * @brief The interpolated states at each of the times.
+   *
+   * Increasing times are evaluated in a single pass over the trajectory.
+   */
+  std::vector<RobotStateCartesian> At(const std::vector<double>& times) const;
+
+  Cursor GetCursor() const { return Cursor(*this); };
+
+  double GetStartTime() const;
+  double GetEndTime() const;
+  bool IsUniformlySampled() const { return dt_ > 0.0; };
+
+private:
+  CartesianTrajectory traj_;
+  double dt_; ///< sample time if uniformly sampled, zero otherwise.
+
+  void CheckUniformSampling();
+
+  /**
+   * @returns the sample k with t_k <= t < t_{k+1} (k=0 for t < t_0).
+   */
+  int FindSample(double t) const;
+
+  /**
+   * @returns the sample for t, starting the search at k.
+   */
+  int FindSampleFrom(int k, double t) const;
+
+  RobotStateCartesian Interpolate(int k, double t) const;
+};
+
+} /* namespace xpp */
+
+#endif /* _XPP_STATES_TRAJECTORY_INTERPOLATOR_H_ */
@@ -0,0 +1,144 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef _XPP_STATES_TRAJECTORY_RING_BUFFER_H_
+#define _XPP_STATES_TRAJECTORY_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <xpp_states/robot_state_cartesian.h>
+
+namespace xpp {
+
+/**
+ * @brief Time-ordered ring of the latest merged receding horizon plan.
+ *
+ * Each new plan (e.g. from xpp_msgs::robot_trajectory_desired) overwrites
+ * all stored states from its first time onwards and appends the rest, while
+ * states older than the current time are evicted. All memory is allocated
+ * once at construction. If a plan does not fit, the oldest states are
+ * dropped.
+ *
+ * One writer thread may call Merge() and EvictBefore() while any number of
+ * reader threads call the const methods. Readers never block the writer:
+ * they copy the data and retry if a write happened meanwhile (seqlock),
+ * yielding to the writer before each retry.
+ * For this the states are stored as atomic values, so a reader racing with
+ * the writer only sees values it afterwards discards.
+ */
+class TrajectoryRingBuffer {
+public:
+  using States = std::vector<RobotStateCartesian>;
+
+  /**
+   * @param capacity  The maximum number of stored states.
+   */
+  explicit TrajectoryRingBuffer(int capacity);
+  ~TrajectoryRingBuffer() = default;
+
+  TrajectoryRingBuffer(const TrajectoryRingBuffer&) = delete;
+  TrajectoryRingBuffer& operator=(const TrajectoryRingBuffer&) = delete;
+
+  /**
+   * @brief Overwrites all states at or after the start of the plan with it.
+   * @param plan  States ordered by time (writer thread only). Of a plan
+   *              longer than the capacity only the start is stored.
+   * @throws std::invalid_argument if the endeffector counts of a state's
+   *         motion, forces and contacts differ, std::length_error if they
+   *         exceed kMaxEndeffectors. The buffer is then left unchanged.
+   */
+  void Merge(const States& plan);
+
+  /**
+   * @brief Removes all states before time t (writer thread only).
+   */
+  void EvictBefore(double t);
+
+  /**
+   * @brief Copies the state with t_k <= t < t_{k+1}.
+   * @returns false if the buffer is empty.
+   *
+   * Times before the first state return the first state.
+   */
+  bool GetState(double t, RobotStateCartesian& state) const;
+
+  /**
+   * @brief Copies all stored states into states, reusing its memory.
+   */
+  void GetStates(States& states) const;
+
+  /**
+   * @brief Increases with every modification, so readers can skip copies.
+   */
+  uint64_t GetVersion() const { return seq_.load(std::memory_order_acquire)/2; };
+
+  int GetCapacity() const { return capacity_; };
+  int size() const { return size_.load(std::memory_order_relaxed); };
+  bool empty() const { return size() == 0; };
+
+private:
+  /**
+   * @brief Values stored per state: time, endeffector and contact count,
+   * contact mask, base and for each endeffector the motion and force.
+   */
+  static constexpr int kSlotSize = 4 + 19 + kMaxEndeffectors*(9+3);
+
+  std::vector<std::atomic<double>> slots_; ///< kSlotSize values per state.
+  int capacity_;
+  std::atomic<int> head_;    ///< slot of the oldest state.
+  std::atomic<int> size_;    ///< number of stored states.
+  std::atomic<uint64_t> seq_; ///< odd while the writer modifies the buffer.
+
+  std::atomic<double>* Slot(int slot);
+  const std::atomic<double>* Slot(int slot) const;
+  double GetTime(int slot) const;
+  static void CheckState(const RobotStateCartesian& state);
+  void Store(int slot, const RobotStateCartesian& state);
+  void Load(int slot, RobotStateCartesian& state) const;
+
+  /**
+   * @returns the number of states with t_k < t, given head and size.
+   */
+  int CountBefore(int head, int size, double t) const;
+
+  void BeginWrite();
+  void EndWrite();
+
+  /**
+   * @brief Calls read(head, size) until it saw a consistent buffer.
+   */
+  template<typename Fn>
+  void Read(const Fn& read) const;
+};
+
+} /* namespace xpp */
+
+#endif /* _XPP_STATES_TRAJECTORY_RING_BUFFER_H_ */
@@ -0,0 +1,223 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_states/cartesian_trajectory.h>
+
+#include <stdexcept>
+
+namespace xpp {
+
+CartesianTrajectory::CartesianTrajectory (int n_ee)
+{
+  ee_pos_.resize(n_ee);
+  ee_vel_.resize(n_ee);
+  ee_acc_.resize(n_ee);
+  ee_forces_.resize(n_ee);
+
+  if (n_ee > EndeffectorsContact::kMaxCount)
+    throw std::length_error("xpp::CartesianTrajectory: too many endeffectors");
+}
+
+CartesianTrajectory::CartesianTrajectory (const std::vector<RobotStateCartesian>& states)
+    : CartesianTrajectory(states.empty()? 0 : states.front().ee_motion_.GetEECount())
+{
+  Reserve(states.size());
+  for (const auto& state : states)
+    PushBack(state);
+}
+
+template<typename Fn>
+void
+CartesianTrajectory::ForEachChannel (Fn fn)
+{
+  fn(t_global_);
+
+  for (auto* c3 : {&base_pos_, &base_vel_, &base_acc_, &base_w_, &base_wd_})
+    for (Channel& c : *c3)
+      fn(c);
+
+  for (Channel& c : base_ori_)
+    fn(c);
+
+  for (auto* ee_c3 : {&ee_pos_, &ee_vel_, &ee_acc_, &ee_forces_})
+    for (Channel3d& c3 : *ee_c3)
+      for (Channel& c : c3)
+        fn(c);
+}
+
+void
+CartesianTrajectory::Reserve (int n)
+{
+  ForEachChannel([n](Channel& c) { c.reserve(n); });
+  ee_contact_.reserve(n);
+}
+
+void
+CartesianTrajectory::Resize (int n)
+{
+  int n_prev = size();
+  ForEachChannel([n](Channel& c) { c.resize(n, 0.0); });
+  for (int k=n_prev; k<n; ++k)
+    base_ori_[QW][k] = 1.0; // identity orientation
+  ee_contact_.resize(n, EndeffectorsContact(GetEECount(), true).GetMask());
+}
+
+void
+CartesianTrajectory::PushBack (const RobotStateCartesian& state)
+{
+  CheckEECount(state); // before growing, so nothing changes if it throws
+  Resize(size()+1);
+  SetState(size()-1, state);
+}
+
+void
+CartesianTrajectory::SetState (int k, const RobotStateCartesian& state)
+{
+  CheckEECount(state);
+
+  t_global_.at(k) = state.t_global_;
+
+  for (int dim=0; dim<kDim3d; ++dim) {
+    base_pos_[dim][k] = state.base_.lin.p_[dim];
+    base_vel_[dim][k] = state.base_.lin.v_[dim];
+    base_acc_[dim][k] = state.base_.lin.a_[dim];
+    base_w_[dim][k]   = state.base_.ang.w[dim];
+    base_wd_[dim][k]  = state.base_.ang.wd[dim];
+  }
+
+  base_ori_[QW][k] = state.base_.ang.q.w();
+  base_ori_[QX][k] = state.base_.ang.q.x();
+  base_ori_[QY][k] = state.base_.ang.q.y();
+  base_ori_[QZ][k] = state.base_.ang.q.z();
+
+  for (auto ee : state.ee_motion_.GetEEsOrdered()) {
+    const StateLin3d& motion = state.ee_motion_.at(ee);
+    const Vector3d& force    = state.ee_forces_.at(ee);
+    for (int dim=0; dim<kDim3d; ++dim) {
+      ee_pos_[ee][dim][k]    = motion.p_[dim];
+      ee_vel_[ee][dim][k]    = motion.v_[dim];
+      ee_acc_[ee][dim][k]    = motion.a_[dim];
+      ee_forces_[ee][dim][k] = force[dim];
+    }
+  }
+
+  ee_contact_.at(k) = state.ee_contact_.GetMask();
+}
+
+void
+CartesianTrajectory::CheckEECount (const RobotStateCartesian& state) const
+{
+  if (state.ee_motion_.GetEECount() != GetEECount())
+    throw std::invalid_argument("xpp::CartesianTrajectory: state has a different number of endeffectors");
+}
+
+std::vector<RobotStateCartesian>
+CartesianTrajectory::ToStates () const
+{
+  std::vector<RobotStateCartesian> states;
+  states.reserve(size());
+  for (int k=0; k<size(); ++k)
+    states.push_back(at(k).ToState());
+
+  return states;
+}
+
+double
+CartesianTrajectory::StateRef::t_global () const
+{
+  return traj_.t_global_[k_];
+}
+
+State3d
+CartesianTrajectory::StateRef::base () const
+{
+  State3d base;
+  for (int dim=0; dim<kDim3d; ++dim) {
+    base.lin.p_[dim] = traj_.base_pos_[dim][k_];
+    base.lin.v_[dim] = traj_.base_vel_[dim][k_];
+    base.lin.a_[dim] = traj_.base_acc_[dim][k_];
+    base.ang.w[dim]  = traj_.base_w_[dim][k_];
+    base.ang.wd[dim] = traj_.base_wd_[dim][k_];
+  }
+
+  base.ang.q = Quaterniond(traj_.base_ori_[QW][k_],
+                           traj_.base_ori_[QX][k_],
+                           traj_.base_ori_[QY][k_],
+                           traj_.base_ori_[QZ][k_]);
+  return base;
+}
+
+StateLin3d
+CartesianTrajectory::StateRef::ee_motion (EndeffectorID ee) const
+{
+  StateLin3d motion;
+  for (int dim=0; dim<kDim3d; ++dim) {
+    motion.p_[dim] = traj_.ee_pos_.at(ee)[dim][k_];
+    motion.v_[dim] = traj_.ee_vel_.at(ee)[dim][k_];
+    motion.a_[dim] = traj_.ee_acc_.at(ee)[dim][k_];
+  }
+  return motion;
+}
+
+Vector3d
+CartesianTrajectory::StateRef::ee_forces (EndeffectorID ee) const
+{
+  const Channel3d& f = traj_.ee_forces_.at(ee);
+  return Vector3d(f[X][k_], f[Y][k_], f[Z][k_]);
+}
+
+bool
+CartesianTrajectory::StateRef::ee_contact (EndeffectorID ee) const
+{
+  return ee_contact().at(ee);
+}
+
+EndeffectorsContact
+CartesianTrajectory::StateRef::ee_contact () const
+{
+  return EndeffectorsContact::FromMask(GetEECount(), traj_.ee_contact_[k_]);
+}
+
+RobotStateCartesian
+CartesianTrajectory::StateRef::ToState () const
+{
+  RobotStateCartesian state(GetEECount());
+  state.t_global_ = t_global();
+  state.base_     = base();
+
+  for (auto ee : state.ee_motion_.GetEEsOrdered()) {
+    state.ee_motion_.at(ee) = ee_motion(ee);
+    state.ee_forces_.at(ee) = ee_forces(ee);
+  }
+  state.ee_contact_ = ee_contact();
+
+  return state;
+}
+
+} /* namespace xpp */
@@ -0,0 +1,208 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_states/contact_schedule.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace xpp {
+
+ContactSchedule::ContactSchedule (const States& states)
+{
+  if (states.empty())
+    throw std::invalid_argument("xpp::ContactSchedule: no states");
+
+  const auto& first = states.front().ee_contact_;
+  t_start_ = states.front().t_global_;
+  t_end_   = states.back().t_global_;
+
+  ees_.resize(first.GetEECount());
+  for (auto ee : first.GetEEsOrdered()) {
+    ees_.at(ee).first_contact = first.at(ee);
+    ees_.at(ee).t_switch.push_back(t_start_);
+  }
+
+  // only visit the endeffectors whose flag changed
+  auto prev = first.GetMask();
+  for (const auto& s : states) {
+    // the mask bits are only comparable for the same endeffectors
+    if (s.ee_contact_.GetEECount() != first.GetEECount())
+      throw std::invalid_argument("xpp::ContactSchedule: state at t="
+                                  + std::to_string(s.t_global_) + " has "
+                                  + std::to_string(s.ee_contact_.GetEECount())
+                                  + " endeffectors, the first state "
+                                  + std::to_string(first.GetEECount()));
+
+    auto mask = s.ee_contact_.GetMask();
+    for (auto changed = mask ^ prev; changed != 0; changed &= changed-1)
+      ees_.at(__builtin_ctz(changed)).t_switch.push_back(s.t_global_);
+    prev = mask;
+  }
+
+  for (auto& tl : ees_) {
+    int n_phases = tl.t_switch.size();
+    tl.t_stance.resize(n_phases, 0.0);
+
+    for (int p=0; p<n_phases; ++p) {
+      double duration = GetPhaseEnd(tl, p) - tl.t_switch.at(p);
+      bool contact = IsContactPhase(tl, p);
+      if (p+1 < n_phases)
+        tl.t_stance.at(p+1) = tl.t_stance.at(p) + (contact? duration : 0.0);
+
+      PhaseStats& stats = contact? tl.stance : tl.swing;
+      stats.min = stats.count == 0? duration : std::min(stats.min, duration);
+      stats.max = std::max(stats.max, duration);
+      stats.mean += duration;
+      stats.count++;
+    }
+
+    for (auto stats : {&tl.stance, &tl.swing})
+      if (stats->count > 0)
+        stats->mean /= stats->count;
+  }
+}
+
+const ContactSchedule::Timeline&
+ContactSchedule::GetTimeline (EndeffectorID ee) const
+{
+  if (ee >= ees_.size())
+    throw std::out_of_range("xpp::ContactSchedule: no endeffector " + std::to_string(ee));
+  return ees_.at(ee);
+}
+
+int
+ContactSchedule::GetPhaseIndex (const Timeline& tl, double t) const
+{
+  auto it = std::upper_bound(tl.t_switch.begin(), tl.t_switch.end(), t);
+  return std::max<int>(0, std::distance(tl.t_switch.begin(), it) - 1);
+}
+
+bool
+ContactSchedule::IsContactPhase (const Timeline& tl, int phase) const
+{
+  // phases alternate
+  return tl.first_contact != (phase%2 == 1);
+}
+
+double
+ContactSchedule::GetPhaseEnd (const Timeline& tl, int phase) const
+{
+  return phase+1 < int(tl.t_switch.size())? tl.t_switch.at(phase+1) : t_end_;
+}
+
+double
+ContactSchedule::GetStanceTimeUntil (const Timeline& tl, double t) const
+{
+  t = std::min(std::max(t, t_start_), t_end_);
+  int p = GetPhaseIndex(tl, t);
+  return tl.t_stance.at(p) + (IsContactPhase(tl, p)? t - tl.t_switch.at(p) : 0.0);
+}
+
+bool
+ContactSchedule::IsInContact (EndeffectorID ee, double t) const
+{
+  const Timeline& tl = GetTimeline(ee);
+  return IsContactPhase(tl, GetPhaseIndex(tl, t));
+}
+
+EndeffectorsContact
+ContactSchedule::GetContacts (double t) const
+{
+  EndeffectorsContact contacts(GetEECount());
+  for (auto ee : contacts.GetEEsOrdered())
+    contacts.at(ee) = IsInContact(ee, t);
+  return contacts;
+}
+
+double
+ContactSchedule::GetNextTouchdown (EndeffectorID ee, double t) const
+{
+  const Timeline& tl = GetTimeline(ee);
+  // the next phase starts after t, skip it if it is a swing phase
+  int n_phases = tl.t_switch.size();
+  int p = std::upper_bound(tl.t_switch.begin(), tl.t_switch.end(), t) - tl.t_switch.begin();
+  if (p < n_phases && !IsContactPhase(tl, p))
+    p++;
+  return p < n_phases? tl.t_switch.at(p) : std::numeric_limits<double>::infinity();
+}
+
+double
+ContactSchedule::GetNextLiftoff (EndeffectorID ee, double t) const
+{
+  const Timeline& tl = GetTimeline(ee);
+  int n_phases = tl.t_switch.size();
+  int p = std::upper_bound(tl.t_switch.begin(), tl.t_switch.end(), t) - tl.t_switch.begin();
+  if (p < n_phases && IsContactPhase(tl, p))
+    p++;
+  return p < n_phases? tl.t_switch.at(p) : std::numeric_limits<double>::infinity();
+}
+
+ContactSchedule::Phase
+ContactSchedule::GetPhase (EndeffectorID ee, double t) const
+{
+  const Timeline& tl = GetTimeline(ee);
+  int p = GetPhaseIndex(tl, t);
+  return {tl.t_switch.at(p), GetPhaseEnd(tl, p), IsContactPhase(tl, p)};
+}
+
+std::vector<ContactSchedule::Phase>
+ContactSchedule::GetPhases (EndeffectorID ee) const
+{
+  const Timeline& tl = GetTimeline(ee);
+  std::vector<Phase> phases;
+  for (int p=0; p<int(tl.t_switch.size()); ++p)
+    phases.push_back({tl.t_switch.at(p), GetPhaseEnd(tl, p), IsContactPhase(tl, p)});
+  return phases;
+}
+
+ContactSchedule::PhaseStats
+ContactSchedule::GetPhaseStats (EndeffectorID ee, bool contact) const
+{
+  const Timeline& tl = GetTimeline(ee);
+  return contact? tl.stance : tl.swing;
+}
+
+double
+ContactSchedule::GetDutyFactor (EndeffectorID ee, double t0, double t1) const
+{
+  const Timeline& tl = GetTimeline(ee);
+  if (t1 <= t0)
+    return IsInContact(ee, t0)? 1.0 : 0.0;
+  return (GetStanceTimeUntil(tl, t1) - GetStanceTimeUntil(tl, t0))/(t1 - t0);
+}
+
+double
+ContactSchedule::GetDutyFactor (EndeffectorID ee) const
+{
+  return GetDutyFactor(ee, t_start_, t_end_);
+}
+
+} /* namespace xpp */
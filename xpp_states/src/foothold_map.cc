@@ -0,0 +1,145 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_states/foothold_map.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace xpp {
+
+FootholdMap::FootholdMap (double tolerance)
+    : tolerance_(tolerance)
+{
+  if (tolerance <= 0.0)
+    throw std::invalid_argument("xpp::FootholdMap: tolerance must be positive");
+}
+
+FootholdMap::Cell
+FootholdMap::GetCell (const Vector3d& pos) const
+{
+  return { int(std::floor(pos.x()/tolerance_)),
+           int(std::floor(pos.y()/tolerance_)),
+           int(std::floor(pos.z()/tolerance_)) };
+}
+
+template<typename Fn>
+void
+FootholdMap::ForEachInBox (const Vector3d& min, const Vector3d& max, Fn visit) const
+{
+  Cell lo = GetCell(min);
+  Cell hi = GetCell(max);
+
+  // for boxes spanning more cells than footholds, checking each is faster
+  double n_cells = double(hi.x-lo.x+1)*(hi.y-lo.y+1)*(hi.z-lo.z+1);
+  if (n_cells > footholds_.size()) {
+    for (int i=0; i<int(footholds_.size()); ++i)
+      visit(i);
+    return;
+  }
+
+  for (int x=lo.x; x<=hi.x; ++x)
+    for (int y=lo.y; y<=hi.y; ++y)
+      for (int z=lo.z; z<=hi.z; ++z) {
+        auto it = grid_.find({x,y,z});
+        if (it != grid_.end())
+          for (int i : it->second)
+            visit(i);
+      }
+}
+
+bool
+FootholdMap::Add (const Vector3d& pos, EndeffectorID ee, double t)
+{
+  Vector3d tol = Vector3d::Constant(tolerance_);
+  bool duplicate = false;
+  ForEachInBox(pos-tol, pos+tol, [&](int i) {
+    duplicate = duplicate || (footholds_[i].pos - pos).norm() < tolerance_;
+  });
+
+  if (duplicate)
+    return false;
+
+  grid_[GetCell(pos)].push_back(footholds_.size());
+  footholds_.push_back({pos, ee, t});
+  return true;
+}
+
+int
+FootholdMap::Add (const RobotStateCartesian& state)
+{
+  return Add(state.ee_motion_.Get(kPos), state.ee_contact_, state.t_global_);
+}
+
+int
+FootholdMap::Add (const EndeffectorsPos& pos, const EndeffectorsContact& contact,
+                  double t)
+{
+  int n_new = 0;
+  for (auto ee : contact.GetEEsOrdered())
+    if (contact.at(ee))
+      n_new += Add(pos.at(ee), ee, t);
+  return n_new;
+}
+
+std::vector<int>
+FootholdMap::FindInRadius (const Vector3d& center, double radius) const
+{
+  std::vector<int> found;
+  Vector3d r = Vector3d::Constant(radius);
+  ForEachInBox(center-r, center+r, [&](int i) {
+    if ((footholds_[i].pos - center).norm() <= radius)
+      found.push_back(i);
+  });
+  std::sort(found.begin(), found.end());
+  return found;
+}
+
+std::vector<int>
+FootholdMap::FindInBox (const Vector3d& min, const Vector3d& max) const
+{
+  std::vector<int> found;
+  ForEachInBox(min, max, [&](int i) {
+    const Vector3d& p = footholds_[i].pos;
+    if ((p.array() >= min.array()).all() && (p.array() <= max.array()).all())
+      found.push_back(i);
+  });
+  std::sort(found.begin(), found.end());
+  return found;
+}
+
+void
+FootholdMap::Clear ()
+{
+  footholds_.clear();
+  grid_.clear();
+}
+
+} /* namespace xpp */
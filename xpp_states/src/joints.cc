@@ -29,16 +29,16 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <xpp_states/joints.h>
 
+#include <stdexcept>
+
 namespace xpp {
 
 
 Joints::Joints (int n_ee, int n_joints_per_leg, double value)
-    : Base(n_ee)
 {
+  n_ee_ = n_ee;
   n_joints_per_leg_ = n_joints_per_leg;
-  n_joints_ = n_ee * n_joints_per_leg;
-
-  SetAll(VectorXd::Constant(n_joints_per_leg, value));
+  q_ = VectorXd::Constant(n_ee * n_joints_per_leg, value);
 }
 
 Joints::Joints (const std::vector<VectorXd>& q_vec)
@@ -48,10 +48,57 @@ Joints::Joints (const std::vector<VectorXd>& q_vec)
     at(ee) = q_vec.at(ee);
 }
 
+Joints::EEJoints
+Joints::at (EndeffectorID ee)
+{
+  if (ee >= static_cast<EndeffectorID>(n_ee_))
+    throw std::out_of_range("xpp::Joints::at: endeffector does not exist");
+  return (*this)[ee];
+}
+
+Joints::EEJointsConst
+Joints::at (EndeffectorID ee) const
+{
+  if (ee >= static_cast<EndeffectorID>(n_ee_))
+    throw std::out_of_range("xpp::Joints::at: endeffector does not exist");
+  return (*this)[ee];
+}
+
+Joints::EEJoints
+Joints::operator[] (EndeffectorID ee)
+{
+  return q_.segment(ee*n_joints_per_leg_, n_joints_per_leg_);
+}
+
+Joints::EEJointsConst
+Joints::operator[] (EndeffectorID ee) const
+{
+  return q_.segment(ee*n_joints_per_leg_, n_joints_per_leg_);
+}
+
+void
+Joints::SetAll (const VectorXd& q_ee)
+{
+  for (auto ee : GetEEsOrdered())
+    at(ee) = q_ee;
+}
+
+int
+Joints::GetEECount () const
+{
+  return n_ee_;
+}
+
+EndeffectorRange
+Joints::GetEEsOrdered () const
+{
+  return EndeffectorRange(n_ee_);
+}
+
 int
 Joints::GetNumJoints () const
 {
-  return n_joints_;
+  return q_.rows();
 }
 
 int
@@ -60,55 +107,103 @@ Joints::GetNumJointsPerEE () const
   return n_joints_per_leg_;
 }
 
+Joints::Permutation
+Joints::GetPermutation (const EEOrder& ee_order) const
+{
+  if (static_cast<int>(ee_order.size()) != n_ee_)
+    throw std::invalid_argument("xpp::Joints::GetPermutation: order must contain every endeffector");
+
+  // joint i of endeffector ee_order[j] is moved to position j*n+i.
+  std::vector<bool> used(n_ee_, false);
+  Permutation P(GetNumJoints());
+  for (int j=0; j<n_ee_; ++j) {
+    EndeffectorID ee = ee_order.at(j);
+    if (ee >= static_cast<EndeffectorID>(n_ee_) || used.at(ee))
+      throw std::invalid_argument("xpp::Joints::GetPermutation: order must contain every endeffector once");
+    used.at(ee) = true;
+
+    for (int i=0; i<n_joints_per_leg_; ++i)
+      P.indices()(ee*n_joints_per_leg_ + i) = j*n_joints_per_leg_ + i;
+  }
+
+  return P;
+}
+
+VectorXd
+Joints::ToVec (const Permutation& P) const
+{
+  CheckSize(P.size());
+  return P*q_;
+}
+
 VectorXd
 Joints::ToVec (const EEOrder& ee_order) const
 {
-  VectorXd q_combined(n_joints_);
+  // copies the endeffectors directly, so no permutation is built per call.
+  VectorXd q(ee_order.size()*n_joints_per_leg_);
   int j = 0;
-
   for (auto ee : ee_order) {
-    q_combined.middleRows(j, n_joints_per_leg_) = at(ee);
+    q.segment(j, n_joints_per_leg_) = at(ee);
     j += n_joints_per_leg_;
   }
+  return q;
+}
 
-  return q_combined;
+void
+Joints::SetFromVec (const VectorXd& q, const Permutation& P)
+{
+  CheckSize(P.size());
+  CheckSize(q.rows());
+  q_ = P.transpose()*q;
 }
 
 void
-Joints::SetFromVec (const VectorXd& xpp, const EEOrder& ee_order)
+Joints::SetFromVec (const VectorXd& q, const EEOrder& ee_order)
 {
-  int j = 0;
+  if (q.rows() != static_cast<int>(ee_order.size())*n_joints_per_leg_)
+    throw std::invalid_argument("xpp::Joints::SetFromVec: vector does not match endeffector order");
 
+  int j = 0;
   for (auto ee : ee_order) {
-    at(ee) = xpp.middleRows(j, n_joints_per_leg_);
+    at(ee) = q.segment(j, n_joints_per_leg_);
     j += n_joints_per_leg_;
   }
 }
 
-VectorXd
+const VectorXd&
 Joints::ToVec () const
 {
-  return ToVec(GetEEsOrdered());
+  return q_;
 }
 
 void
 Joints::SetFromVec (const VectorXd& q)
 {
-  SetFromVec(q, GetEEsOrdered());
+  CheckSize(q.rows());
+  q_ = q;
 }
 
 double&
 Joints::GetJoint (JointID joint)
 {
-  div_t result = std::div(joint, n_joints_per_leg_);
-  EndeffectorID ee = result.quot;
-  return at(ee)[result.rem];
+  if (joint >= static_cast<JointID>(GetNumJoints()))
+    throw std::out_of_range("xpp::Joints::GetJoint: joint does not exist");
+  return q_[joint];
 }
 
 double
 Joints::GetJoint (JointID joint) const
 {
-  return ToVec()[joint];
+  if (joint >= static_cast<JointID>(GetNumJoints()))
+    throw std::out_of_range("xpp::Joints::GetJoint: joint does not exist");
+  return q_[joint];
+}
+
+void
+Joints::CheckSize (int n_joints) const
+{
+  if (n_joints != GetNumJoints())
+    throw std::invalid_argument("xpp::Joints: number of joints does not match");
 }
 
 } /* namespace xpp */
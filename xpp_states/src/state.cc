@@ -79,25 +79,6 @@ StateLinXd::GetByIndex (MotionDerivative deriv)
   }
 }
 
-StateLin3d::StateLin3d (const StateLinXd& state_xd) : StateLinXd(3)
-{
-  assert(state_xd.kNumDim == 3);
-
-  p_ = state_xd.p_;
-  v_ = state_xd.v_;
-  a_ = state_xd.a_;
-}
-
-StateLin2d
-StateLin3d::Get2D() const
-{
-  StateLin2d p2d;
-  p2d.p_ = p_.topRows<kDim2d>();
-  p2d.v_ = v_.topRows<kDim2d>();
-  p2d.a_ = a_.topRows<kDim2d>();
-  return p2d;
-}
-
 Vector6d
 State3d::Get6dVel () const
 {
@@ -0,0 +1,465 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_states/trajectory_archive.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace xpp {
+
+constexpr char TrajectoryArchive::kMagic[5];
+constexpr uint32_t TrajectoryArchive::kFormatVersion;
+constexpr int TrajectoryArchive::kHeaderSize;
+
+// the fixed-point values of a state, see Flatten().
+static constexpr int kBaseValues = 16; // time, base pos, vel, acc, ang. vel, ang. acc
+static constexpr int kEEValues   = 12; // ee pos, vel, acc, force
+
+static std::vector<double>
+GetSteps (const TrajectoryArchive::Resolution& r, int n_ee)
+{
+  std::vector<double> steps = { r.time,
+                                r.pos, r.pos, r.pos,
+                                r.vel, r.vel, r.vel,
+                                r.acc, r.acc, r.acc,
+                                r.vel, r.vel, r.vel,
+                                r.acc, r.acc, r.acc };
+  for (int ee=0; ee<n_ee; ++ee)
+    steps.insert(steps.end(), { r.pos,   r.pos,   r.pos,
+                                r.vel,   r.vel,   r.vel,
+                                r.acc,   r.acc,   r.acc,
+                                r.force, r.force, r.force });
+  return steps;
+}
+
+static void
+Flatten (const RobotStateCartesian& s, std::vector<double>& v)
+{
+  auto put = [&v](int i, const Vector3d& x) {
+    v[i] = x.x(); v[i+1] = x.y(); v[i+2] = x.z();
+  };
+
+  v[0] = s.t_global_;
+  put(1,  s.base_.lin.p_);
+  put(4,  s.base_.lin.v_);
+  put(7,  s.base_.lin.a_);
+  put(10, s.base_.ang.w);
+  put(13, s.base_.ang.wd);
+
+  for (auto ee : s.ee_motion_.GetEEsOrdered()) {
+    int i = kBaseValues + kEEValues*ee;
+    put(i,   s.ee_motion_.at(ee).p_);
+    put(i+3, s.ee_motion_.at(ee).v_);
+    put(i+6, s.ee_motion_.at(ee).a_);
+    put(i+9, s.ee_forces_.at(ee));
+  }
+}
+
+static void
+Unflatten (const std::vector<double>& v, RobotStateCartesian& s)
+{
+  auto get = [&v](int i) { return Vector3d(v[i], v[i+1], v[i+2]); };
+
+  s.t_global_     = v[0];
+  s.base_.lin.p_  = get(1);
+  s.base_.lin.v_  = get(4);
+  s.base_.lin.a_  = get(7);
+  s.base_.ang.w   = get(10);
+  s.base_.ang.wd  = get(13);
+
+  for (auto ee : s.ee_motion_.GetEEsOrdered()) {
+    int i = kBaseValues + kEEValues*ee;
+    s.ee_motion_.at(ee).p_ = get(i);
+    s.ee_motion_.at(ee).v_ = get(i+3);
+    s.ee_motion_.at(ee).a_ = get(i+6);
+    s.ee_forces_.at(ee)    = get(i+9);
+  }
+}
+
+template<typename T>
+static void
+PutRaw (std::vector<uint8_t>& buf, const T& value)
+{
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+  buf.insert(buf.end(), bytes, bytes+sizeof(T));
+}
+
+template<typename T>
+static T
+GetRaw (const uint8_t*& p, const uint8_t* end)
+{
+  if (p + sizeof(T) > end)
+    throw std::runtime_error("xpp::TrajectoryArchive: unexpected end of data");
+  T value;
+  std::memcpy(&value, p, sizeof(T));
+  p += sizeof(T);
+  return value;
+}
+
+static void
+PutVarint (std::vector<uint8_t>& buf, int64_t value)
+{
+  // zig-zag, so small negative values also take few bytes
+  uint64_t u = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+  while (u >= 0x80) {
+    buf.push_back(static_cast<uint8_t>(u) | 0x80);
+    u >>= 7;
+  }
+  buf.push_back(static_cast<uint8_t>(u));
+}
+
+static int64_t
+GetVarint (const uint8_t*& p, const uint8_t* end)
+{
+  uint64_t u = 0;
+  for (int shift=0; ; shift += 7) {
+    if (p == end || shift > 63)
+      throw std::runtime_error("xpp::TrajectoryArchive: corrupt varint");
+    uint8_t byte = *p++;
+    u |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      break;
+  }
+  return static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+}
+
+// smallest-three: index of the largest coefficient (2 bits) and the
+// other three, which lie in [-1/sqrt(2), 1/sqrt(2)], with 15 bits each.
+static constexpr int kQuatBits = 15;
+static constexpr int kQuatBytes = 6;
+static constexpr double kQuatMax = (1 << kQuatBits) - 1;
+
+static void
+PutQuaternion (std::vector<uint8_t>& buf, const Eigen::Quaterniond& q)
+{
+  Eigen::Vector4d c = q.normalized().coeffs();
+  int i_max;
+  c.cwiseAbs().maxCoeff(&i_max);
+  if (c(i_max) < 0.0)
+    c = -c; // q and -q are the same rotation
+
+  uint64_t bits = i_max;
+  for (int i=0, j=0; i<4; ++i) {
+    if (i == i_max)
+      continue;
+    double unit = (c(i)*M_SQRT2 + 1.0)/2.0; // [0,1]
+    uint64_t u = std::llround(std::min(std::max(unit, 0.0), 1.0)*kQuatMax);
+    bits |= u << (2 + kQuatBits*j++);
+  }
+
+  for (int b=0; b<kQuatBytes; ++b)
+    buf.push_back(static_cast<uint8_t>(bits >> 8*b));
+}
+
+static Eigen::Quaterniond
+GetQuaternion (const uint8_t*& p, const uint8_t* end)
+{
+  if (p + kQuatBytes > end)
+    throw std::runtime_error("xpp::TrajectoryArchive: unexpected end of data");
+
+  uint64_t bits = 0;
+  for (int b=0; b<kQuatBytes; ++b)
+    bits |= static_cast<uint64_t>(*p++) << 8*b;
+
+  int i_max = bits & 0x3;
+  Eigen::Vector4d c;
+  double sum_sq = 0.0;
+  for (int i=0, j=0; i<4; ++i) {
+    if (i == i_max)
+      continue;
+    uint64_t u = (bits >> (2 + kQuatBits*j++)) & ((1 << kQuatBits) - 1);
+    c(i) = (u/kQuatMax*2.0 - 1.0)/M_SQRT2;
+    sum_sq += c(i)*c(i);
+  }
+  c(i_max) = std::sqrt(std::max(0.0, 1.0 - sum_sq));
+
+  Eigen::Quaterniond q;
+  q.coeffs() = c;
+  return q.normalized();
+}
+
+static void
+PutContacts (std::vector<uint8_t>& buf, const EndeffectorsContact& contacts)
+{
+  auto mask = contacts.GetMask();
+  for (int b=0; b<(contacts.GetEECount()+7)/8; ++b)
+    buf.push_back(static_cast<uint8_t>(mask >> 8*b));
+}
+
+static EndeffectorsContact
+GetContacts (const uint8_t*& p, const uint8_t* end, int n_ee)
+{
+  EndeffectorsContact::Mask mask = 0;
+  for (int b=0; b<(n_ee+7)/8; ++b)
+    mask |= static_cast<EndeffectorsContact::Mask>(GetRaw<uint8_t>(p, end)) << 8*b;
+  return EndeffectorsContact::FromMask(n_ee, mask);
+}
+
+
+TrajectoryArchiveWriter::TrajectoryArchiveWriter (const std::string& path,
+                                                  int n_ee, int chunk_size,
+                                                  const Resolution& resolution)
+    : file_(path, std::ios::binary | std::ios::trunc),
+      n_ee_(n_ee),
+      chunk_size_(chunk_size),
+      resolution_(resolution),
+      n_chunk_states_(0),
+      t_chunk_start_(0.0),
+      n_states_(0)
+{
+  if (!file_)
+    throw std::runtime_error("xpp::TrajectoryArchiveWriter: can't open " + path);
+  if (chunk_size < 1)
+    throw std::invalid_argument("xpp::TrajectoryArchiveWriter: chunk size must be positive");
+
+  steps_ = GetSteps(resolution_, n_ee_);
+  values_.resize(steps_.size());
+  prev_.resize(steps_.size());
+
+  // placeholder, completed in Close()
+  std::vector<uint8_t> header(TrajectoryArchive::kHeaderSize, 0);
+  file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+}
+
+TrajectoryArchiveWriter::TrajectoryArchiveWriter (const std::string& path,
+                                                  int n_ee, int chunk_size)
+    : TrajectoryArchiveWriter(path, n_ee, chunk_size, Resolution())
+{
+}
+
+TrajectoryArchiveWriter::~TrajectoryArchiveWriter ()
+{
+  if (file_.is_open())
+    Close();
+}
+
+void
+TrajectoryArchiveWriter::Write (const RobotStateCartesian& state)
+{
+  if (state.ee_motion_.GetEECount() != n_ee_)
+    throw std::invalid_argument("xpp::TrajectoryArchiveWriter: wrong number of endeffectors");
+
+  Flatten(state, values_);
+
+  if (n_chunk_states_ == 0) {
+    // keyframe with full precision
+    t_chunk_start_ = state.t_global_;
+    for (int i=0; i<int(values_.size()); ++i) {
+      PutRaw(chunk_, values_[i]);
+      prev_[i] = std::llround(values_[i]/steps_[i]);
+    }
+    for (int i=0; i<4; ++i)
+      PutRaw(chunk_, state.base_.ang.q.coeffs()(i));
+  }
+  else {
+    for (int i=0; i<int(values_.size()); ++i) {
+      int64_t q = std::llround(values_[i]/steps_[i]);
+      PutVarint(chunk_, q - prev_[i]);
+      prev_[i] = q;
+    }
+    PutQuaternion(chunk_, state.base_.ang.q);
+  }
+  PutContacts(chunk_, state.ee_contact_);
+
+  n_states_++;
+  if (++n_chunk_states_ == chunk_size_)
+    FlushChunk();
+}
+
+void
+TrajectoryArchiveWriter::FlushChunk ()
+{
+  if (n_chunk_states_ == 0)
+    return;
+
+  index_.push_back({static_cast<uint64_t>(file_.tellp()),
+                    static_cast<uint32_t>(n_chunk_states_),
+                    t_chunk_start_});
+  file_.write(reinterpret_cast<const char*>(chunk_.data()), chunk_.size());
+  chunk_.clear();
+  n_chunk_states_ = 0;
+}
+
+void
+TrajectoryArchiveWriter::Close ()
+{
+  FlushChunk();
+
+  uint64_t index_offset = file_.tellp();
+  std::vector<uint8_t> index;
+  PutRaw(index, static_cast<uint32_t>(index_.size()));
+  for (const auto& chunk : index_) {
+    PutRaw(index, chunk.offset);
+    PutRaw(index, chunk.n_states);
+    PutRaw(index, chunk.t_start);
+  }
+  file_.write(reinterpret_cast<const char*>(index.data()), index.size());
+
+  std::vector<uint8_t> header(TrajectoryArchive::kMagic, TrajectoryArchive::kMagic+4);
+  PutRaw(header, TrajectoryArchive::kFormatVersion);
+  PutRaw(header, static_cast<uint32_t>(n_ee_));
+  PutRaw(header, static_cast<uint32_t>(chunk_size_));
+  PutRaw(header, n_states_);
+  PutRaw(header, resolution_.time);
+  PutRaw(header, resolution_.pos);
+  PutRaw(header, resolution_.vel);
+  PutRaw(header, resolution_.acc);
+  PutRaw(header, resolution_.force);
+  PutRaw(header, index_offset);
+  header.resize(TrajectoryArchive::kHeaderSize, 0);
+
+  file_.seekp(0);
+  file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+  file_.close();
+}
+
+
+TrajectoryArchiveReader::TrajectoryArchiveReader (const std::string& path)
+    : file_(path, std::ios::binary)
+{
+  if (!file_)
+    throw std::runtime_error("xpp::TrajectoryArchiveReader: can't open " + path);
+
+  // magic, version, n_ee, chunk_size, n_states, 5 resolutions, index offset
+  buffer_.resize(TrajectoryArchive::kHeaderSize);
+  file_.read(reinterpret_cast<char*>(buffer_.data()), buffer_.size());
+  if (!file_ || std::memcmp(buffer_.data(), TrajectoryArchive::kMagic, 4) != 0)
+    throw std::runtime_error("xpp::TrajectoryArchiveReader: not an archive " + path);
+
+  const uint8_t* p = buffer_.data() + 4;
+  const uint8_t* end = buffer_.data() + buffer_.size();
+  if (GetRaw<uint32_t>(p, end) != TrajectoryArchive::kFormatVersion)
+    throw std::runtime_error("xpp::TrajectoryArchiveReader: unsupported version " + path);
+
+  n_ee_        = GetRaw<uint32_t>(p, end);
+  chunk_size_  = GetRaw<uint32_t>(p, end);
+  n_states_    = GetRaw<uint64_t>(p, end);
+  resolution_.time  = GetRaw<double>(p, end);
+  resolution_.pos   = GetRaw<double>(p, end);
+  resolution_.vel   = GetRaw<double>(p, end);
+  resolution_.acc   = GetRaw<double>(p, end);
+  resolution_.force = GetRaw<double>(p, end);
+  index_offset_ = GetRaw<uint64_t>(p, end);
+  steps_ = GetSteps(resolution_, n_ee_);
+
+  file_.seekg(0, std::ios::end);
+  uint64_t file_size = file_.tellg();
+  if (index_offset_ > file_size)
+    throw std::runtime_error("xpp::TrajectoryArchiveReader: incomplete archive " + path);
+
+  buffer_.resize(file_size - index_offset_);
+  file_.seekg(index_offset_);
+  file_.read(reinterpret_cast<char*>(buffer_.data()), buffer_.size());
+
+  p = buffer_.data();
+  end = buffer_.data() + buffer_.size();
+  index_.resize(GetRaw<uint32_t>(p, end));
+  for (auto& chunk : index_) {
+    chunk.offset   = GetRaw<uint64_t>(p, end);
+    chunk.n_states = GetRaw<uint32_t>(p, end);
+    chunk.t_start  = GetRaw<double>(p, end);
+  }
+}
+
+void
+TrajectoryArchiveReader::ReadChunk (int chunk, States& states)
+{
+  const auto& info = index_.at(chunk);
+  uint64_t next = chunk+1 < int(index_.size())? index_.at(chunk+1).offset : index_offset_;
+
+  buffer_.resize(next - info.offset);
+  file_.seekg(info.offset);
+  file_.read(reinterpret_cast<char*>(buffer_.data()), buffer_.size());
+  if (!file_)
+    throw std::runtime_error("xpp::TrajectoryArchiveReader: can't read chunk");
+
+  const uint8_t* p = buffer_.data();
+  const uint8_t* end = buffer_.data() + buffer_.size();
+
+  std::vector<double> values(steps_.size());
+  std::vector<int64_t> prev(steps_.size());
+  RobotStateCartesian state(n_ee_);
+
+  for (uint32_t k=0; k<info.n_states; ++k) {
+    if (k == 0) {
+      for (int i=0; i<int(values.size()); ++i) {
+        values[i] = GetRaw<double>(p, end);
+        prev[i] = std::llround(values[i]/steps_[i]);
+      }
+      for (int i=0; i<4; ++i)
+        state.base_.ang.q.coeffs()(i) = GetRaw<double>(p, end);
+    }
+    else {
+      for (int i=0; i<int(values.size()); ++i) {
+        prev[i] += GetVarint(p, end);
+        values[i] = prev[i]*steps_[i];
+      }
+      state.base_.ang.q = GetQuaternion(p, end);
+    }
+    state.ee_contact_ = GetContacts(p, end, n_ee_);
+
+    Unflatten(values, state);
+    states.push_back(state);
+  }
+}
+
+TrajectoryArchiveReader::States
+TrajectoryArchiveReader::ReadAll ()
+{
+  States states;
+  states.reserve(n_states_);
+  for (int c=0; c<int(index_.size()); ++c)
+    ReadChunk(c, states);
+  return states;
+}
+
+RobotStateCartesian
+TrajectoryArchiveReader::ReadState (int k)
+{
+  if (k < 0 || k >= n_states_)
+    throw std::out_of_range("xpp::TrajectoryArchiveReader::ReadState");
+
+  // all chunks but the last are full
+  States states;
+  ReadChunk(k/chunk_size_, states);
+  return states.at(k%chunk_size_);
+}
+
+int
+TrajectoryArchiveReader::FindChunk (double t) const
+{
+  auto it = std::upper_bound(index_.begin(), index_.end(), t,
+      [](double t, const TrajectoryArchive::ChunkInfo& c) { return t < c.t_start; });
+  return std::max<int>(0, std::distance(index_.begin(), it) - 1);
+}
+
+} /* namespace xpp */
@@ -0,0 +1,172 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_states/trajectory_decimator.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace xpp {
+
+TrajectoryDecimator::TrajectoryDecimator ()
+    : tol_(), playback_(kInterpolate)
+{
+}
+
+TrajectoryDecimator::TrajectoryDecimator (const Tolerances& tol, Playback playback)
+    : tol_(tol), playback_(playback)
+{
+}
+
+double
+TrajectoryDecimator::GetRelativeError (const States& states, int i, int j, int k) const
+{
+  const auto& a = states.at(i);
+  const auto& b = states.at(j);
+  const auto& s = states.at(k);
+
+  double dt = b.t_global_ - a.t_global_;
+  double alpha = dt > 0.0? (s.t_global_ - a.t_global_)/dt
+                         : double(k-i)/(j-i); // fall back to index if no time
+  if (playback_ == kHold)
+    alpha = 0.0; // state i is shown until j arrives
+  auto lerp = [alpha](const Vector3d& p0, const Vector3d& p1) {
+    return Vector3d((1-alpha)*p0 + alpha*p1);
+  };
+
+  double error = 0.0;
+  auto check = [&error](double deviation, double tol) {
+    error = std::max(error, deviation/tol);
+  };
+
+  check((lerp(a.base_.lin.p_, b.base_.lin.p_) - s.base_.lin.p_).norm(), tol_.base_pos);
+
+  Eigen::Quaterniond q = a.base_.ang.q.slerp(alpha, b.base_.ang.q);
+  check(q.angularDistance(s.base_.ang.q), tol_.base_angle);
+
+  for (auto ee : s.ee_motion_.GetEEsOrdered()) {
+    Vector3d p = lerp(a.ee_motion_.at(ee).p_, b.ee_motion_.at(ee).p_);
+    check((p - s.ee_motion_.at(ee).p_).norm(), tol_.ee_pos);
+
+    Vector3d f = lerp(a.ee_forces_.at(ee), b.ee_forces_.at(ee));
+    check((f - s.ee_forces_.at(ee)).norm(), tol_.ee_force);
+  }
+
+  return error;
+}
+
+void
+TrajectoryDecimator::Simplify (const States& states, int i, int j,
+                               std::vector<bool>& keep) const
+{
+  // iterative instead of recursive, as trajectories can be long
+  std::vector<std::pair<int,int>> segments = { {i, j} };
+
+  while (!segments.empty()) {
+    int first = segments.back().first;
+    int last  = segments.back().second;
+    segments.pop_back();
+
+    double max_error = 0.0;
+    int k_max = -1;
+    for (int k=first+1; k<last; ++k) {
+      double error = GetRelativeError(states, first, last, k);
+      if (error > max_error) {
+        max_error = error;
+        k_max = k;
+      }
+    }
+
+    if (max_error > 1.0) {
+      keep.at(k_max) = true;
+      segments.push_back({first, k_max});
+      segments.push_back({k_max, last});
+    }
+  }
+}
+
+void
+TrajectoryDecimator::SimplifyHold (const States& states, int i, int j,
+                                   std::vector<bool>& keep) const
+{
+  // a single pass suffices, as the error only depends on the last kept state
+  int last = i;
+  for (int k=i+1; k<j; ++k) {
+    if (GetRelativeError(states, last, j, k) > 1.0) {
+      keep.at(k) = true;
+      last = k;
+    }
+  }
+}
+
+std::vector<int>
+TrajectoryDecimator::GetKeptIndices (const States& states) const
+{
+  int n = states.size();
+  std::vector<bool> keep(n, false);
+  if (n == 0)
+    return {};
+
+  keep.front() = keep.back() = true;
+  for (int k=1; k<n; ++k) {
+    if (states.at(k).ee_contact_ != states.at(k-1).ee_contact_)
+      keep.at(k-1) = keep.at(k) = true;
+  }
+
+  // refine between each pair of neighboring mandatory states
+  int i = 0;
+  for (int j=1; j<n; ++j) {
+    if (keep.at(j)) {
+      if (playback_ == kHold)
+        SimplifyHold(states, i, j, keep);
+      else
+        Simplify(states, i, j, keep);
+      i = j;
+    }
+  }
+
+  std::vector<int> indices;
+  for (int k=0; k<n; ++k)
+    if (keep.at(k))
+      indices.push_back(k);
+
+  return indices;
+}
+
+TrajectoryDecimator::States
+TrajectoryDecimator::Decimate (const States& states) const
+{
+  States kept;
+  for (int k : GetKeptIndices(states))
+    kept.push_back(states.at(k));
+
+  return kept;
+}
+
+} /* namespace xpp */
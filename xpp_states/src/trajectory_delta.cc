@@ -0,0 +1,210 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_states/trajectory_delta.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace xpp {
+
+// points at times closer than this are considered at the same time.
+static constexpr double kTimeEps = 1e-6;
+
+static bool
+Earlier (const RobotStateCartesian& state, double t)
+{
+  return state.t_global_ < t - kTimeEps;
+}
+
+static bool
+Later (double t, const RobotStateCartesian& state)
+{
+  return state.t_global_ > t + kTimeEps;
+}
+
+constexpr TrajectoryDelta::Version TrajectoryDelta::kFullVersion;
+
+bool
+TrajectoryDelta::IsSame (const RobotStateCartesian& a,
+                         const RobotStateCartesian& b, double tol)
+{
+  if (std::abs(a.t_global_ - b.t_global_) > kTimeEps)
+    return false;
+
+  if (a.ee_contact_ != b.ee_contact_
+      || a.ee_motion_.GetEECount() != b.ee_motion_.GetEECount())
+    return false;
+
+  auto same = [tol](const Vector3d& v1, const Vector3d& v2) {
+    return (v1-v2).cwiseAbs().maxCoeff() <= tol;
+  };
+
+  if (!same(a.base_.lin.p_, b.base_.lin.p_)
+      || !same(a.base_.lin.v_, b.base_.lin.v_)
+      || !same(a.base_.lin.a_, b.base_.lin.a_)
+      || (a.base_.ang.q.coeffs()-b.base_.ang.q.coeffs()).cwiseAbs().maxCoeff() > tol
+      || !same(a.base_.ang.w, b.base_.ang.w)
+      || !same(a.base_.ang.wd, b.base_.ang.wd))
+    return false;
+
+  for (auto ee : a.ee_motion_.GetEEsOrdered()) {
+    const auto& ma = a.ee_motion_.at(ee);
+    const auto& mb = b.ee_motion_.at(ee);
+    if (!same(ma.p_, mb.p_) || !same(ma.v_, mb.v_) || !same(ma.a_, mb.a_)
+        || !same(a.ee_forces_.at(ee), b.ee_forces_.at(ee)))
+      return false;
+  }
+
+  return true;
+}
+
+TrajectoryDelta
+TrajectoryDelta::Full (const States& curr, Version version)
+{
+  if (version == kFullVersion)
+    throw std::invalid_argument("xpp::TrajectoryDelta: version 0 is reserved for full trajectories");
+
+  TrajectoryDelta delta;
+  delta.base_version_ = kFullVersion;
+  delta.version_ = version;
+  delta.points_ = curr;
+  if (!curr.empty()) {
+    delta.t_start_ = curr.front().t_global_;
+    delta.t_end_   = curr.back().t_global_;
+  }
+  return delta;
+}
+
+TrajectoryDelta
+TrajectoryDelta::Between (const States& prev, const States& curr,
+                          Version prev_version, double tol)
+{
+  // a delta based on version 0 would be taken as a full trajectory
+  if (prev_version == kFullVersion)
+    throw std::invalid_argument("xpp::TrajectoryDelta: no delta to version 0, send Full() first");
+
+  TrajectoryDelta delta;
+  delta.base_version_ = prev_version;
+  delta.version_ = prev_version+1 == kFullVersion? prev_version+2 : prev_version+1;
+
+  // nothing left of the plan, so all points of prev must be removed
+  if (curr.empty()) {
+    if (!prev.empty()) {
+      delta.t_start_ = prev.front().t_global_;
+      delta.t_end_   = prev.back().t_global_;
+    }
+    return delta;
+  }
+
+  // whether the point of curr at index k exists identically in prev
+  auto unchanged = [&](int k) {
+    auto it = std::lower_bound(prev.begin(), prev.end(), curr[k].t_global_, Earlier);
+    return it != prev.end() && IsSame(*it, curr[k], tol);
+  };
+
+  int n = curr.size();
+  int k_first = 0;
+  while (k_first < n && unchanged(k_first))
+    ++k_first;
+
+  int k_last = n-1;
+  while (k_last >= k_first && unchanged(k_last))
+    --k_last;
+
+  // points of prev after the end of curr must be removed
+  bool prev_longer = !prev.empty() && Later(curr.back().t_global_, prev.back());
+
+  if (k_first <= k_last) {
+    if (prev_longer)
+      k_last = n-1;
+
+    delta.points_.assign(curr.begin()+k_first, curr.begin()+k_last+1);
+
+    // window reaches up to the unchanged neighbors, so points of prev
+    // sampled at other times in between are removed as well.
+    delta.t_start_ = k_first > 0? curr[k_first-1].t_global_ + 2*kTimeEps
+                                : curr[k_first].t_global_;
+    delta.t_end_   = k_last < n-1? curr[k_last+1].t_global_ - 2*kTimeEps
+                                 : curr[k_last].t_global_;
+    if (prev_longer)
+      delta.t_end_ = prev.back().t_global_;
+  }
+  else if (prev_longer) {
+    delta.t_start_ = curr.back().t_global_ + 2*kTimeEps;
+    delta.t_end_   = prev.back().t_global_;
+  }
+
+  return delta;
+}
+
+void
+TrajectoryBuffer::Set (const States& points, Version version)
+{
+  if (version == TrajectoryDelta::kFullVersion)
+    throw std::invalid_argument("xpp::TrajectoryBuffer: version 0 is reserved for full trajectories");
+
+  points_ = points;
+  version_ = version;
+}
+
+bool
+TrajectoryBuffer::Apply (const TrajectoryDelta& delta)
+{
+  if (delta.version_ == TrajectoryDelta::kFullVersion)
+    return false;
+
+  if (delta.IsFull()) {
+    Set(delta.points_, delta.version_);
+    return true;
+  }
+
+  if (delta.base_version_ != version_)
+    return false;
+
+  auto first = std::lower_bound(points_.begin(), points_.end(), delta.t_start_, Earlier);
+  auto last  = std::upper_bound(first, points_.end(), delta.t_end_, Later);
+
+  // overwrite the overlapping points, then insert or erase the difference
+  int n_old = std::distance(first, last);
+  int n_new = delta.points_.size();
+  int n_overwrite = std::min(n_old, n_new);
+
+  auto it = std::copy(delta.points_.begin(), delta.points_.begin()+n_overwrite, first);
+  if (n_new > n_old)
+    points_.insert(it, delta.points_.begin()+n_overwrite, delta.points_.end());
+  else
+    points_.erase(it, it + (n_old-n_new));
+
+  version_ = delta.version_;
+  return true;
+}
+
+} /* namespace xpp */
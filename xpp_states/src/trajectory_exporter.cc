@@ -0,0 +1,232 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_states/trajectory_exporter.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace xpp {
+
+static const uint32_t kBinaryVersion = 1;
+
+std::vector<std::string>
+TrajectoryExporter::GetColumnNames (int n_ee)
+{
+  std::vector<std::string> names = {"t"};
+  auto add = [&names](const std::string& prefix, const std::string& quantity) {
+    for (auto axis : {"x", "y", "z"})
+      names.push_back(prefix + quantity + axis);
+  };
+
+  add("base_", "");
+  add("base_", "v");
+  add("base_", "a");
+  for (auto coeff : {"w", "x", "y", "z"})
+    names.push_back(std::string("base_q") + coeff);
+  add("base_", "w");
+  add("base_", "wd");
+
+  for (int ee=0; ee<n_ee; ++ee) {
+    std::string prefix = "ee" + std::to_string(ee) + "_";
+    add(prefix, "");
+    add(prefix, "v");
+    add(prefix, "a");
+    add(prefix, "f");
+    names.push_back(prefix + "contact");
+  }
+  return names;
+}
+
+// appends the values of the state in the order of GetColumnNames().
+static void
+AppendRow (const RobotStateCartesian& s, std::vector<double>& rows)
+{
+  auto add = [&rows](const Vector3d& v) {
+    rows.insert(rows.end(), { v.x(), v.y(), v.z() });
+  };
+
+  rows.push_back(s.t_global_);
+  add(s.base_.lin.p_);
+  add(s.base_.lin.v_);
+  add(s.base_.lin.a_);
+  const Eigen::Quaterniond& q = s.base_.ang.q;
+  rows.insert(rows.end(), { q.w(), q.x(), q.y(), q.z() });
+  add(s.base_.ang.w);
+  add(s.base_.ang.wd);
+
+  for (auto ee : s.ee_motion_.GetEEsOrdered()) {
+    add(s.ee_motion_.at(ee).p_);
+    add(s.ee_motion_.at(ee).v_);
+    add(s.ee_motion_.at(ee).a_);
+    add(s.ee_forces_.at(ee));
+    rows.push_back(s.ee_contact_.at(ee)? 1.0 : 0.0);
+  }
+}
+
+static std::string
+EncodeCSV (const std::vector<double>& rows, int n_columns)
+{
+  std::string out;
+  out.reserve(rows.size()*12);
+
+  // enough digits to read back the identical double
+  const int digits = std::numeric_limits<double>::max_digits10;
+  char buf[32];
+  for (int i=0; i<int(rows.size()); ++i) {
+    int n = std::snprintf(buf, sizeof(buf), "%.*g", digits, rows[i]);
+    out.append(buf, n);
+    out.push_back((i+1)%n_columns == 0? '\n' : ',');
+  }
+  return out;
+}
+
+static std::string
+EncodeBinary (const std::vector<double>& rows, int n_columns)
+{
+  uint32_t n_rows = rows.size()/n_columns;
+  std::string out(sizeof(n_rows) + rows.size()*sizeof(double), '\0');
+  char* p = &out[0];
+  std::memcpy(p, &n_rows, sizeof(n_rows));
+  p += sizeof(n_rows);
+
+  // transpose from rows to columns
+  for (int c=0; c<n_columns; ++c)
+    for (uint32_t r=0; r<n_rows; ++r) {
+      std::memcpy(p, &rows[r*n_columns + c], sizeof(double));
+      p += sizeof(double);
+    }
+  return out;
+}
+
+
+TrajectoryExporter::TrajectoryExporter (std::ostream& out, int n_ee,
+                                        Format format, int chunk_size,
+                                        int n_threads)
+    : out_(out),
+      n_ee_(n_ee),
+      n_columns_(GetColumnNames(n_ee).size()),
+      format_(format),
+      chunk_size_(chunk_size),
+      n_threads_(n_threads),
+      closed_(false)
+{
+  if (chunk_size < 1 || n_threads < 1)
+    throw std::invalid_argument("xpp::TrajectoryExporter: chunk size and threads must be positive");
+
+  rows_.reserve(chunk_size_*n_columns_);
+  WriteHeader();
+}
+
+TrajectoryExporter::~TrajectoryExporter ()
+{
+  if (closed_)
+    return;
+
+  // an exception leaving the destructor would terminate the program
+  try {
+    Close();
+  } catch (const std::exception& e) {
+    std::cerr << "xpp::TrajectoryExporter: export incomplete, " << e.what() << std::endl;
+  }
+}
+
+void
+TrajectoryExporter::WriteHeader ()
+{
+  auto names = GetColumnNames(n_ee_);
+
+  if (format_ == CSV) {
+    int n_names = names.size();
+    for (int c=0; c<n_names; ++c)
+      out_ << names.at(c) << (c+1 < n_names? "," : "\n");
+  }
+  else {
+    uint32_t n_columns = n_columns_;
+    out_.write("XPPC", 4);
+    out_.write(reinterpret_cast<const char*>(&kBinaryVersion), sizeof(kBinaryVersion));
+    out_.write(reinterpret_cast<const char*>(&n_columns), sizeof(n_columns));
+    for (const auto& name : names)
+      out_ << name << '\n';
+  }
+}
+
+void
+TrajectoryExporter::Write (const RobotStateCartesian& state)
+{
+  if (closed_)
+    throw std::logic_error("xpp::TrajectoryExporter: already closed");
+  if (state.ee_motion_.GetEECount() != n_ee_)
+    throw std::invalid_argument("xpp::TrajectoryExporter: wrong number of endeffectors");
+
+  AppendRow(state, rows_);
+  if (int(rows_.size()) == chunk_size_*n_columns_)
+    SubmitChunk();
+}
+
+void
+TrajectoryExporter::SubmitChunk ()
+{
+  if (rows_.empty())
+    return;
+
+  // bound the memory by waiting for the oldest chunk
+  if (int(pending_.size()) == n_threads_)
+    WriteOldestChunk();
+
+  auto encode = format_ == CSV? EncodeCSV : EncodeBinary;
+  pending_.push_back(std::async(std::launch::async, encode, std::move(rows_), n_columns_));
+
+  rows_.clear();
+  rows_.reserve(chunk_size_*n_columns_);
+}
+
+void
+TrajectoryExporter::WriteOldestChunk ()
+{
+  std::string chunk = pending_.front().get();
+  pending_.pop_front();
+  out_.write(chunk.data(), chunk.size());
+}
+
+void
+TrajectoryExporter::Close ()
+{
+  SubmitChunk();
+  while (!pending_.empty())
+    WriteOldestChunk();
+  out_.flush();
+  closed_ = true;
+}
+
+} /* namespace xpp */
@@ -0,0 +1,366 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_states/trajectory_file.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace xpp {
+
+constexpr char TrajectoryFileFormat::kMagic[5];
+constexpr uint32_t TrajectoryFileFormat::kFormatVersion;
+constexpr int TrajectoryFileFormat::kHeaderSize;
+constexpr int TrajectoryFileFormat::kBaseValues;
+constexpr int TrajectoryFileFormat::kEEMotionValues;
+
+using F = TrajectoryFileFormat;
+
+// byte offsets of the columns inside a block of b states and n_ee endeffectors.
+static size_t BaseColumn     (int b)           { return 8*b; }
+static size_t EEMotionColumn (int b)           { return 8*b*(1 + F::kBaseValues); }
+static size_t EEForceColumn  (int b, int n_ee) { return 8*b*(1 + F::kBaseValues + F::kEEMotionValues*n_ee); }
+static size_t ContactColumn  (int b, int n_ee) { return 8*b*(1 + F::kBaseValues + (F::kEEMotionValues+3)*n_ee); }
+static size_t BlockBytes     (int b, int n_ee) { return (ContactColumn(b, n_ee) + 4*b + 7)/8*8; }
+
+// header fields following the magic
+struct TrajectoryFileHeader {
+  uint32_t version;
+  uint32_t n_ee;
+  uint32_t block_size;
+  uint64_t n_states;
+  double t_start;
+  double dt;
+  uint64_t index_offset;
+};
+
+static void
+Put (double* v, const Vector3d& x)
+{
+  v[0] = x.x(); v[1] = x.y(); v[2] = x.z();
+}
+
+static Vector3d
+Get (const double* v)
+{
+  return Vector3d(v[0], v[1], v[2]);
+}
+
+template<typename T>
+static void
+WriteColumn (std::ofstream& file, const std::vector<T>& column)
+{
+  file.write(reinterpret_cast<const char*>(column.data()), column.size()*sizeof(T));
+}
+
+
+TrajectoryFileWriter::TrajectoryFileWriter (const std::string& path, int n_ee,
+                                            int block_size)
+    : file_(path, std::ios::binary | std::ios::trunc),
+      n_ee_(n_ee),
+      block_size_(block_size),
+      n_states_(0),
+      t_start_(0.0),
+      dt_(0.0),
+      t_prev_(0.0),
+      n_block_states_(0)
+{
+  if (!file_)
+    throw std::runtime_error("xpp::TrajectoryFileWriter: can't open " + path);
+  if (block_size < 1)
+    throw std::invalid_argument("xpp::TrajectoryFileWriter: block size must be positive");
+
+  // zero filled, so the columns of a partial last block are padded
+  time_.assign(block_size_, 0.0);
+  base_.assign(block_size_*F::kBaseValues, 0.0);
+  ee_motion_.assign(block_size_*F::kEEMotionValues*n_ee_, 0.0);
+  ee_forces_.assign(block_size_*3*n_ee_, 0.0);
+  contact_.assign(block_size_, 0);
+
+  // placeholder, completed in Close()
+  std::vector<char> header(F::kHeaderSize, 0);
+  file_.write(header.data(), header.size());
+}
+
+TrajectoryFileWriter::~TrajectoryFileWriter ()
+{
+  if (file_.is_open())
+    Close();
+}
+
+void
+TrajectoryFileWriter::Write (const RobotStateCartesian& state)
+{
+  if (state.ee_motion_.GetEECount() != n_ee_)
+    throw std::invalid_argument("xpp::TrajectoryFileWriter: wrong number of endeffectors");
+
+  double t = state.t_global_;
+  if (n_states_ > 0 && t < t_prev_)
+    throw std::invalid_argument("xpp::TrajectoryFileWriter: states must be ordered in time");
+
+  if (n_states_ == 0)
+    t_start_ = t;
+  else if (n_states_ == 1)
+    dt_ = t - t_prev_;
+  else if (std::abs(t - t_prev_ - dt_) > 1e-9)
+    dt_ = 0.0; // not uniformly sampled
+  t_prev_ = t;
+
+  if (n_block_states_ == 0)
+    block_t_start_.push_back(t);
+
+  int i = n_block_states_;
+  time_.at(i) = t;
+
+  double* b = &base_.at(i*F::kBaseValues);
+  Put(b,    state.base_.lin.p_);
+  Put(b+3,  state.base_.lin.v_);
+  Put(b+6,  state.base_.lin.a_);
+  Eigen::Map<Eigen::Vector4d>(b+9) = state.base_.ang.q.coeffs();
+  Put(b+13, state.base_.ang.w);
+  Put(b+16, state.base_.ang.wd);
+
+  for (auto ee : state.ee_motion_.GetEEsOrdered()) {
+    double* m = &ee_motion_.at((i*n_ee_ + ee)*F::kEEMotionValues);
+    Put(m,   state.ee_motion_.at(ee).p_);
+    Put(m+3, state.ee_motion_.at(ee).v_);
+    Put(m+6, state.ee_motion_.at(ee).a_);
+    Put(&ee_forces_.at((i*n_ee_ + ee)*3), state.ee_forces_.at(ee));
+  }
+  contact_.at(i) = state.ee_contact_.GetMask();
+
+  n_states_++;
+  if (++n_block_states_ == block_size_)
+    FlushBlock();
+}
+
+void
+TrajectoryFileWriter::FlushBlock ()
+{
+  if (n_block_states_ == 0)
+    return;
+
+  // the unused part of the last block is written as well, so that all
+  // blocks have the same size.
+  WriteColumn(file_, time_);
+  WriteColumn(file_, base_);
+  WriteColumn(file_, ee_motion_);
+  WriteColumn(file_, ee_forces_);
+  WriteColumn(file_, contact_);
+
+  size_t padding = BlockBytes(block_size_, n_ee_) - ContactColumn(block_size_, n_ee_) - 4*block_size_;
+  file_.write(std::string(padding, '\0').data(), padding);
+
+  // the next block might be partial, so its unused part is zero as well
+  std::fill(time_.begin(), time_.end(), 0.0);
+  std::fill(base_.begin(), base_.end(), 0.0);
+  std::fill(ee_motion_.begin(), ee_motion_.end(), 0.0);
+  std::fill(ee_forces_.begin(), ee_forces_.end(), 0.0);
+  std::fill(contact_.begin(), contact_.end(), 0);
+  n_block_states_ = 0;
+}
+
+void
+TrajectoryFileWriter::Close ()
+{
+  FlushBlock();
+
+  TrajectoryFileHeader header = TrajectoryFileHeader(); // zero padding bytes
+  header.version      = F::kFormatVersion;
+  header.n_ee         = n_ee_;
+  header.block_size   = block_size_;
+  header.n_states     = n_states_;
+  header.t_start      = t_start_;
+  header.dt           = n_states_ > 1? dt_ : 0.0;
+  header.index_offset = file_.tellp();
+
+  WriteColumn(file_, block_t_start_);
+
+  std::vector<char> bytes(F::kHeaderSize, 0);
+  std::memcpy(bytes.data(), F::kMagic, 4);
+  std::memcpy(bytes.data()+8, &header, sizeof(header));
+  file_.seekp(0);
+  file_.write(bytes.data(), bytes.size());
+  file_.close();
+}
+
+
+TrajectoryFile::TrajectoryFile (const std::string& path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("xpp::TrajectoryFile: can't open " + path);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < F::kHeaderSize) {
+    close(fd);
+    throw std::runtime_error("xpp::TrajectoryFile: not a trajectory file " + path);
+  }
+  size_ = st.st_size;
+
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping stays valid
+  if (data == MAP_FAILED)
+    throw std::runtime_error("xpp::TrajectoryFile: can't map " + path);
+  data_ = static_cast<const uint8_t*>(data);
+
+  TrajectoryFileHeader header;
+  std::memcpy(&header, data_+8, sizeof(header));
+
+  std::string error;
+  if (std::memcmp(data_, F::kMagic, 4) != 0)
+    error = "not a trajectory file ";
+  else if (header.version != F::kFormatVersion)
+    error = "unsupported version ";
+  else if (header.n_states == 0)
+    error = "no states in ";
+  else {
+    n_ee_        = header.n_ee;
+    block_size_  = header.block_size;
+    n_states_    = header.n_states;
+    dt_          = header.dt;
+    block_bytes_ = BlockBytes(block_size_, n_ee_);
+
+    size_t n_blocks = (n_states_ + block_size_ - 1)/block_size_;
+    if (header.index_offset != F::kHeaderSize + n_blocks*block_bytes_
+        || header.index_offset + n_blocks*sizeof(double) > size_)
+      error = "incomplete file ";
+    block_t_start_ = reinterpret_cast<const double*>(data_ + header.index_offset);
+  }
+
+  if (!error.empty()) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+    throw std::runtime_error("xpp::TrajectoryFile: " + error + path);
+  }
+}
+
+TrajectoryFile::~TrajectoryFile ()
+{
+  munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+template<typename T>
+const T*
+TrajectoryFile::GetColumn (int k, size_t column_offset, int& i) const
+{
+  if (k < 0 || k >= n_states_)
+    throw std::out_of_range("xpp::TrajectoryFile: no state " + std::to_string(k));
+
+  i = k%block_size_;
+  const uint8_t* block = data_ + F::kHeaderSize + (k/block_size_)*block_bytes_;
+  return reinterpret_cast<const T*>(block + column_offset);
+}
+
+double
+TrajectoryFile::GetTime (int k) const
+{
+  int i;
+  return GetColumn<double>(k, 0, i)[i];
+}
+
+State3d
+TrajectoryFile::GetBase (int k) const
+{
+  int i;
+  const double* b = GetColumn<double>(k, BaseColumn(block_size_), i)
+                    + i*F::kBaseValues;
+  State3d base;
+  base.lin.p_   = Get(b);
+  base.lin.v_   = Get(b+3);
+  base.lin.a_   = Get(b+6);
+  base.ang.q.coeffs() = Eigen::Map<const Eigen::Vector4d>(b+9);
+  base.ang.w    = Get(b+13);
+  base.ang.wd   = Get(b+16);
+  return base;
+}
+
+EndeffectorsContact
+TrajectoryFile::GetContact (int k) const
+{
+  int i;
+  uint32_t mask = GetColumn<uint32_t>(k, ContactColumn(block_size_, n_ee_), i)[i];
+  return EndeffectorsContact::FromMask(n_ee_, mask);
+}
+
+RobotStateCartesian
+TrajectoryFile::GetState (int k) const
+{
+  RobotStateCartesian state(n_ee_);
+  state.t_global_   = GetTime(k);
+  state.base_       = GetBase(k);
+  state.ee_contact_ = GetContact(k);
+
+  int i;
+  const double* m = GetColumn<double>(k, EEMotionColumn(block_size_), i);
+  const double* f = GetColumn<double>(k, EEForceColumn(block_size_, n_ee_), i);
+  for (auto ee : state.ee_motion_.GetEEsOrdered()) {
+    const double* m_ee = m + (i*n_ee_ + ee)*F::kEEMotionValues;
+    state.ee_motion_.at(ee).p_ = Get(m_ee);
+    state.ee_motion_.at(ee).v_ = Get(m_ee+3);
+    state.ee_motion_.at(ee).a_ = Get(m_ee+6);
+    state.ee_forces_.at(ee)    = Get(f + (i*n_ee_ + ee)*3);
+  }
+  return state;
+}
+
+int
+TrajectoryFile::FindState (double t) const
+{
+  int k;
+  if (IsUniformlySampled()) {
+    double index = std::floor((t - GetStartTime())/dt_);
+    k = std::min(std::max(index, 0.0), n_states_-1.0);
+    // correct for rounding of the stored times
+    while (k > 0 && GetTime(k) > t)
+      k--;
+    while (k+1 < n_states_ && GetTime(k+1) <= t)
+      k++;
+  }
+  else {
+    int n_blocks = (n_states_ + block_size_ - 1)/block_size_;
+    int block = std::upper_bound(block_t_start_, block_t_start_+n_blocks, t) - block_t_start_;
+    block = std::max(block-1, 0);
+
+    int first = block*block_size_;
+    int n = std::min(block_size_, n_states_ - first);
+    int i;
+    const double* times = GetColumn<double>(first, 0, i);
+    k = first + std::max(int(std::upper_bound(times, times+n, t) - times) - 1, 0);
+  }
+  return k;
+}
+
+} /* namespace xpp */
@@ -0,0 +1,246 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_states/trajectory_index.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace xpp {
+
+static const double kInf = std::numeric_limits<double>::infinity();
+static const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+TrajectoryIndex::TrajectoryIndex (const States& states,
+                                  const std::map<std::string, Channel>& channels)
+{
+  for (const auto& s : states)
+    times_.push_back(s.t_global_);
+
+  // the ranges are found by binary search over the times
+  if (!std::is_sorted(times_.begin(), times_.end()))
+    throw std::invalid_argument("xpp::TrajectoryIndex: states not ordered by time");
+
+  int n = times_.size();
+  size_ = 1;
+  while (size_ < n)
+    size_ *= 2;
+
+  for (const auto& c : channels) {
+    // leaves without a sample never affect a result
+    Tree& tree = trees_[c.first];
+    tree.min.assign(2*size_,  kInf);
+    tree.max.assign(2*size_, -kInf);
+    tree.sum.assign(2*size_,  0.0);
+
+    for (int k=0; k<n; ++k) {
+      double value = c.second(states.at(k));
+      tree.min.at(size_+k) = tree.max.at(size_+k) = tree.sum.at(size_+k) = value;
+    }
+
+    for (int node=size_-1; node>0; --node) {
+      tree.min.at(node) = std::min(tree.min.at(2*node), tree.min.at(2*node+1));
+      tree.max.at(node) = std::max(tree.max.at(2*node), tree.max.at(2*node+1));
+      tree.sum.at(node) = tree.sum.at(2*node) + tree.sum.at(2*node+1);
+    }
+  }
+}
+
+std::map<std::string, TrajectoryIndex::Channel>
+TrajectoryIndex::GetDefaultChannels (int n_ee)
+{
+  std::map<std::string, Channel> channels;
+  channels["base_z"]   = BasePos(Z);
+  channels["contacts"] = ContactCount();
+  for (int ee=0; ee<n_ee; ++ee)
+    channels["ee" + std::to_string(ee) + "_fz"] = EEForce(ee, Z);
+  return channels;
+}
+
+TrajectoryIndex::Channel
+TrajectoryIndex::BasePos (int dim)
+{
+  return [dim](const RobotStateCartesian& s) { return s.base_.lin.p_(dim); };
+}
+
+TrajectoryIndex::Channel
+TrajectoryIndex::EEPos (EndeffectorID ee, int dim)
+{
+  return [ee, dim](const RobotStateCartesian& s) { return s.ee_motion_.at(ee).p_(dim); };
+}
+
+TrajectoryIndex::Channel
+TrajectoryIndex::EEForce (EndeffectorID ee, int dim)
+{
+  return [ee, dim](const RobotStateCartesian& s) { return s.ee_forces_.at(ee)(dim); };
+}
+
+TrajectoryIndex::Channel
+TrajectoryIndex::ContactCount ()
+{
+  return [](const RobotStateCartesian& s) { return double(s.ee_contact_.GetContactCount()); };
+}
+
+const TrajectoryIndex::Tree&
+TrajectoryIndex::GetTree (const std::string& channel) const
+{
+  auto it = trees_.find(channel);
+  if (it == trees_.end())
+    throw std::invalid_argument("xpp::TrajectoryIndex: no channel " + channel);
+  return it->second;
+}
+
+std::pair<int,int>
+TrajectoryIndex::GetRange (double t0, double t1) const
+{
+  int begin = std::lower_bound(times_.begin(), times_.end(), t0) - times_.begin();
+  int end   = std::upper_bound(times_.begin(), times_.end(), t1) - times_.begin();
+  return {begin, std::max(begin, end)};
+}
+
+// combines the nodes covering the leaves [begin, end) bottom-up.
+template<typename Op>
+static double
+Reduce (const std::vector<double>& tree, int size, int begin, int end,
+        double value, Op op)
+{
+  for (int l=begin+size, r=end+size; l<r; l/=2, r/=2) {
+    if (l%2) value = op(value, tree[l++]);
+    if (r%2) value = op(value, tree[--r]);
+  }
+  return value;
+}
+
+double
+TrajectoryIndex::Min (const std::string& channel, double t0, double t1) const
+{
+  auto range = GetRange(t0, t1);
+  return Reduce(GetTree(channel).min, size_, range.first, range.second, kInf,
+                [](double a, double b) { return std::min(a,b); });
+}
+
+double
+TrajectoryIndex::Max (const std::string& channel, double t0, double t1) const
+{
+  auto range = GetRange(t0, t1);
+  return Reduce(GetTree(channel).max, size_, range.first, range.second, -kInf,
+                [](double a, double b) { return std::max(a,b); });
+}
+
+double
+TrajectoryIndex::Sum (const std::string& channel, double t0, double t1) const
+{
+  auto range = GetRange(t0, t1);
+  return Reduce(GetTree(channel).sum, size_, range.first, range.second, 0.0,
+                [](double a, double b) { return a+b; });
+}
+
+double
+TrajectoryIndex::Mean (const std::string& channel, double t0, double t1) const
+{
+  auto range = GetRange(t0, t1);
+  int n = range.second - range.first;
+  return n > 0? Sum(channel, t0, t1)/n : kNaN;
+}
+
+// the first leaf >= begin in the subtree of node, which covers the leaves
+// [lo, hi), for which the node value fulfills pred. Subtrees that don't
+// fulfill it are skipped entirely.
+template<typename Pred>
+static int
+FindFirst (const std::vector<double>& tree, int node, int lo, int hi,
+           int begin, Pred pred)
+{
+  if (hi <= begin || !pred(tree[node]))
+    return -1;
+  if (hi - lo == 1)
+    return lo;
+
+  int mid = (lo + hi)/2;
+  int k = FindFirst(tree, 2*node, lo, mid, begin, pred);
+  return k >= 0? k : FindFirst(tree, 2*node+1, mid, hi, begin, pred);
+}
+
+int
+TrajectoryIndex::FindFirstBelow (const Tree& tree, int begin, double value) const
+{
+  return FindFirst(tree.min, 1, 0, size_, begin,
+                   [value](double min) { return min < value; });
+}
+
+int
+TrajectoryIndex::FindFirstNotBelow (const Tree& tree, int begin, double value) const
+{
+  // the padding leaves are -inf, so results beyond the samples are dropped
+  int k = FindFirst(tree.max, 1, 0, size_, begin,
+                    [value](double max) { return max >= value; });
+  return k < int(times_.size())? k : -1;
+}
+
+double
+TrajectoryIndex::FindFirstBelow (const std::string& channel, double t0,
+                                 double value) const
+{
+  int k = FindFirstBelow(GetTree(channel), GetRange(t0, t0).first, value);
+  return k >= 0? times_.at(k) : kInf;
+}
+
+double
+TrajectoryIndex::FindFirstAbove (const std::string& channel, double t0,
+                                 double value) const
+{
+  int k = FindFirst(GetTree(channel).max, 1, 0, size_, GetRange(t0, t0).first,
+                    [value](double max) { return max > value; });
+  return k >= 0? times_.at(k) : kInf;
+}
+
+std::vector<TrajectoryIndex::Window>
+TrajectoryIndex::FindWindowsBelow (const std::string& channel, double value) const
+{
+  const Tree& tree = GetTree(channel);
+
+  std::vector<Window> windows;
+  int k = 0;
+  while (true) {
+    int first = FindFirstBelow(tree, k, value);
+    if (first < 0)
+      break;
+
+    int end = FindFirstNotBelow(tree, first, value);
+    if (end < 0)
+      end = times_.size();
+
+    windows.push_back({times_.at(first), times_.at(end-1)});
+    k = end;
+  }
+  return windows;
+}
+
+} /* namespace xpp */
@@ -0,0 +1,216 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_states/trajectory_interpolator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace xpp {
+
+// relative deviation of sample times up to which sampling counts as uniform.
+static constexpr double kUniformTolerance = 1e-6;
+
+/**
+ * The quintic polynomial that matches position, velocity and acceleration of
+ * a linear state at the start (0) and end (dt) of a sample interval.
+ */
+static StateLin3d
+InterpolateHermite(const StateLin3d& s0, const StateLin3d& s1, double dt, double tau)
+{
+  if (dt <= 0.0)
+    return s0;
+
+  const double T1 = dt, T2 = T1*dt, T3 = T2*dt, T4 = T3*dt, T5 = T4*dt;
+  Vector3d dp = s1.p_ - s0.p_;
+
+  Vector3d c0 = s0.p_;
+  Vector3d c1 = s0.v_;
+  Vector3d c2 = 0.5*s0.a_;
+  Vector3d c3 = (20*dp - (8*s1.v_ + 12*s0.v_)*T1 - (3*s0.a_ - s1.a_)*T2)/(2*T3);
+  Vector3d c4 = (-30*dp + (14*s1.v_ + 16*s0.v_)*T1 + (3*s0.a_ - 2*s1.a_)*T2)/(2*T4);
+  Vector3d c5 = (12*dp - 6*(s1.v_ + s0.v_)*T1 - (s0.a_ - s1.a_)*T2)/(2*T5);
+
+  const double t1 = tau, t2 = t1*tau, t3 = t2*tau, t4 = t3*tau, t5 = t4*tau;
+
+  StateLin3d s;
+  s.p_ = c0 + c1*t1 + c2*t2 + c3*t3 + c4*t4 + c5*t5;
+  s.v_ = c1 + 2*c2*t1 + 3*c3*t2 + 4*c4*t3 + 5*c5*t4;
+  s.a_ = 2*c2 + 6*c3*t1 + 12*c4*t2 + 20*c5*t3;
+  return s;
+}
+
+TrajectoryInterpolator::TrajectoryInterpolator (const std::vector<RobotStateCartesian>& states)
+    : TrajectoryInterpolator(CartesianTrajectory(states))
+{
+}
+
+TrajectoryInterpolator::TrajectoryInterpolator (const CartesianTrajectory& trajectory)
+    : traj_(trajectory)
+{
+  if (traj_.empty())
+    throw std::invalid_argument("xpp::TrajectoryInterpolator: no states");
+  CheckUniformSampling();
+}
+
+void
+TrajectoryInterpolator::CheckUniformSampling ()
+{
+  dt_ = 0.0;
+
+  int n = traj_.size();
+  if (n < 2)
+    return;
+
+  const auto& t = traj_.t_global_;
+  double dt = (t.back() - t.front())/(n-1);
+  if (dt <= 0.0)
+    return;
+
+  for (int k=1; k<n; ++k)
+    if (std::abs(t[k] - (t.front() + k*dt)) > kUniformTolerance*dt)
+      return;
+
+  dt_ = dt;
+}
+
+double
+TrajectoryInterpolator::GetStartTime () const
+{
+  return traj_.t_global_.front();
+}
+
+double
+TrajectoryInterpolator::GetEndTime () const
+{
+  return traj_.t_global_.back();
+}
+
+int
+TrajectoryInterpolator::FindSample (double t) const
+{
+  const auto& times = traj_.t_global_;
+  int k;
+
+  if (IsUniformlySampled()) {
+    k = std::floor((t - times.front())/dt_);
+    k = std::max(0, std::min(k, traj_.size()-1));
+    // correct for rounding of the division
+    if (k+1 < traj_.size() && times[k+1] <= t)
+      k++;
+    else if (k > 0 && times[k] > t)
+      k--;
+  } else {
+    auto it = std::upper_bound(times.begin(), times.end(), t);
+    k = std::max(0, static_cast<int>(it - times.begin()) - 1);
+  }
+
+  return k;
+}
+
+int
+TrajectoryInterpolator::FindSampleFrom (int k, double t) const
+{
+  const auto& times = traj_.t_global_;
+  if (k >= traj_.size() || times[k] > t)
+    return FindSample(t); // time went backwards
+
+  // usually only the next few samples have to be checked
+  static constexpr int kMaxLinearSteps = 8;
+  for (int i=0; i<kMaxLinearSteps; ++i) {
+    if (k+1 >= traj_.size() || times[k+1] > t)
+      return k;
+    k++;
+  }
+
+  return FindSample(t);
+}
+
+RobotStateCartesian
+TrajectoryInterpolator::Interpolate (int k, double t) const
+{
+  const auto& times = traj_.t_global_;
+  auto s0 = traj_.at(k);
+
+  // on a sample or outside the trajectory
+  if (t <= times[k] || k+1 >= traj_.size())
+    return s0.ToState();
+
+  auto s1 = traj_.at(k+1);
+  double dt  = times[k+1] - times[k];
+  double tau = t - times[k];
+  double alpha = tau/dt;
+
+  RobotStateCartesian state(traj_.GetEECount());
+  state.t_global_ = t;
+
+  State3d b0 = s0.base();
+  State3d b1 = s1.base();
+  state.base_.lin   = InterpolateHermite(b0.lin, b1.lin, dt, tau);
+  state.base_.ang.q  = b0.ang.q.slerp(alpha, b1.ang.q);
+  state.base_.ang.w  = (1-alpha)*b0.ang.w  + alpha*b1.ang.w;
+  state.base_.ang.wd = (1-alpha)*b0.ang.wd + alpha*b1.ang.wd;
+
+  for (auto ee : state.ee_motion_.GetEEsOrdered()) {
+    state.ee_motion_.at(ee) = InterpolateHermite(s0.ee_motion(ee), s1.ee_motion(ee), dt, tau);
+    state.ee_forces_.at(ee) = (1-alpha)*s0.ee_forces(ee) + alpha*s1.ee_forces(ee);
+  }
+  state.ee_contact_ = s0.ee_contact();
+
+  return state;
+}
+
+RobotStateCartesian
+TrajectoryInterpolator::At (double t) const
+{
+  return Interpolate(FindSample(t), t);
+}
+
+std::vector<RobotStateCartesian>
+TrajectoryInterpolator::At (const std::vector<double>& times) const
+{
+  std::vector<RobotStateCartesian> states;
+  states.reserve(times.size());
+
+  Cursor cursor = GetCursor();
+  for (double t : times)
+    states.push_back(cursor.At(t));
+
+  return states;
+}
+
+RobotStateCartesian
+TrajectoryInterpolator::Cursor::At (double t)
+{
+  k_ = interpolator_.FindSampleFrom(k_, t);
+  return interpolator_.Interpolate(k_, t);
+}
+
+} /* namespace xpp */
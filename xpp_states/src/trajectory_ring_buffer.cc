@@ -0,0 +1,263 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_states/trajectory_ring_buffer.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace xpp {
+
+// states closer in time than this are considered at the same time.
+static constexpr double kTimeEps = 1e-6;
+
+constexpr int TrajectoryRingBuffer::kSlotSize;
+
+TrajectoryRingBuffer::TrajectoryRingBuffer (int capacity)
+    : slots_(std::max(capacity, 0)*kSlotSize),
+      capacity_(capacity), head_(0), size_(0), seq_(0)
+{
+  if (capacity <= 0)
+    throw std::invalid_argument("xpp::TrajectoryRingBuffer: capacity must be positive");
+}
+
+std::atomic<double>*
+TrajectoryRingBuffer::Slot (int slot)
+{
+  return &slots_[slot*kSlotSize];
+}
+
+const std::atomic<double>*
+TrajectoryRingBuffer::Slot (int slot) const
+{
+  return &slots_[slot*kSlotSize];
+}
+
+double
+TrajectoryRingBuffer::GetTime (int slot) const
+{
+  return Slot(slot)[0].load(std::memory_order_relaxed);
+}
+
+void
+TrajectoryRingBuffer::Store (int slot, const RobotStateCartesian& state)
+{
+  std::atomic<double>* v = Slot(slot);
+  auto store = [&v](double value) { (v++)->store(value, std::memory_order_relaxed); };
+  auto store_vec = [&store](const Vector3d& vec) { for (int i=0; i<3; ++i) store(vec(i)); };
+
+  store(state.t_global_);
+  store(state.ee_motion_.GetEECount());
+  store(state.ee_contact_.GetEECount());
+  store(state.ee_contact_.GetMask());
+
+  store_vec(state.base_.lin.p_);
+  store_vec(state.base_.lin.v_);
+  store_vec(state.base_.lin.a_);
+  for (int i=0; i<4; ++i)
+    store(state.base_.ang.q.coeffs()(i));
+  store_vec(state.base_.ang.w);
+  store_vec(state.base_.ang.wd);
+
+  for (auto ee : state.ee_motion_.GetEEsOrdered()) {
+    store_vec(state.ee_motion_.at(ee).p_);
+    store_vec(state.ee_motion_.at(ee).v_);
+    store_vec(state.ee_motion_.at(ee).a_);
+    store_vec(state.ee_forces_.at(ee));
+  }
+}
+
+void
+TrajectoryRingBuffer::CheckState (const RobotStateCartesian& state)
+{
+  int n_ee = state.ee_motion_.GetEECount();
+  if (n_ee > kMaxEndeffectors)
+    throw std::length_error("xpp::TrajectoryRingBuffer: too many endeffectors");
+  if (state.ee_forces_.GetEECount() != n_ee || state.ee_contact_.GetEECount() != n_ee)
+    throw std::invalid_argument("xpp::TrajectoryRingBuffer: inconsistent endeffector count");
+}
+
+void
+TrajectoryRingBuffer::Load (int slot, RobotStateCartesian& state) const
+{
+  const std::atomic<double>* v = Slot(slot);
+  auto load = [&v]() { return (v++)->load(std::memory_order_relaxed); };
+  auto load_vec = [&load](Vector3d& vec) { for (int i=0; i<3; ++i) vec(i) = load(); };
+
+  state.t_global_ = load();
+  int n_ee = load();
+  int n_contact = load();
+  auto mask = static_cast<EndeffectorsContact::Mask>(load());
+  state.ee_motion_.SetCount(n_ee);
+  state.ee_forces_.SetCount(n_ee);
+  state.ee_contact_ = EndeffectorsContact::FromMask(n_contact, mask);
+
+  load_vec(state.base_.lin.p_);
+  load_vec(state.base_.lin.v_);
+  load_vec(state.base_.lin.a_);
+  for (int i=0; i<4; ++i)
+    state.base_.ang.q.coeffs()(i) = load();
+  load_vec(state.base_.ang.w);
+  load_vec(state.base_.ang.wd);
+
+  for (auto ee : state.ee_motion_.GetEEsOrdered()) {
+    load_vec(state.ee_motion_.at(ee).p_);
+    load_vec(state.ee_motion_.at(ee).v_);
+    load_vec(state.ee_motion_.at(ee).a_);
+    load_vec(state.ee_forces_.at(ee));
+  }
+}
+
+int
+TrajectoryRingBuffer::CountBefore (int head, int size, double t) const
+{
+  // binary search over the ring, starting at head
+  int lo = 0, hi = size;
+  while (lo < hi) {
+    int mid = (lo+hi)/2;
+    if (GetTime((head+mid) % capacity_) < t - kTimeEps)
+      lo = mid+1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+void
+TrajectoryRingBuffer::BeginWrite ()
+{
+  seq_.store(seq_.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void
+TrajectoryRingBuffer::EndWrite ()
+{
+  seq_.store(seq_.load(std::memory_order_relaxed)+1, std::memory_order_release);
+}
+
+template<typename Fn>
+void
+TrajectoryRingBuffer::Read (const Fn& read) const
+{
+  uint64_t seq_start, seq_end;
+  bool retry = false;
+  do {
+    if (retry)
+      std::this_thread::yield(); // let the writer finish
+    retry = true;
+
+    seq_start = seq_.load(std::memory_order_acquire);
+    if (seq_start % 2 == 1)
+      continue; // writer busy
+
+    int head = head_.load(std::memory_order_relaxed);
+    int size = std::min(size_.load(std::memory_order_relaxed), capacity_);
+    read(head, size);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    seq_end = seq_.load(std::memory_order_relaxed);
+  } while (seq_start % 2 == 1 || seq_start != seq_end);
+}
+
+void
+TrajectoryRingBuffer::Merge (const States& plan)
+{
+  if (plan.empty())
+    return;
+
+  // a throw between BeginWrite() and EndWrite() would block all readers
+  int n_plan = std::min<int>(plan.size(), capacity_);
+  for (int i=0; i<n_plan; ++i)
+    CheckState(plan[i]);
+
+  BeginWrite();
+
+  // overwrite everything from the start of the plan
+  int head = head_.load(std::memory_order_relaxed);
+  int n_keep = CountBefore(head, size(), plan.front().t_global_);
+
+  // drop the oldest states if the plan doesn't fit behind them. Of a plan
+  // longer than the buffer only the start is kept, as it is needed first.
+  int n_drop = std::max(0, n_keep + n_plan - capacity_);
+  head = (head + n_drop) % capacity_;
+  head_.store(head, std::memory_order_relaxed);
+  n_keep -= n_drop;
+
+  for (int i=0; i<n_plan; ++i)
+    Store((head+n_keep+i) % capacity_, plan[i]);
+
+  size_.store(n_keep+n_plan, std::memory_order_relaxed);
+  EndWrite();
+}
+
+void
+TrajectoryRingBuffer::EvictBefore (double t)
+{
+  int n_evict = CountBefore(head_.load(std::memory_order_relaxed), size(), t);
+  if (n_evict == 0)
+    return;
+
+  BeginWrite();
+  head_.store((head_.load(std::memory_order_relaxed) + n_evict) % capacity_,
+              std::memory_order_relaxed);
+  size_.store(size() - n_evict, std::memory_order_relaxed);
+  EndWrite();
+}
+
+bool
+TrajectoryRingBuffer::GetState (double t, RobotStateCartesian& state) const
+{
+  bool found = false;
+  Read([&](int head, int size) {
+    found = size > 0;
+    if (!found)
+      return;
+
+    // the last state with t_k <= t
+    int k = CountBefore(head, size, t);
+    if (k == size || GetTime((head+k) % capacity_) > t + kTimeEps)
+      k = std::max(0, k-1);
+    Load((head+k) % capacity_, state);
+  });
+  return found;
+}
+
+void
+TrajectoryRingBuffer::GetStates (States& states) const
+{
+  Read([&](int head, int size) {
+    states.resize(size, RobotStateCartesian(0));
+    for (int i=0; i<size; ++i)
+      Load((head+i) % capacity_, states[i]);
+  });
+}
+
+} /* namespace xpp */
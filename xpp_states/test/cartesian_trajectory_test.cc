@@ -0,0 +1,113 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <xpp_states/cartesian_trajectory.h>
+
+using namespace xpp;
+
+static std::vector<RobotStateCartesian>
+BuildStates (int n_states, int n_ee)
+{
+  std::vector<RobotStateCartesian> states;
+  for (int k=0; k<n_states; ++k) {
+    RobotStateCartesian state(n_ee);
+    state.t_global_ = 0.01*k;
+    state.base_.lin.p_ << k, 0.0, 0.5;
+    state.base_.ang.q = GetQuaternionFromEulerZYX(0.1*k, 0.0, 0.0);
+    for (auto ee : state.ee_motion_.GetEEsOrdered()) {
+      state.ee_motion_.at(ee).p_ << ee, k, 0.0;
+      state.ee_motion_.at(ee).v_ << 0.0, 1.0, 0.0;
+      state.ee_forces_.at(ee) << 0.0, 0.0, 10.0*k + ee;
+      state.ee_contact_.at(ee) = (k+ee)%2;
+    }
+    states.push_back(state);
+  }
+  return states;
+}
+
+TEST(CartesianTrajectory, RoundTrip)
+{
+  auto states = BuildStates(20, 4);
+  CartesianTrajectory traj(states);
+
+  ASSERT_EQ(states.size(), traj.size());
+  ASSERT_EQ(4, traj.GetEECount());
+
+  auto back = traj.ToStates();
+  for (int k=0; k<traj.size(); ++k) {
+    EXPECT_DOUBLE_EQ(states.at(k).t_global_, back.at(k).t_global_);
+    EXPECT_EQ(states.at(k).base_.lin, back.at(k).base_.lin);
+    EXPECT_TRUE(states.at(k).base_.ang.q.isApprox(back.at(k).base_.ang.q));
+    EXPECT_FALSE(states.at(k).ee_motion_ != back.at(k).ee_motion_);
+    EXPECT_FALSE(states.at(k).ee_forces_ != back.at(k).ee_forces_);
+    EXPECT_FALSE(states.at(k).ee_contact_ != back.at(k).ee_contact_);
+  }
+}
+
+TEST(CartesianTrajectory, RejectsDifferentEECount)
+{
+  auto states = BuildStates(3, 2);
+  CartesianTrajectory traj(states);
+
+  RobotStateCartesian state(3);
+  EXPECT_THROW(traj.SetState(1, state), std::invalid_argument);
+  EXPECT_THROW(traj.PushBack(state), std::invalid_argument);
+  EXPECT_EQ(3, traj.size());
+
+  states.push_back(state);
+  EXPECT_THROW(CartesianTrajectory{states}, std::invalid_argument);
+}
+
+TEST(CartesianTrajectory, ChannelsAreContiguous)
+{
+  auto states = BuildStates(50, 2);
+  CartesianTrajectory traj(states);
+
+  auto fz = traj.GetEEForce(1, Z);
+  ASSERT_EQ(50, fz.size());
+  EXPECT_DOUBLE_EQ(10.0*49 + 1, fz.maxCoeff());
+  EXPECT_EQ(&traj.ee_forces_.at(1).at(Z).front(), fz.data());
+
+  EXPECT_DOUBLE_EQ(0.5, traj.at(7).base().lin.p_.z());
+  EXPECT_DOUBLE_EQ(7.0, traj[7].ee_motion(1).p_.y());
+  EXPECT_EQ(states.at(7).ee_contact_.at(0), traj[7].ee_contact(0));
+}
+
+TEST(CartesianTrajectory, PushBackInitializesOrientation)
+{
+  CartesianTrajectory traj(1);
+  traj.Resize(3);
+  EXPECT_DOUBLE_EQ(1.0, traj.at(2).base().ang.q.w());
+
+  traj.PushBack(BuildStates(1, 1).front());
+  EXPECT_EQ(4, traj.size());
+  EXPECT_DOUBLE_EQ(1.0, traj.at(0).base().ang.q.w());
+}
@@ -0,0 +1,129 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+#include <xpp_states/contact_schedule.h>
+
+using namespace xpp;
+
+// trot: ee 0 and 3 swing during [0.5,1), ee 1 and 2 during [1,1.5),
+// repeated, ee 4 never touches the ground.
+static ContactSchedule::States
+Trot ()
+{
+  ContactSchedule::States states;
+  for (int k=0; k<300; ++k) {
+    double t = 0.01*k;
+    RobotStateCartesian state(5);
+    state.t_global_ = t;
+    double phase = std::fmod(t, 1.0);
+    bool first_pair_swings = t >= 0.5 && phase >= 0.5 - 1e-9;
+    bool second_pair_swings = t >= 1.0 && phase < 0.5 - 1e-9;
+    state.ee_contact_.at(0) = state.ee_contact_.at(3) = !first_pair_swings;
+    state.ee_contact_.at(1) = state.ee_contact_.at(2) = !second_pair_swings;
+    state.ee_contact_.at(4) = false;
+    states.push_back(state);
+  }
+  return states;
+}
+
+TEST(ContactSchedule, ContactsMatchStates)
+{
+  auto states = Trot();
+  ContactSchedule schedule(states);
+
+  EXPECT_EQ(5, schedule.GetEECount());
+  for (const auto& s : states)
+    EXPECT_EQ(s.ee_contact_, schedule.GetContacts(s.t_global_)) << s.t_global_;
+
+  // clamped outside
+  EXPECT_TRUE(schedule.IsInContact(0, -1.0));
+  EXPECT_THROW(schedule.IsInContact(5, 0.0), std::out_of_range);
+}
+
+TEST(ContactSchedule, DifferentEECount)
+{
+  auto states = Trot();
+  states.at(10) = RobotStateCartesian(6);
+  EXPECT_THROW(ContactSchedule{states}, std::invalid_argument);
+
+  states = Trot();
+  states.at(10) = RobotStateCartesian(4);
+  EXPECT_THROW(ContactSchedule{states}, std::invalid_argument);
+
+  EXPECT_THROW(ContactSchedule{ContactSchedule::States()}, std::invalid_argument);
+}
+
+TEST(ContactSchedule, NextTouchdownAndLiftoff)
+{
+  ContactSchedule schedule(Trot());
+
+  EXPECT_NEAR(1.0, schedule.GetNextTouchdown(0, 0.7), 1e-9);
+  EXPECT_NEAR(1.0, schedule.GetNextTouchdown(0, 0.2), 1e-9); // after next liftoff
+  EXPECT_NEAR(0.5, schedule.GetNextLiftoff(0, 0.2), 1e-9);
+  EXPECT_NEAR(1.5, schedule.GetNextLiftoff(0, 0.7), 1e-9);
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), schedule.GetNextTouchdown(4, 0.0));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), schedule.GetNextLiftoff(1, 2.6));
+}
+
+TEST(ContactSchedule, PhasesAndStatistics)
+{
+  ContactSchedule schedule(Trot());
+
+  auto phases = schedule.GetPhases(1);
+  ASSERT_EQ(5, phases.size()); // stance, swing, stance, swing, stance
+  EXPECT_TRUE(phases.at(0).contact);
+  EXPECT_NEAR(1.0, phases.at(0).GetDuration(), 1e-9);
+  EXPECT_FALSE(phases.at(3).contact);
+  EXPECT_NEAR(2.0, phases.at(3).t_start, 1e-9);
+  EXPECT_NEAR(2.99, phases.at(4).t_end, 1e-9);
+
+  auto phase = schedule.GetPhase(0, 0.7);
+  EXPECT_FALSE(phase.contact);
+  EXPECT_NEAR(0.5, phase.t_start, 1e-9);
+  EXPECT_NEAR(1.0, phase.t_end, 1e-9);
+
+  auto swing = schedule.GetPhaseStats(0, false);
+  EXPECT_EQ(3, swing.count);
+  EXPECT_NEAR(0.49, swing.min, 1e-9); // ends with the trajectory
+  EXPECT_NEAR(0.5,  swing.max, 1e-9);
+  auto stance = schedule.GetPhaseStats(0, true);
+  EXPECT_EQ(3, stance.count);
+  EXPECT_NEAR(0.5, stance.min, 1e-9);
+  EXPECT_NEAR(0.5, stance.max, 1e-9);
+
+  EXPECT_NEAR(1.5/2.99, schedule.GetDutyFactor(0), 1e-9);
+  EXPECT_NEAR(0.0, schedule.GetDutyFactor(4), 1e-9);
+  EXPECT_NEAR(1.0, schedule.GetDutyFactor(1, 0.0, 1.0), 1e-9);
+  EXPECT_NEAR(0.5, schedule.GetDutyFactor(0, 0.25, 0.75), 1e-9);
+}
@@ -0,0 +1,123 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <deque>
+
+#include <gtest/gtest.h>
+
+#include <xpp_states/endeffectors.h>
+
+using namespace xpp;
+
+TEST(Endeffectors, InlineStorage)
+{
+  Endeffectors<double> values(3);
+  values.SetAll(1.0);
+  EXPECT_EQ(3, values.GetEECount());
+
+  // grown elements are value initialized
+  values.SetCount(1);
+  values.SetCount(3);
+  EXPECT_EQ(0.0, values.at(1));
+
+  // also fixed-size Eigen types, which T() leaves uninitialized
+  Endeffectors<Vector3d> forces(4);
+  EXPECT_EQ(Vector3d::Zero(), forces.at(3));
+
+  EXPECT_THROW(values.at(3), std::out_of_range);
+  EXPECT_THROW(values.SetCount(kMaxEndeffectors+1), std::length_error);
+}
+
+TEST(EndeffectorsContact, Bitmask)
+{
+  EndeffectorsContact contact(3);
+  EXPECT_EQ(0, contact.GetContactCount());
+
+  contact.at(1) = true;
+  contact.at(2) = contact.at(1);
+  EXPECT_EQ(2, contact.GetContactCount());
+  EXPECT_EQ(0b110u, contact.GetMask());
+  EXPECT_FALSE(contact.at(0));
+
+  // removed endeffectors are not in contact when added again
+  contact.SetCount(1);
+  contact.SetCount(3);
+  EXPECT_EQ(0, contact.GetContactCount());
+
+  EXPECT_THROW(contact.at(3), std::out_of_range);
+  EXPECT_EQ(4, EndeffectorsContact(4, true).GetContactCount());
+}
+
+TEST(EndeffectorsContact, GaitEvents)
+{
+  using quad = EndeffectorsContact;
+  auto prev = quad::FromMask(4, 0b0011);
+  auto curr = quad::FromMask(4, 0b0110);
+
+  EXPECT_EQ(0b0100u, quad::GetTouchdowns(prev, curr).GetMask());
+  EXPECT_EQ(0b0001u, quad::GetLiftoffs(prev, curr).GetMask());
+  EXPECT_EQ(0b1001u, (~curr).GetMask()); // only valid endeffectors
+  EXPECT_TRUE(prev != curr);
+}
+
+TEST(Endeffectors, Range)
+{
+  EndeffectorsPos pos(4);
+  std::vector<EndeffectorID> ids;
+  for (auto ee : pos.GetEEsOrdered())
+    ids.push_back(ee);
+
+  std::vector<EndeffectorID> expected = pos.GetEEsOrdered();
+  EXPECT_EQ(expected, ids);
+  EXPECT_EQ(std::vector<EndeffectorID>({0,1,2,3}), ids);
+}
+
+TEST(Endeffectors, Operators)
+{
+  EndeffectorsPos a(2), b(2);
+  a.SetAll(Vector3d(2.0, 4.0, 6.0));
+  b.SetAll(Vector3d::Ones());
+
+  EndeffectorsPos diff = (a-b)/2.0;
+  EXPECT_EQ(Vector3d(0.5, 1.5, 2.5), diff.at(1));
+  EXPECT_TRUE(a != b);
+  EXPECT_FALSE(a != a);
+
+  auto impl = a.ToImpl();
+  impl.resize(3, impl.front());
+  EXPECT_EQ(a.at(0), impl.at(2));
+}
+
+TEST(Endeffectors, DequeStoragePolicy)
+{
+  Endeffectors<int, std::deque<int>> many(3*kMaxEndeffectors);
+  many.SetAll(1);
+  EXPECT_EQ(3*kMaxEndeffectors, many.GetEECount());
+  EXPECT_EQ(1, many.at(3*kMaxEndeffectors-1));
+}
@@ -0,0 +1,97 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include <xpp_states/foothold_map.h>
+
+using namespace xpp;
+
+TEST(FootholdMap, DeduplicatesStanceStates)
+{
+  FootholdMap map(0.02);
+
+  // two feet standing for a while, then the second steps 0.3m forward
+  for (int k=0; k<200; ++k) {
+    RobotStateCartesian state(2);
+    state.t_global_ = 0.01*k;
+    bool stepped = k >= 100;
+    state.ee_motion_.at(0).p_ << 0.0, 0.2, 0.0;
+    state.ee_motion_.at(1).p_ << (stepped? 0.3 : 0.0) + 0.001*std::sin(k), -0.2, 0.0;
+    state.ee_contact_.at(0) = true;
+    state.ee_contact_.at(1) = k < 90 || stepped;
+    map.Add(state);
+  }
+
+  ASSERT_EQ(3, map.GetCount());
+  EXPECT_EQ(1, map.at(2).ee);
+  EXPECT_DOUBLE_EQ(1.0, map.at(2).t);
+  EXPECT_FALSE(map.Add(Vector3d(0.01, 0.2, 0.0), 1, 3.0));
+  EXPECT_TRUE(map.Add(Vector3d(0.03, 0.2, 0.0), 1, 3.0));
+
+  // positions and contacts passed directly, e.g. read from a message view
+  EndeffectorsPos pos(2);
+  pos.at(0) << 0.0, 0.2, 0.0;
+  pos.at(1) << 0.5, -0.2, 0.0;
+  EXPECT_EQ(1, map.Add(pos, EndeffectorsContact(2, true), 4.0));
+  EXPECT_EQ(0, map.Add(pos, EndeffectorsContact(2, true), 4.1));
+
+  map.Clear();
+  EXPECT_EQ(0, map.GetCount());
+}
+
+TEST(FootholdMap, QueriesMatchScan)
+{
+  FootholdMap map(0.05);
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> coord(-5.0, 5.0);
+  for (int i=0; i<2000; ++i)
+    map.Add(Vector3d(coord(gen), coord(gen), 0.1*coord(gen)), i%4, i);
+
+  for (int q=0; q<50; ++q) {
+    Vector3d center(coord(gen), coord(gen), 0.0);
+    double radius = q < 45? 0.5 : 20.0;
+    Vector3d min = center - Vector3d(0.3, 0.6, 1.0);
+    Vector3d max = center + Vector3d(0.5, 0.2, 1.0);
+
+    std::vector<int> in_radius, in_box;
+    for (int i=0; i<map.GetCount(); ++i) {
+      const Vector3d& p = map.at(i).pos;
+      if ((p-center).norm() <= radius)
+        in_radius.push_back(i);
+      if ((p.array() >= min.array()).all() && (p.array() <= max.array()).all())
+        in_box.push_back(i);
+    }
+
+    EXPECT_EQ(in_radius, map.FindInRadius(center, radius));
+    EXPECT_EQ(in_box, map.FindInBox(min, max));
+  }
+}
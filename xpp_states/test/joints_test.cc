@@ -0,0 +1,93 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <xpp_states/joints.h>
+
+using namespace xpp;
+
+TEST(Joints, ContiguousStorage)
+{
+  Joints q(2, 3);
+  q.at(1) = Eigen::Vector3d(4.0, 5.0, 6.0);
+  q.GetJoint(0) = 1.0;
+
+  const VectorXd& vec = q.ToVec();
+  EXPECT_EQ(6, vec.rows());
+  EXPECT_EQ(1.0, vec(0));
+  EXPECT_EQ(5.0, vec(4));
+  EXPECT_EQ(&q.GetJoint(3), vec.data()+3);
+
+  const Joints& q_const = q;
+  EXPECT_EQ(5.0, q_const.GetJoint(4));
+  EXPECT_EQ(Eigen::Vector3d(4.0, 5.0, 6.0), q_const.at(1));
+  EXPECT_EQ(q_const.at(1), q_const[1]);
+
+  EXPECT_THROW(q.at(2), std::out_of_range);
+  EXPECT_THROW(q_const.at(2), std::out_of_range);
+  EXPECT_THROW(q.GetJoint(6), std::out_of_range);
+  EXPECT_THROW(q_const.GetJoint(6), std::out_of_range);
+}
+
+TEST(Joints, Order)
+{
+  Joints q({Eigen::Vector2d(0.0, 1.0),
+            Eigen::Vector2d(2.0, 3.0),
+            Eigen::Vector2d(4.0, 5.0)});
+
+  Joints::EEOrder order = {2, 0, 1};
+  VectorXd expected(6);
+  expected << 4.0, 5.0, 0.0, 1.0, 2.0, 3.0;
+  EXPECT_EQ(expected, q.ToVec(order));
+
+  auto P = q.GetPermutation(order);
+  EXPECT_EQ(expected, q.ToVec(P));
+
+  Joints q2(3, 2);
+  q2.SetFromVec(expected, P);
+  EXPECT_EQ(q.ToVec(), q2.ToVec());
+}
+
+TEST(Joints, SizeMismatch)
+{
+  Joints q(3, 2);
+  EXPECT_THROW(q.SetFromVec(VectorXd::Zero(5)), std::invalid_argument);
+  EXPECT_EQ(6, q.GetNumJoints());
+
+  EXPECT_THROW(q.SetFromVec(VectorXd::Zero(6), Joints::EEOrder{0, 1}), std::invalid_argument);
+  EXPECT_THROW(q.ToVec(Joints::EEOrder{0, 3}), std::out_of_range);
+
+  EXPECT_THROW(q.GetPermutation({0, 1}), std::invalid_argument);
+  EXPECT_THROW(q.GetPermutation({0, 1, 1}), std::invalid_argument);
+
+  auto P = Joints(2, 2).GetPermutation({1, 0});
+  EXPECT_THROW(q.ToVec(P), std::invalid_argument);
+  EXPECT_THROW(q.SetFromVec(VectorXd::Zero(6), P), std::invalid_argument);
+}
@@ -0,0 +1,150 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+
+#include <xpp_states/trajectory_archive.h>
+
+using namespace xpp;
+
+using States = TrajectoryArchiveReader::States;
+
+static const std::string kPath = "/tmp/xpp_trajectory_archive_test.xppa";
+
+// smooth motion of the base and four feet, as a planner would output.
+static States
+WalkTrajectory (int n_states)
+{
+  States states;
+  for (int k=0; k<n_states; ++k) {
+    double t = 0.002*k;
+    RobotStateCartesian state(4);
+    state.t_global_ = t;
+    state.base_.lin.p_ << 0.3*t, 0.02*std::sin(4*t), 0.5;
+    state.base_.lin.v_ << 0.3, 0.08*std::cos(4*t), 0.0;
+    state.base_.ang.q = GetQuaternionFromEulerZYX(0.2*t, 0.05*std::sin(2*t), 0.0);
+    state.base_.ang.w << 0.0, 0.1*std::cos(2*t), 0.2;
+
+    for (auto ee : state.ee_motion_.GetEEsOrdered()) {
+      double phase = std::sin(2*M_PI*(t + 0.25*ee));
+      bool swing = phase > 0.0;
+      state.ee_contact_.at(ee) = !swing;
+      state.ee_motion_.at(ee).p_ << 0.3*t + (ee<2? 0.3 : -0.3), ee%2? 0.2 : -0.2,
+                                    swing? 0.1*phase : 0.0;
+      state.ee_forces_.at(ee).z() = swing? 0.0 : 150.0*(1.0-phase);
+    }
+    states.push_back(state);
+  }
+  return states;
+}
+
+static void
+Write (const States& states, int chunk_size)
+{
+  TrajectoryArchiveWriter writer(kPath, 4, chunk_size);
+  for (const auto& s : states)
+    writer.Write(s);
+}
+
+static void
+ExpectNear (const RobotStateCartesian& a, const RobotStateCartesian& b)
+{
+  TrajectoryArchive::Resolution r;
+  EXPECT_NEAR(a.t_global_, b.t_global_, r.time);
+  EXPECT_LT((a.base_.lin.p_ - b.base_.lin.p_).norm(), r.pos);
+  EXPECT_LT((a.base_.lin.v_ - b.base_.lin.v_).norm(), r.vel);
+  EXPECT_LT((a.base_.ang.w  - b.base_.ang.w ).norm(), r.vel);
+  EXPECT_LT(a.base_.ang.q.angularDistance(b.base_.ang.q), 1e-4);
+  EXPECT_EQ(a.ee_contact_, b.ee_contact_);
+  for (auto ee : a.ee_motion_.GetEEsOrdered()) {
+    EXPECT_LT((a.ee_motion_.at(ee).p_ - b.ee_motion_.at(ee).p_).norm(), r.pos);
+    EXPECT_LT((a.ee_forces_.at(ee) - b.ee_forces_.at(ee)).norm(), r.force);
+  }
+}
+
+TEST(TrajectoryArchive, RoundTrip)
+{
+  States states = WalkTrajectory(1000);
+  Write(states, 64);
+
+  TrajectoryArchiveReader reader(kPath);
+  EXPECT_EQ(states.size(), reader.GetStateCount());
+  EXPECT_EQ(16, reader.GetChunkCount());
+  EXPECT_EQ(4, reader.GetEECount());
+
+  States read = reader.ReadAll();
+  ASSERT_EQ(states.size(), read.size());
+  for (int k=0; k<int(states.size()); ++k)
+    ExpectNear(states.at(k), read.at(k));
+
+  std::remove(kPath.c_str());
+}
+
+TEST(TrajectoryArchive, SmallerThanMessages)
+{
+  int n_states = 1000;
+  Write(WalkTrajectory(n_states), 100);
+
+  // RobotStateCartesian message: header, base, 4 arrays of n_ee elements
+  int n_ee = 4;
+  int msg_bytes = 8 + 152 + 4+72*n_ee + 4+24*n_ee + 4+n_ee;
+
+  std::ifstream file(kPath, std::ios::binary | std::ios::ate);
+  int archive_bytes = file.tellg();
+  EXPECT_LT(archive_bytes, n_states*msg_bytes/4);
+
+  std::remove(kPath.c_str());
+}
+
+TEST(TrajectoryArchive, RandomAccess)
+{
+  States states = WalkTrajectory(500);
+  Write(states, 50);
+
+  TrajectoryArchiveReader reader(kPath);
+  for (int k : {0, 49, 50, 123, 499})
+    ExpectNear(states.at(k), reader.ReadState(k));
+
+  EXPECT_EQ(0, reader.FindChunk(-1.0));
+  EXPECT_EQ(2, reader.FindChunk(states.at(123).t_global_));
+  EXPECT_EQ(9, reader.FindChunk(100.0));
+
+  EXPECT_THROW(reader.ReadState(500), std::out_of_range);
+  std::remove(kPath.c_str());
+}
+
+TEST(TrajectoryArchive, RejectsOtherFiles)
+{
+  { std::ofstream file(kPath); file << "not an archive"; }
+  EXPECT_THROW(TrajectoryArchiveReader reader(kPath), std::runtime_error);
+  std::remove(kPath.c_str());
+}
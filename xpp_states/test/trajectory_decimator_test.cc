@@ -0,0 +1,131 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <xpp_states/trajectory_decimator.h>
+#include <xpp_states/trajectory_interpolator.h>
+
+using namespace xpp;
+
+using States = TrajectoryDecimator::States;
+
+// straight base motion with one foot stepping in the middle.
+static States
+StepTrajectory ()
+{
+  States states;
+  for (int k=0; k<=300; ++k) {
+    double t = 0.01*k;
+    RobotStateCartesian state(2);
+    state.t_global_ = t;
+    state.base_.lin.p_ << 0.2*t, 0.0, 0.5;
+    state.base_.ang.q = GetQuaternionFromEulerZYX(0.1*t, 0.0, 0.0);
+
+    bool swing = 1.0 < t && t < 2.0;
+    state.ee_contact_.at(1) = !swing;
+    state.ee_motion_.at(1).p_ << 0.3, 0.0, swing? 0.1*std::sin(M_PI*(t-1.0)) : 0.0;
+    state.ee_forces_.at(0).z() = swing? 200.0 : 100.0;
+    states.push_back(state);
+  }
+  return states;
+}
+
+TEST(TrajectoryDecimator, RemovesMostStates)
+{
+  States states = StepTrajectory();
+  TrajectoryDecimator::Tolerances tol;
+  States kept = TrajectoryDecimator(tol).Decimate(states);
+
+  EXPECT_LT(kept.size(), states.size()/5);
+
+  // the contact schedule survives playback of the kept states
+  TrajectoryInterpolator interpolator(kept);
+  for (const auto& s : states)
+    EXPECT_EQ(s.ee_contact_, interpolator.At(s.t_global_).ee_contact_) << s.t_global_;
+}
+
+TEST(TrajectoryDecimator, KeepsContactTransitions)
+{
+  States states = StepTrajectory();
+  auto indices = TrajectoryDecimator().GetKeptIndices(states);
+
+  auto kept = [&](int k) {
+    return std::find(indices.begin(), indices.end(), k) != indices.end();
+  };
+
+  EXPECT_TRUE(kept(0));
+  EXPECT_TRUE(kept(300));
+  for (int k=1; k<states.size(); ++k) {
+    if (states[k].ee_contact_ != states[k-1].ee_contact_) {
+      EXPECT_TRUE(kept(k-1)) << k;
+      EXPECT_TRUE(kept(k)) << k;
+    }
+  }
+}
+
+TEST(TrajectoryDecimator, LinearErrorBounded)
+{
+  States states = StepTrajectory();
+  TrajectoryDecimator::Tolerances tol;
+  auto indices = TrajectoryDecimator(tol).GetKeptIndices(states);
+
+  for (int i=1; i<indices.size(); ++i) {
+    const auto& a = states[indices[i-1]];
+    const auto& b = states[indices[i]];
+    for (int k=indices[i-1]+1; k<indices[i]; ++k) {
+      double alpha = (states[k].t_global_ - a.t_global_)/(b.t_global_ - a.t_global_);
+      Vector3d ee = (1-alpha)*a.ee_motion_.at(1).p_ + alpha*b.ee_motion_.at(1).p_;
+      EXPECT_LE((ee - states[k].ee_motion_.at(1).p_).norm(), tol.ee_pos);
+      auto q = a.base_.ang.q.slerp(alpha, b.base_.ang.q);
+      EXPECT_LE(q.angularDistance(states[k].base_.ang.q), tol.base_angle);
+    }
+  }
+}
+
+TEST(TrajectoryDecimator, HoldErrorBounded)
+{
+  States states = StepTrajectory();
+  TrajectoryDecimator::Tolerances tol;
+  auto indices = TrajectoryDecimator(tol, TrajectoryDecimator::kHold).GetKeptIndices(states);
+
+  EXPECT_LT(indices.size(), states.size()/2);
+
+  // a removed state differs from the last kept one by less than the tolerance
+  for (int i=1; i<indices.size(); ++i) {
+    const auto& a = states[indices[i-1]];
+    for (int k=indices[i-1]+1; k<indices[i]; ++k) {
+      EXPECT_LE((a.base_.lin.p_ - states[k].base_.lin.p_).norm(), tol.base_pos);
+      EXPECT_LE((a.ee_motion_.at(1).p_ - states[k].ee_motion_.at(1).p_).norm(), tol.ee_pos);
+      EXPECT_LE(a.base_.ang.q.angularDistance(states[k].base_.ang.q), tol.base_angle);
+    }
+  }
+}
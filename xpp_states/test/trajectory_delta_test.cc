@@ -0,0 +1,176 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <xpp_states/trajectory_delta.h>
+
+using namespace xpp;
+
+using States = TrajectoryDelta::States;
+
+// a plan with 2s horizon starting at t0, as sent by a receding horizon optimizer.
+static States
+Plan (double t0, double offset = 0.0, double t_change = 1e10)
+{
+  States plan;
+  for (int k=0; k<=200; ++k) {
+    RobotStateCartesian state(4);
+    state.t_global_ = t0 + 0.01*k;
+    state.base_.lin.p_.x() = state.t_global_;
+    if (state.t_global_ > t_change)
+      state.base_.lin.p_.z() = offset;
+    plan.push_back(state);
+  }
+  return plan;
+}
+
+static void
+ExpectSame (const States& expected, const States& actual)
+{
+  ASSERT_EQ(expected.size(), actual.size());
+  for (int k=0; k<expected.size(); ++k)
+    ASSERT_TRUE(TrajectoryDelta::IsSame(expected[k], actual[k], 1e-12)) << k;
+}
+
+TEST(TrajectoryDelta, RecedingHorizon)
+{
+  TrajectoryBuffer buffer;
+  States prev = Plan(0.0);
+  ASSERT_TRUE(buffer.Apply(TrajectoryDelta::Full(prev, 1)));
+
+  // shifted by 20ms, only the last part of the horizon changed
+  States curr = Plan(0.02, 0.1, 1.5);
+  auto delta = TrajectoryDelta::Between(prev, curr, buffer.GetVersion());
+
+  EXPECT_EQ(1, delta.base_version_);
+  EXPECT_LT(delta.points_.size(), curr.size()/3);
+  EXPECT_NEAR(1.5, delta.t_start_, 0.02);
+  EXPECT_DOUBLE_EQ(2.02, delta.t_end_);
+
+  ASSERT_TRUE(buffer.Apply(delta));
+  EXPECT_EQ(delta.version_, buffer.GetVersion());
+
+  // the points before the new plan stay as history
+  States expected(prev.begin(), prev.begin()+2);
+  expected.insert(expected.end(), curr.begin(), curr.end());
+  ExpectSame(expected, buffer.GetPoints());
+}
+
+TEST(TrajectoryDelta, ShorterPlanRemovesTail)
+{
+  TrajectoryBuffer buffer;
+  States prev = Plan(0.0);
+  buffer.Set(prev, 5);
+
+  States curr(prev.begin(), prev.begin()+100);
+  auto delta = TrajectoryDelta::Between(prev, curr, 5);
+  EXPECT_TRUE(delta.points_.empty());
+  EXPECT_FALSE(delta.IsEmpty());
+
+  ASSERT_TRUE(buffer.Apply(delta));
+  ExpectSame(curr, buffer.GetPoints());
+}
+
+TEST(TrajectoryDelta, EmptyPlanRemovesAll)
+{
+  TrajectoryBuffer buffer;
+  States prev = Plan(0.0);
+  buffer.Set(prev, 2);
+
+  auto delta = TrajectoryDelta::Between(prev, States(), 2);
+  EXPECT_TRUE(delta.points_.empty());
+  EXPECT_FALSE(delta.IsEmpty());
+  EXPECT_DOUBLE_EQ(prev.front().t_global_, delta.t_start_);
+  EXPECT_DOUBLE_EQ(prev.back().t_global_, delta.t_end_);
+
+  ASSERT_TRUE(buffer.Apply(delta));
+  EXPECT_TRUE(buffer.GetPoints().empty());
+
+  // nothing sent before and nothing to send now
+  EXPECT_TRUE(TrajectoryDelta::Between(States(), States(), 3).IsEmpty());
+}
+
+TEST(TrajectoryDelta, ChangeInTheMiddle)
+{
+  TrajectoryBuffer buffer;
+  States prev = Plan(0.0);
+  buffer.Set(prev, 3);
+
+  States curr = prev;
+  curr.at(50).ee_contact_.at(2) = false;
+  curr.at(60).ee_forces_.at(1).z() = 80.0;
+
+  auto delta = TrajectoryDelta::Between(prev, curr, 3);
+  EXPECT_EQ(11, delta.points_.size());
+
+  ASSERT_TRUE(buffer.Apply(delta));
+  ExpectSame(curr, buffer.GetPoints());
+
+  // unchanged plan results in an empty delta
+  EXPECT_TRUE(TrajectoryDelta::Between(curr, curr, 4).IsEmpty());
+}
+
+TEST(TrajectoryDelta, RejectsWrongVersion)
+{
+  TrajectoryBuffer buffer;
+  States prev = Plan(0.0);
+  buffer.Set(prev, 7);
+
+  auto delta = TrajectoryDelta::Between(prev, Plan(0.02, 0.1, 1.0), 6);
+  EXPECT_FALSE(buffer.Apply(delta));
+  EXPECT_EQ(7, buffer.GetVersion());
+  ExpectSame(prev, buffer.GetPoints());
+}
+
+TEST(TrajectoryDelta, ReservedFullVersion)
+{
+  States prev = Plan(0.0);
+  States curr = prev;
+  curr.at(5).base_.lin.p_.z() = 0.1;
+
+  EXPECT_THROW(TrajectoryDelta::Full(prev, TrajectoryDelta::kFullVersion), std::invalid_argument);
+  EXPECT_THROW(TrajectoryDelta::Between(prev, curr, TrajectoryDelta::kFullVersion), std::invalid_argument);
+
+  TrajectoryBuffer buffer;
+  EXPECT_THROW(buffer.Set(prev, TrajectoryDelta::kFullVersion), std::invalid_argument);
+
+  // a received full trajectory with the reserved version is refused
+  TrajectoryDelta full;
+  full.points_ = prev;
+  EXPECT_FALSE(buffer.Apply(full));
+  EXPECT_TRUE(buffer.GetPoints().empty());
+
+  // a delta of a single point never replaces the whole trajectory
+  buffer.Set(prev, 1);
+  auto delta = TrajectoryDelta::Between(prev, curr, 1);
+  EXPECT_FALSE(delta.IsFull());
+  ASSERT_TRUE(buffer.Apply(delta));
+  ExpectSame(curr, buffer.GetPoints());
+}
@@ -0,0 +1,133 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+#include <xpp_states/trajectory_exporter.h>
+
+using namespace xpp;
+
+static RobotStateCartesian
+GetState (int k)
+{
+  RobotStateCartesian state(2);
+  state.t_global_ = 0.01*k;
+  state.base_.lin.p_ << k, 0.5, 0.25;
+  state.ee_forces_.at(1).z() = 2.0*k;
+  state.ee_contact_.at(0) = k%2;
+  return state;
+}
+
+TEST(TrajectoryExporter, ColumnNames)
+{
+  auto names = TrajectoryExporter::GetColumnNames(2);
+  EXPECT_EQ(1 + 19 + 2*13, names.size());
+  EXPECT_EQ("t",           names.at(0));
+  EXPECT_EQ("base_x",      names.at(1));
+  EXPECT_EQ("base_qw",     names.at(10));
+  EXPECT_EQ("ee0_x",       names.at(20));
+  EXPECT_EQ("ee1_fz",      names.at(44));
+  EXPECT_EQ("ee1_contact", names.at(45));
+}
+
+TEST(TrajectoryExporter, CSV)
+{
+  int n = 1000;
+  std::stringstream out;
+  {
+    TrajectoryExporter exporter(out, 2, TrajectoryExporter::CSV, 64, 3);
+    for (int k=0; k<n; ++k)
+      exporter.Write(GetState(k));
+  }
+
+  std::string line;
+  std::getline(out, line);
+  EXPECT_EQ(0, line.find("t,base_x,base_y,base_z,base_vx"));
+
+  // all rows in order
+  for (int k=0; k<n; ++k) {
+    ASSERT_TRUE(std::getline(out, line));
+    std::stringstream row(line);
+    std::vector<double> values;
+    for (std::string v; std::getline(row, v, ',');)
+      values.push_back(std::stod(v));
+
+    ASSERT_EQ(46, values.size());
+    EXPECT_EQ(0.01*k, values.at(0)); // no precision lost
+    EXPECT_EQ(k,     values.at(1));
+    EXPECT_EQ(1.0,   values.at(10)); // qw
+    EXPECT_EQ(2.0*k, values.at(44));
+    EXPECT_EQ(k%2,   values.at(32)); // ee0_contact
+  }
+  EXPECT_FALSE(std::getline(out, line));
+}
+
+TEST(TrajectoryExporter, Binary)
+{
+  int n = 1000, chunk_size = 128;
+  std::stringstream out;
+  TrajectoryExporter exporter(out, 2, TrajectoryExporter::Binary, chunk_size, 2);
+  for (int k=0; k<n; ++k)
+    exporter.Write(GetState(k));
+  exporter.Close();
+
+  std::string data = out.str();
+  EXPECT_EQ("XPPC", data.substr(0,4));
+  uint32_t n_columns;
+  std::memcpy(&n_columns, &data[8], 4);
+  EXPECT_EQ(exporter.GetColumnCount(), n_columns);
+
+  // skip the names
+  size_t p = 12;
+  for (int c=0; c<n_columns; ++c)
+    p = data.find('\n', p) + 1;
+
+  int k = 0;
+  while (p < data.size()) {
+    uint32_t n_rows;
+    std::memcpy(&n_rows, &data[p], 4);
+    p += 4;
+    EXPECT_EQ(std::min(chunk_size, n-k), n_rows);
+
+    const char* base_x = &data[p + 1*n_rows*sizeof(double)];
+    for (int r=0; r<n_rows; ++r) {
+      double x;
+      std::memcpy(&x, base_x + r*sizeof(double), sizeof(double));
+      EXPECT_EQ(k+r, x);
+    }
+    k += n_rows;
+    p += n_columns*n_rows*sizeof(double);
+  }
+  EXPECT_EQ(n, k);
+  EXPECT_EQ(data.size(), p);
+}
@@ -0,0 +1,170 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include <xpp_states/trajectory_file.h>
+
+using namespace xpp;
+
+static const std::string kPath = "/tmp/xpp_trajectory_file_test.xppt";
+
+static RobotStateCartesian
+GetState (double t)
+{
+  RobotStateCartesian state(2);
+  state.t_global_ = t;
+  state.base_.lin.p_ << t, std::sin(t), 0.5;
+  state.base_.lin.a_ << 0.0, -std::sin(t), 0.0;
+  state.base_.ang.q = GetQuaternionFromEulerZYX(0.1*t, 0.0, 0.0);
+  state.base_.ang.wd.z() = 0.3;
+  state.ee_motion_.at(0).p_ << t, 0.2, 0.0;
+  state.ee_motion_.at(1).v_ << 0.0, 0.0, std::cos(t);
+  state.ee_forces_.at(1).z() = 100.0*t;
+  state.ee_contact_.at(0) = std::fmod(t, 1.0) < 0.5;
+  return state;
+}
+
+static void
+ExpectEqual (const RobotStateCartesian& a, const RobotStateCartesian& b)
+{
+  EXPECT_EQ(a.t_global_, b.t_global_);
+  EXPECT_EQ(a.base_.lin.p_, b.base_.lin.p_);
+  EXPECT_EQ(a.base_.lin.a_, b.base_.lin.a_);
+  EXPECT_EQ(a.base_.ang.q.coeffs(), b.base_.ang.q.coeffs());
+  EXPECT_EQ(a.base_.ang.wd, b.base_.ang.wd);
+  EXPECT_EQ(a.ee_contact_, b.ee_contact_);
+  for (auto ee : a.ee_motion_.GetEEsOrdered()) {
+    EXPECT_EQ(a.ee_motion_.at(ee).p_, b.ee_motion_.at(ee).p_);
+    EXPECT_EQ(a.ee_motion_.at(ee).v_, b.ee_motion_.at(ee).v_);
+    EXPECT_EQ(a.ee_forces_.at(ee), b.ee_forces_.at(ee));
+  }
+}
+
+TEST(TrajectoryFile, UniformSampling)
+{
+  int n = 1000;
+  double dt = 0.01;
+  {
+    TrajectoryFileWriter writer(kPath, 2, 64);
+    for (int k=0; k<n; ++k)
+      writer.Write(GetState(k*dt));
+  }
+
+  TrajectoryFile file(kPath);
+  EXPECT_EQ(n, file.GetStateCount());
+  EXPECT_EQ(2, file.GetEECount());
+  EXPECT_TRUE(file.IsUniformlySampled());
+  EXPECT_DOUBLE_EQ((n-1)*dt, file.GetEndTime());
+
+  for (int k : {0, 63, 64, 500, n-1})
+    ExpectEqual(GetState(k*dt), file.GetState(k));
+
+  EXPECT_EQ(0,   file.FindState(-1.0));
+  EXPECT_EQ(123, file.FindState(123*dt));
+  EXPECT_EQ(123, file.FindState(123.5*dt));
+  EXPECT_EQ(n-1, file.FindState(1e6));
+  ExpectEqual(GetState(500*dt), file.GetStateAt(500.2*dt));
+
+  EXPECT_THROW(file.GetState(n), std::out_of_range);
+  std::remove(kPath.c_str());
+}
+
+TEST(TrajectoryFile, NonUniformSampling)
+{
+  std::vector<double> times;
+  for (int k=0; k<300; ++k)
+    times.push_back(0.001*k*k);
+  {
+    TrajectoryFileWriter writer(kPath, 2, 32);
+    for (double t : times)
+      writer.Write(GetState(t));
+  }
+
+  TrajectoryFile file(kPath);
+  EXPECT_FALSE(file.IsUniformlySampled());
+  for (int k=0; k<times.size(); ++k) {
+    EXPECT_EQ(k, file.FindState(times.at(k)));
+    if (k+1 < times.size()) {
+      EXPECT_EQ(k, file.FindState(0.5*(times.at(k)+times.at(k+1))));
+    }
+  }
+  EXPECT_EQ(0, file.FindState(-1.0));
+  ExpectEqual(GetState(times.at(100)), file.GetState(100));
+  EXPECT_TRUE(file.GetBase(200).lin.p_.isApprox(GetState(times.at(200)).base_.lin.p_));
+
+  std::remove(kPath.c_str());
+}
+
+static std::string
+ReadBytes (const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+TEST(TrajectoryFile, PartialBlockZeroPadded)
+{
+  const std::string path_short = "/tmp/xpp_trajectory_file_test_short.xppt";
+  {
+    TrajectoryFileWriter writer(kPath, 2, 4);
+    for (int k=0; k<6; ++k)
+      writer.Write(GetState(k+1.0));
+  }
+  {
+    TrajectoryFileWriter writer(path_short, 2, 4);
+    for (int k=4; k<6; ++k)
+      writer.Write(GetState(k+1.0));
+  }
+
+  // the partial last block holds no leftovers of the previous block, so
+  // it matches the only block of a file with just these states.
+  std::string bytes = ReadBytes(kPath);
+  std::string bytes_short = ReadBytes(path_short);
+  int header = TrajectoryFileFormat::kHeaderSize;
+  int block = bytes.size() - bytes_short.size() - sizeof(double); // one index entry less
+  EXPECT_EQ(bytes_short.substr(header, block), bytes.substr(header+block, block));
+  EXPECT_EQ(std::string(4, '\0'), bytes.substr(20, 4)) << "header padding before n_states";
+
+  std::remove(kPath.c_str());
+  std::remove(path_short.c_str());
+}
+
+TEST(TrajectoryFile, RejectsIncompleteFiles)
+{
+  { std::ofstream file(kPath); file << "not a trajectory file"; }
+  EXPECT_THROW(TrajectoryFile file(kPath), std::runtime_error);
+  EXPECT_THROW(TrajectoryFile file("/tmp/does_not_exist.xppt"), std::runtime_error);
+  std::remove(kPath.c_str());
+}
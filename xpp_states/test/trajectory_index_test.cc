@@ -0,0 +1,144 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <xpp_states/trajectory_index.h>
+
+using namespace xpp;
+
+using States = TrajectoryIndex::States;
+
+// two feet, the second one lifted during [1,2) and [3,3.5).
+static States
+WalkTrajectory ()
+{
+  States states;
+  for (int k=0; k<=500; ++k) {
+    double t = 0.01*k;
+    RobotStateCartesian state(2);
+    state.t_global_ = t;
+    state.base_.lin.p_.z() = 0.5 + 0.05*std::sin(3*t);
+
+    bool swing = (1.0 <= t && t < 2.0) || (3.0 <= t && t < 3.5);
+    state.ee_contact_.at(0) = true;
+    state.ee_contact_.at(1) = !swing;
+    state.ee_forces_.at(0).z() = swing? 300.0 + 20*std::sin(5*t) : 150.0;
+    state.ee_forces_.at(1).z() = swing? 0.0 : 150.0;
+    states.push_back(state);
+  }
+  return states;
+}
+
+TEST(TrajectoryIndex, AggregatesMatchScan)
+{
+  States states = WalkTrajectory();
+  TrajectoryIndex index(states, TrajectoryIndex::GetDefaultChannels(2));
+
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> time(-0.5, 5.5);
+  for (int i=0; i<200; ++i) {
+    double t0 = time(gen), t1 = time(gen);
+    if (t0 > t1)
+      std::swap(t0, t1);
+
+    double min = std::numeric_limits<double>::infinity(), max = -min, sum = 0.0;
+    for (const auto& s : states) {
+      if (t0 <= s.t_global_ && s.t_global_ <= t1) {
+        double z = s.base_.lin.p_.z();
+        min = std::min(min, z);
+        max = std::max(max, z);
+        sum += s.ee_forces_.at(0).z();
+      }
+    }
+
+    EXPECT_EQ(min, index.Min("base_z", t0, t1));
+    EXPECT_EQ(max, index.Max("base_z", t0, t1));
+    EXPECT_NEAR(sum, index.Sum("ee0_fz", t0, t1), 1e-6);
+  }
+
+  EXPECT_DOUBLE_EQ(320.0, std::round(index.Max("ee0_fz", 0.0, 5.0)));
+  EXPECT_DOUBLE_EQ(150.0, index.Mean("ee1_fz", 0.0, 0.9));
+  EXPECT_THROW(index.Min("ee2_fz", 0.0, 1.0), std::invalid_argument);
+}
+
+TEST(TrajectoryIndex, EmptyInterval)
+{
+  TrajectoryIndex index(WalkTrajectory(), TrajectoryIndex::GetDefaultChannels(2));
+
+  // no sample lies strictly between 0.01 and 0.02
+  EXPECT_EQ( std::numeric_limits<double>::infinity(), index.Min("base_z", 0.011, 0.019));
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), index.Max("base_z", 0.011, 0.019));
+  EXPECT_EQ(0.0, index.Sum("base_z", 0.011, 0.019));
+  EXPECT_TRUE(std::isnan(index.Mean("base_z", 0.011, 0.019)));
+  EXPECT_TRUE(std::isnan(index.Mean("base_z", 6.0, 7.0)));
+}
+
+TEST(TrajectoryIndex, UnorderedStates)
+{
+  States states = WalkTrajectory();
+  std::swap(states.at(10), states.at(11));
+  EXPECT_THROW(TrajectoryIndex(states, TrajectoryIndex::GetDefaultChannels(2)),
+               std::invalid_argument);
+}
+
+TEST(TrajectoryIndex, FindFirst)
+{
+  TrajectoryIndex index(WalkTrajectory(), TrajectoryIndex::GetDefaultChannels(2));
+
+  EXPECT_NEAR(1.0, index.FindFirstBelow("contacts", 0.0, 2), 1e-9);
+  EXPECT_NEAR(3.0, index.FindFirstBelow("contacts", 2.5, 2), 1e-9);
+  EXPECT_NEAR(1.0, index.FindFirstAbove("ee0_fz", 0.0, 200.0), 1e-9);
+  EXPECT_EQ(std::numeric_limits<double>::infinity(),
+            index.FindFirstBelow("contacts", 3.6, 2));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(),
+            index.FindFirstAbove("ee1_fz", 0.0, 150.0));
+}
+
+TEST(TrajectoryIndex, FindWindowsBelow)
+{
+  TrajectoryIndex index(WalkTrajectory(), TrajectoryIndex::GetDefaultChannels(2));
+
+  auto windows = index.FindWindowsBelow("contacts", 2);
+  ASSERT_EQ(2, windows.size());
+  EXPECT_NEAR(1.0,  windows.at(0).first,  1e-9);
+  EXPECT_NEAR(1.99, windows.at(0).second, 1e-9);
+  EXPECT_NEAR(3.0,  windows.at(1).first,  1e-9);
+  EXPECT_NEAR(3.49, windows.at(1).second, 1e-9);
+
+  // window until the end of the trajectory
+  windows = index.FindWindowsBelow("base_z", 1.0);
+  ASSERT_EQ(1, windows.size());
+  EXPECT_NEAR(5.0, windows.at(0).second, 1e-9);
+}
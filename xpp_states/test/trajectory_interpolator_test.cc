@@ -0,0 +1,125 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <xpp_states/trajectory_interpolator.h>
+
+using namespace xpp;
+
+// samples a quintic polynomial, which must be reproduced exactly.
+static RobotStateCartesian
+Sample (double t)
+{
+  RobotStateCartesian state(2);
+  state.t_global_ = t;
+
+  double p = 0.2*std::pow(t,5) - t*t*t + 0.5*t;
+  double v = 1.0*std::pow(t,4) - 3*t*t + 0.5;
+  double a = 4.0*std::pow(t,3) - 6*t;
+
+  state.base_.lin.p_ << p, 2*p, 1.0;
+  state.base_.lin.v_ << v, 2*v, 0.0;
+  state.base_.lin.a_ << a, 2*a, 0.0;
+  state.base_.ang.q = GetQuaternionFromEulerZYX(t, 0.0, 0.0);
+
+  state.ee_motion_.at(1).p_ << 0.0, 0.0, p;
+  state.ee_motion_.at(1).v_ << 0.0, 0.0, v;
+  state.ee_motion_.at(1).a_ << 0.0, 0.0, a;
+  state.ee_forces_.at(0) << 0.0, 0.0, 100*t;
+  state.ee_contact_.at(0) = t < 0.45;
+  return state;
+}
+
+static std::vector<RobotStateCartesian>
+SampleTrajectory (const std::vector<double>& times)
+{
+  std::vector<RobotStateCartesian> states;
+  for (double t : times)
+    states.push_back(Sample(t));
+  return states;
+}
+
+TEST(TrajectoryInterpolator, ReproducesQuintic)
+{
+  TrajectoryInterpolator interpolator(SampleTrajectory({0.0, 0.1, 0.35, 0.4, 1.0}));
+  EXPECT_FALSE(interpolator.IsUniformlySampled());
+
+  for (double t=0.0; t<=1.0; t+=0.01) {
+    auto state    = interpolator.At(t);
+    auto expected = Sample(t);
+    EXPECT_NEAR(t, state.t_global_, 1e-12);
+    EXPECT_TRUE(state.base_.lin.p_.isApprox(expected.base_.lin.p_, 1e-9));
+    EXPECT_TRUE(state.base_.lin.v_.isApprox(expected.base_.lin.v_, 1e-9));
+    EXPECT_NEAR(expected.ee_motion_.at(1).a_.z(), state.ee_motion_.at(1).a_.z(), 1e-9);
+    EXPECT_NEAR(expected.ee_forces_.at(0).z(), state.ee_forces_.at(0).z(), 1e-9);
+    EXPECT_NEAR(0.0, expected.base_.ang.q.angularDistance(state.base_.ang.q), 1e-9);
+  }
+}
+
+TEST(TrajectoryInterpolator, ContactIsStep)
+{
+  TrajectoryInterpolator interpolator(SampleTrajectory({0.0, 0.4, 0.8}));
+  EXPECT_TRUE(interpolator.At(0.79).ee_contact_.at(0));
+  EXPECT_FALSE(interpolator.At(0.8).ee_contact_.at(0));
+}
+
+TEST(TrajectoryInterpolator, ClampsOutside)
+{
+  TrajectoryInterpolator interpolator(SampleTrajectory({0.0, 0.5, 1.0}));
+  EXPECT_TRUE(interpolator.IsUniformlySampled());
+  EXPECT_EQ(Sample(0.0).base_.lin, interpolator.At(-1.0).base_.lin);
+  EXPECT_EQ(Sample(1.0).base_.lin, interpolator.At(2.0).base_.lin);
+}
+
+TEST(TrajectoryInterpolator, RejectsEmpty)
+{
+  EXPECT_THROW(TrajectoryInterpolator{std::vector<RobotStateCartesian>()}, std::invalid_argument);
+  EXPECT_THROW(TrajectoryInterpolator{CartesianTrajectory(4)}, std::invalid_argument);
+}
+
+TEST(TrajectoryInterpolator, CursorAndBatch)
+{
+  std::vector<double> sample_times;
+  for (int k=0; k<=100; ++k)
+    sample_times.push_back(0.01*k);
+  TrajectoryInterpolator interpolator(SampleTrajectory(sample_times));
+  EXPECT_TRUE(interpolator.IsUniformlySampled());
+
+  std::vector<double> times = {0.0, 0.004, 0.013, 0.5, 0.2, 0.999, 1.5};
+  auto batch = interpolator.At(times);
+  auto cursor = interpolator.GetCursor();
+
+  ASSERT_EQ(times.size(), batch.size());
+  for (int i=0; i<times.size(); ++i) {
+    auto single = interpolator.At(times.at(i));
+    EXPECT_EQ(single.base_.lin, batch.at(i).base_.lin);
+    EXPECT_EQ(single.base_.lin, cursor.At(times.at(i)).base_.lin);
+  }
+}
@@ -0,0 +1,161 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include <xpp_states/trajectory_ring_buffer.h>
+
+using namespace xpp;
+
+using States = TrajectoryRingBuffer::States;
+
+// 2s horizon sampled at 10ms starting at t0, base height marks the plan.
+static States
+Plan (double t0, int plan_id)
+{
+  States plan;
+  for (int k=0; k<200; ++k) {
+    RobotStateCartesian state(4);
+    state.t_global_ = t0 + 0.01*k;
+    state.base_.lin.p_ << state.t_global_, 0.0, plan_id;
+    plan.push_back(state);
+  }
+  return plan;
+}
+
+TEST(TrajectoryRingBuffer, MergeOverwritesFuture)
+{
+  TrajectoryRingBuffer buffer(400);
+  buffer.Merge(Plan(0.0, 1));
+  buffer.Merge(Plan(0.5, 2));
+
+  States states;
+  buffer.GetStates(states);
+  ASSERT_EQ(50+200, states.size());
+  EXPECT_EQ(1, states.at(49).base_.lin.p_.z());
+  EXPECT_EQ(2, states.at(50).base_.lin.p_.z());
+  EXPECT_NEAR(0.5, states.at(50).t_global_, 1e-9);
+
+  RobotStateCartesian state;
+  ASSERT_TRUE(buffer.GetState(0.505, state));
+  EXPECT_NEAR(0.50, state.t_global_, 1e-9);
+  EXPECT_EQ(2, state.base_.lin.p_.z());
+  EXPECT_EQ(4, state.ee_motion_.GetEECount());
+
+  ASSERT_TRUE(buffer.GetState(100.0, state)); // clamped to last
+  EXPECT_NEAR(2.49, state.t_global_, 1e-9);
+}
+
+TEST(TrajectoryRingBuffer, EvictAndWrapAround)
+{
+  TrajectoryRingBuffer buffer(300);
+
+  // plans arrive every 20ms, so the ring wraps many times
+  for (int i=0; i<100; ++i) {
+    double t_now = 0.02*i;
+    buffer.EvictBefore(t_now);
+    buffer.Merge(Plan(t_now, i));
+  }
+
+  States states;
+  buffer.GetStates(states);
+  ASSERT_EQ(200, states.size());
+  EXPECT_NEAR(1.98, states.front().t_global_, 1e-9);
+  for (int k=1; k<states.size(); ++k)
+    EXPECT_LT(states[k-1].t_global_, states[k].t_global_);
+
+  buffer.EvictBefore(10.0);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_FALSE(buffer.GetState(0.0, states.front()));
+}
+
+TEST(TrajectoryRingBuffer, PlanLargerThanCapacity)
+{
+  TrajectoryRingBuffer buffer(150);
+  buffer.Merge(Plan(0.0, 1));
+
+  States states;
+  buffer.GetStates(states);
+  ASSERT_EQ(150, states.size());
+  EXPECT_NEAR(0.0, states.front().t_global_, 1e-9);  // keeps the start,
+  EXPECT_NEAR(1.49, states.back().t_global_, 1e-9);  // which is needed first
+}
+
+TEST(TrajectoryRingBuffer, RejectsInconsistentState)
+{
+  TrajectoryRingBuffer buffer(400);
+  buffer.Merge(Plan(0.0, 1));
+  uint64_t version = buffer.GetVersion();
+
+  States plan = Plan(0.5, 2);
+  plan.at(10).ee_forces_.SetCount(2);
+  EXPECT_THROW(buffer.Merge(plan), std::invalid_argument);
+
+  // still readable and unchanged
+  EXPECT_EQ(version, buffer.GetVersion());
+  RobotStateCartesian state(0);
+  ASSERT_TRUE(buffer.GetState(1.0, state));
+  EXPECT_EQ(1.0, state.base_.lin.p_.z());
+}
+
+TEST(TrajectoryRingBuffer, ConcurrentReaders)
+{
+  TrajectoryRingBuffer buffer(500);
+  std::atomic<bool> done(false);
+
+  std::thread writer([&]() {
+    for (int i=0; i<2000; ++i) {
+      double t_now = 0.02*i;
+      buffer.EvictBefore(t_now);
+      buffer.Merge(Plan(t_now, i));
+    }
+    done = true;
+  });
+
+  // every snapshot must be one consistent merge of whole plans
+  auto read = [&]() {
+    States states;
+    while (!done) {
+      buffer.GetStates(states);
+      for (int k=1; k<states.size(); ++k) {
+        ASSERT_LT(states[k-1].t_global_, states[k].t_global_);
+        ASSERT_LE(states[k-1].base_.lin.p_.z(), states[k].base_.lin.p_.z());
+        ASSERT_DOUBLE_EQ(states[k].t_global_, states[k].base_.lin.p_.x());
+      }
+    }
+  };
+
+  std::thread reader1(read), reader2(read);
+  writer.join();
+  reader1.join();
+  reader2.join();
+}
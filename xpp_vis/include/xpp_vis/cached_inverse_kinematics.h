@@ -0,0 +1,137 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef XPP_VIS_CACHED_INVERSE_KINEMATICS_H_
+#define XPP_VIS_CACHED_INVERSE_KINEMATICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "inverse_kinematics.h"
+
+namespace xpp {
+
+/**
+ * @brief Remembers the joint angles of another %InverseKinematics.
+ *
+ * Looping bags, feet in stance and many robots running the same motion
+ * request the same endeffector positions over and over. This layer
+ * quantizes all endeffector positions (base frame) to a grid of the given
+ * resolution and returns the stored joint angles if the same grid cell
+ * was solved before. The returned angles therefore belong to a position at
+ * most resolution/2 per axis away from the requested one.
+ *
+ * The cache holds a fixed number of solutions in sets of a few entries,
+ * chosen by the hash of the quantized positions. A new solution replaces
+ * the least recently used entry of its set. Lookups never block: each
+ * entry carries a version that a reader checks before and after copying,
+ * retrying nothing but reporting a miss if a writer changed the entry in
+ * between. Only inserting new solutions is serialized.
+ */
+class CachedInverseKinematics : public InverseKinematics {
+public:
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions; ///< entries replaced by newer solutions.
+    double GetHitRate() const;
+  };
+
+  /**
+   * @brief Wraps the %InverseKinematics ik.
+   * @param resolution  Grid size [m] the positions are quantized to.
+   * @param capacity    Maximum number of stored solutions.
+   */
+  explicit CachedInverseKinematics(const InverseKinematics::Ptr& ik,
+                                   double resolution = 1e-4,
+                                   int capacity = 4096);
+  virtual ~CachedInverseKinematics() = default;
+
+  /**
+   * @brief The stored joint angles if available, otherwise the solution of
+   * the wrapped %InverseKinematics, which is then stored.
+   */
+  Joints GetAllJointAngles(const EndeffectorsPos& pos_b) const override;
+
+  /**
+   * @brief As above, passing q_init to the wrapped %InverseKinematics on a miss.
+   */
+  Joints GetAllJointAngles(const EndeffectorsPos& pos_b,
+                           const Joints& q_init) const override;
+
+  Jacobians GetJacobians(const Joints& q) const override;
+  Jacobians GetJacobianDerivatives(const Joints& q, const Joints& qd) const override;
+  int GetEECount() const override;
+
+  Stats GetStats() const;
+  void ResetStats();
+
+  /**
+   * @brief Removes all stored solutions, e.g. after the geometry changed.
+   */
+  void Clear();
+
+private:
+  static constexpr int kWays = 8; ///< entries per set.
+
+  // the number of joints is only known after the first solution, so the
+  // storage is created then and never changes afterwards.
+  struct Table {
+    Table(int n_sets, int key_size, int n_ee, int n_joints_per_ee);
+    int n_sets, key_size, n_ee, n_joints_per_ee;
+    std::unique_ptr<std::atomic<uint32_t>[]> versions; ///< odd while written.
+    std::unique_ptr<std::atomic<bool>[]>     occupied;
+    std::unique_ptr<std::atomic<uint32_t>[]> last_used;
+    std::unique_ptr<std::atomic<int32_t>[]>  keys;
+    std::unique_ptr<std::atomic<double>[]>   values;
+  };
+
+  InverseKinematics::Ptr ik_;
+  double resolution_;
+  int n_sets_;
+
+  mutable std::atomic<Table*> table_;
+  mutable std::unique_ptr<Table> table_storage_;
+  mutable std::mutex write_mutex_;
+
+  mutable std::atomic<uint32_t> clock_;
+  mutable std::atomic<uint64_t> hits_, misses_, evictions_;
+
+  Joints GetCached(const EndeffectorsPos& pos_b, const Joints* q_init) const;
+  void Quantize(const EndeffectorsPos& pos_b, int32_t* key) const;
+  static uint64_t Hash(const int32_t* key, int size);
+  bool Find(const Table& table, const int32_t* key, uint64_t hash, Joints& q) const;
+  void Insert(const int32_t* key, int key_size, uint64_t hash, const Joints& q) const;
+};
+
+} /* namespace xpp */
+
+#endif /* XPP_VIS_CACHED_INVERSE_KINEMATICS_H_ */
@@ -31,11 +31,20 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define XPP_VIS_CARTESIAN_JOINT_CONVERTER_H_
 
 #include <string>
+#include <vector>
 
 #include <ros/publisher.h>
 #include <ros/subscriber.h>
 
 #include <xpp_msgs/RobotStateCartesian.h>
+#include <xpp_msgs/RobotStateCartesianCompact.h>
+#include <xpp_msgs/RobotStateCartesianTrajectory.h>
+#include <xpp_msgs/RobotStateJoint.h>
+#include <xpp_msgs/RobotStateJointTrajectory.h>
+
+#include <xpp_states/robot_state_cartesian.h>
+#include <xpp_states/robot_state_cartesian_view.h>
+#include <xpp_states/robot_state_joint.h>
 
 #include "inverse_kinematics.h"
 
@@ -46,7 +55,10 @@ namespace xpp {
  *
  * This class subscribes to a Cartesian robot state message and publishes
  * the, through inverse kinematics converted, joint state message. This
- * can then be used to visualize URDFs in RVIZ.
+ * can then be used to visualize URDFs in RVIZ. If the %InverseKinematics
+ * provides Jacobians, joint velocities and torques are filled in as well,
+ * see GetJointState(). Complete trajectories can be converted as well,
+ * see SubscribeTrajectory().
  */
 class CartesianJointConverter {
 public:
@@ -55,19 +67,103 @@ public:
    * @param  ik  The %InverseKinematics to use for conversion.
    * @param  cart_topic  The ROS topic containing the Cartesian robot state.
    * @param  joint_topic The ROS topic to publish for the URDF visualization.
+   * @param  compact  True if cart_topic carries RobotStateCartesianCompact.
    */
   CartesianJointConverter (const InverseKinematics::Ptr& ik,
                            const std::string& cart_topic,
-                           const std::string& joint_topic);
+                           const std::string& joint_topic,
+                           bool compact = false);
   virtual ~CartesianJointConverter () = default;
 
+  /**
+   * @brief Additionally converts complete Cartesian trajectories.
+   * @param  cart_traj_topic   The ROS topic of the Cartesian trajectory.
+   * @param  joint_traj_topic  The ROS topic to publish the joint trajectory.
+   */
+  void SubscribeTrajectory(const std::string& cart_traj_topic,
+                           const std::string& joint_traj_topic);
+
+  /**
+   * @brief Converts all states of a trajectory, split in time across threads.
+   * @param  ik   The %InverseKinematics to use for conversion, called
+   *              concurrently from these threads. Each state is passed
+   *              the joint angles of the previous one as initial guess.
+   * @param  msg  The Cartesian trajectory.
+   * @param  q    The joint angles, one column per state. Only resized if
+   *              the trajectory has a different size than the last one.
+   */
+  static void GetJointTrajectory(const InverseKinematics& ik,
+                                 const xpp_msgs::RobotStateCartesianTrajectory& msg,
+                                 Eigen::MatrixXd& q);
+
+  /**
+   * @brief The joint angles to reach the endeffector positions in world frame.
+   */
+  static Eigen::VectorXd GetJointAngles(const InverseKinematics& ik,
+                                        const Vector3d& base_pos,
+                                        const Eigen::Quaterniond& base_ori,
+                                        const EndeffectorsPos& ee_W);
+
+  /**
+   * @brief Converts a Cartesian state into joint space.
+   * @param  ik     The %InverseKinematics to use for conversion.
+   * @param  cart   The Cartesian state, with the base angular velocity and
+   *                acceleration as well as the endeffector forces expressed
+   *                in world frame.
+   * @param  joint  The joint state. Only resized if the number of joints
+   *                differs from the last call.
+   *
+   * The joint angles always come from the inverse kinematics. If the
+   * %InverseKinematics also provides Jacobians J, the endeffector motion
+   * relative to the base is mapped to joint space as
+   *   qd  = J^-1 * v_B,
+   *   qdd = J^-1 * (a_B - Jd * qd),
+   * solved in the least-squares sense near singularities, and the
+   * torques to produce the endeffector forces f (the forces the environment
+   * exerts on the robot) are the quasi-static tau = -J^T * f_B,
+   * neglecting the inertia and gravity of the legs themselves.
+   */
+  static void GetJointState(const InverseKinematics& ik,
+                            const RobotStateCartesian& cart,
+                            RobotStateJoint& joint);
+
+  /**
+   * @brief As above, reading the state directly from the message.
+   */
+  static void GetJointState(const InverseKinematics& ik,
+                            const RobotStateCartesianView& cart,
+                            RobotStateJoint& joint);
+
 private:
+  /// one decomposition of the Jacobian per endeffector
+  using SVDs = std::vector<Eigen::JacobiSVD<Eigen::MatrixXd>>;
+
+  static void GetJointState(const InverseKinematics& ik,
+                            const RobotStateCartesian& cart,
+                            RobotStateJoint& joint, SVDs& svd);
+  template<typename Cart>
+  static void GetJointState(const InverseKinematics& ik, const Cart& cart,
+                            RobotStateJoint& joint, SVDs& svd);
+
   void StateCallback(const xpp_msgs::RobotStateCartesian& msg);
+  void CompactStateCallback(const xpp_msgs::RobotStateCartesianCompact& msg);
+  void TrajectoryCallback(const xpp_msgs::RobotStateCartesianTrajectory& msg);
+  void FillJointState(xpp_msgs::RobotStateJoint& joint_msg) const;
+
+  static EndeffectorsPos ToBaseFrame(const Vector3d& base_pos,
+                                     const Eigen::Quaterniond& base_ori,
+                                     const EndeffectorsPos& ee_W);
 
   ros::Subscriber cart_state_sub_;
   ros::Publisher  joint_state_pub_;
+  ros::Subscriber cart_traj_sub_;
+  ros::Publisher  joint_traj_pub_;
 
   InverseKinematics::Ptr inverse_kinematics_;
+  RobotStateCartesian cart_; ///< reused when converting messages
+  RobotStateJoint joint_;    ///< reused when converting messages
+  SVDs svd_;                 ///< reused when converting messages
+  Eigen::MatrixXd q_traj_;   ///< reused when converting trajectories
 };
 
 } /* namespace xpp */
@@ -0,0 +1,133 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef XPP_VIS_DLS_INVERSE_KINEMATICS_H_
+#define XPP_VIS_DLS_INVERSE_KINEMATICS_H_
+
+#include <mutex>
+#include <vector>
+
+#include "inverse_kinematics.h"
+#include "kinematic_chain.h"
+
+namespace xpp {
+
+/**
+ * @brief Numerical inverse kinematics for arbitrary legs or arms.
+ *
+ * Solves for the joint angles of every endeffector's KinematicChain,
+ * e.g. read from the robot's URDF, by damped least squares:
+ *   dq = J^T (J J^T + lambda^2 I)^-1 (pos_des - pos(q)),
+ * iterated until the position error is below a tolerance or a fixed number
+ * of iterations is reached, clamping to the joint limits after each step.
+ * The damping keeps the steps bounded close to singularities and for
+ * unreachable positions.
+ *
+ * Starting from the solution of the previous timestep (warm start),
+ * smoothly moving endeffectors usually converge in one or two iterations.
+ * This also selects the same solution branch (e.g. knee bend) as before.
+ * Callers converting several trajectories or time intervals in parallel
+ * pass that solution explicitly as q_init. For a single stream of states,
+ * e.g. one robot state topic, GetAllJointAngles(pos_b) remembers it.
+ */
+class DlsInverseKinematics : public InverseKinematics {
+public:
+  struct Params {
+    int max_iterations;  ///< iterations per endeffector before giving up.
+    double tolerance;    ///< position error [m] at which to stop.
+    double damping;      ///< lambda, trades off accuracy vs. step size.
+  };
+
+  /**
+   * @brief Default parameters, accurate to 0.1mm within at most 20 iterations.
+   */
+  static Params GetDefaultParams();
+
+  /**
+   * @brief Creates the solver for one chain per endeffector.
+   * @param chains  Every chain must have the same number of joints.
+   */
+  explicit DlsInverseKinematics(const std::vector<KinematicChain>& chains);
+  DlsInverseKinematics(const std::vector<KinematicChain>& chains,
+                       const Params& params);
+  virtual ~DlsInverseKinematics() = default;
+
+  /**
+   * @brief Joint angles for pos_b, warm-started from the previous call.
+   *
+   * Meant for a single stream of states. Concurrent calls are safe, but
+   * then each starts from whichever solution was stored last.
+   */
+  Joints GetAllJointAngles(const EndeffectorsPos& pos_b) const override;
+
+  /**
+   * @brief Joint angles for pos_b starting the iterations from q_init.
+   *
+   * Starts from the nominal joint angles if q_init holds no endeffectors.
+   */
+  Joints GetAllJointAngles(const EndeffectorsPos& pos_b,
+                           const Joints& q_init) const override;
+
+  /**
+   * @brief As above.
+   * @param iterations  The number of iterations for all endeffectors.
+   */
+  Joints GetAllJointAngles(const EndeffectorsPos& pos_b, const Joints& q_init,
+                           int* iterations) const;
+
+  Jacobians GetJacobians(const Joints& q) const override;
+
+  int GetEECount() const override;
+
+  /**
+   * @brief The joint angles the first call starts from, zero by default.
+   *
+   * These should be chosen to select the desired solution branch, e.g.
+   * slightly bent knees.
+   */
+  void SetNominalJoints(const Joints& q);
+  const Joints& GetNominalJoints() const;
+
+  /**
+   * @brief Starts the next call from the nominal joint angles again.
+   */
+  void ResetWarmStart();
+
+private:
+  std::vector<KinematicChain> chains_;
+  Params params_;
+  Joints q_nominal_;
+
+  mutable std::mutex mutex_; ///< guards the warm start below.
+  mutable Joints q_prev_;
+};
+
+} /* namespace xpp */
+
+#endif /* XPP_VIS_DLS_INVERSE_KINEMATICS_H_ */
@@ -49,6 +49,8 @@ class InverseKinematics {
 public:
   using Ptr      = std::shared_ptr<InverseKinematics>;
   using Vector3d = Eigen::Vector3d;
+  /// For each endeffector the 3 x n_joints_per_ee matrix d(pos_b)/dq.
+  using Jacobians = Endeffectors<Eigen::MatrixXd>;
 
   InverseKinematics () = default;
   virtual ~InverseKinematics () = default;
@@ -60,6 +62,35 @@ public:
     */
   virtual Joints GetAllJointAngles(const EndeffectorsPos& pos_b) const = 0;
 
+  /**
+   * @brief  As above, but iterative solvers start from the joint angles q_init.
+   * @param  q_init  E.g. the solution of the previous timestep, to stay on
+   *                 the same solution branch. If it holds no endeffectors,
+   *                 the solver starts from its nominal joint angles.
+   *
+   * Closed-form solutions ignore q_init. In contrast to the above, this
+   * never depends on previous calls.
+   */
+  virtual Joints GetAllJointAngles(const EndeffectorsPos& pos_b,
+                                   const Joints& q_init) const { return GetAllJointAngles(pos_b); };
+
+  /**
+   * @brief  The Jacobians mapping joint velocities to endeffector velocities.
+   * @param  q  The joint angles, e.g. from GetAllJointAngles().
+   * @return For every endeffector d(pos_b)/dq, or an empty container if
+   *         this implementation does not provide them.
+   *
+   * These allow to fill in joint velocities, accelerations and quasi-static
+   * torques from the Cartesian state, see CartesianJointConverter.
+   */
+  virtual Jacobians GetJacobians(const Joints& q) const { return Jacobians(); };
+
+  /**
+   * @brief  The time derivatives of GetJacobians() for joint velocities qd.
+   */
+  virtual Jacobians GetJacobianDerivatives(const Joints& q,
+                                           const Joints& qd) const { return Jacobians(); };
+
   /**
    * @brief Number of endeffectors (feet, hands) this implementation expects.
    */
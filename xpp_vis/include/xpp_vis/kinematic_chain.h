@@ -0,0 +1,134 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef XPP_VIS_KINEMATIC_CHAIN_H_
+#define XPP_VIS_KINEMATIC_CHAIN_H_
+
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace urdf {
+class ModelInterface;
+}
+
+namespace xpp {
+
+/**
+ * @brief A serial chain of single-DOF joints from the base to an endeffector.
+ *
+ * The joints are described as in a URDF: Each joint frame is placed by a
+ * fixed transform (origin) relative to the previous joint frame and moves
+ * the following links by rotating around or translating along its axis.
+ * Fixed transforms in between (e.g. to the foot link) are folded into the
+ * next joint's origin or the tip. A chain can be built by hand or read
+ * from a URDF through FromUrdf().
+ */
+class KinematicChain {
+public:
+  using Vector3d   = Eigen::Vector3d;
+  using VectorXd   = Eigen::VectorXd;
+  using MatrixXd   = Eigen::MatrixXd;
+  using Isometry3d = Eigen::Isometry3d;
+
+  /// Upper bound on the joints, so kinematics computations need no heap.
+  static constexpr int kMaxJoints = 12;
+
+  enum JointType { Revolute, Prismatic };
+
+  struct Joint {
+    std::string name;
+    JointType type;
+    Isometry3d origin; ///< joint frame w.r.t. the previous one for q=0.
+    Vector3d axis;     ///< unit axis expressed in the joint frame.
+    double lower;      ///< joint limits [rad] or [m].
+    double upper;
+  };
+
+  KinematicChain () = default;
+  virtual ~KinematicChain () = default;
+
+  /**
+   * @brief Builds the chain between two links of a URDF.
+   * @param model      The parsed URDF, e.g. urdf::Model::initParam().
+   * @param root_link  The name of the base link, positions are expressed in.
+   * @param tip_link   The name of the endeffector link, e.g. the foot.
+   *
+   * Throws if the tip is not a descendant of the root or the chain contains
+   * joints other than fixed, revolute, continuous or prismatic ones.
+   */
+  static KinematicChain FromUrdf(const urdf::ModelInterface& model,
+                                 const std::string& root_link,
+                                 const std::string& tip_link);
+
+  /**
+   * @brief The transform given by a translation and roll-pitch-yaw angles.
+   */
+  static Isometry3d GetTransform(const Vector3d& xyz, const Vector3d& rpy);
+
+  /**
+   * @brief Appends a moving joint to the end of the chain.
+   */
+  void AddJoint(const Joint& joint);
+
+  /**
+   * @brief Appends a fixed transform to the end of the chain.
+   */
+  void AddFixed(const Isometry3d& origin);
+
+  int GetJointCount() const;
+  const Joint& GetJoint(int i) const;
+
+  /**
+   * @brief The endeffector position (forward kinematics) in the root frame.
+   */
+  Vector3d GetPosition(const VectorXd& q) const;
+
+  /**
+   * @brief The endeffector position and the 3 x n Jacobian d(pos)/dq.
+   * @param J  Only resized if it does not have the right size yet.
+   */
+  Vector3d GetPosition(const VectorXd& q, MatrixXd& J) const;
+
+  /**
+   * @brief Clamps the joint values to the joint limits.
+   */
+  void EnforceLimits(VectorXd& q) const;
+
+private:
+  std::vector<Joint> joints_;
+  Isometry3d tip_ = Isometry3d::Identity(); ///< fixed transforms after the last joint.
+
+  Isometry3d GetMotion(const Joint& joint, double q) const;
+};
+
+} /* namespace xpp */
+
+#endif /* XPP_VIS_KINEMATIC_CHAIN_H_ */
@@ -41,6 +41,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <xpp_states/state.h>
 #include <xpp_states/robot_state_cartesian.h>
+#include <xpp_states/foothold_map.h>
 
 
 namespace xpp {
@@ -79,6 +80,20 @@ public:
    */
   MarkerArray BuildRobotState(const xpp_msgs::RobotStateCartesian& msg) const;
 
+  /**
+   * @brief  Constructs the RVIZ markers from a Cartesian robot state.
+   * @param  state  The robot state, e.g. converted from a compact message.
+   * @return The array of RVIZ markers to be published.
+   */
+  MarkerArray BuildRobotState(const RobotState& state) const;
+
+  /**
+   * @brief  Constructs a single marker showing all footholds of the map.
+   * @param  footholds  The positions at which the endeffectors touched down.
+   * @return A SPHERE_LIST marker, independent of the number of footholds.
+   */
+  Marker BuildFootholds(const FootholdMap& footholds) const;
+
   /**
    * @brief  Provides additional robot info that can be used for visualization.
    * @param  msg  The ROS message.
@@ -105,6 +120,11 @@ private:
   // pos_W = position expressed in world frame
   // f_W   = forces expressed in world frame.
   // c     = which leg is currently in contact with the environment.
+  MarkerArray BuildRobotState(const Vector3d& base_pos,
+                              const Eigen::Quaterniond& base_ori,
+                              const EEPos& pos_W,
+                              const EEForces& f_W,
+                              const ContactState& c) const;
   MarkerVec CreateEEPositions(const EEPos& pos_W,
                               const ContactState& c) const;
   MarkerVec CreateEEForces(const EEForces& f_W,
@@ -114,7 +134,8 @@ private:
                                 const ContactState& c) const;
   MarkerVec CreateSupportArea(const ContactState& c,
                               const EEPos& pos_W) const;
-  MarkerVec CreateRangeOfMotion(const State3d& base) const;
+  MarkerVec CreateRangeOfMotion(const Vector3d& base_pos,
+                                const Eigen::Quaterniond& base_ori) const;
   Marker    CreateGravityForce (const Vector3d& base_pos) const;
   Marker    CreateBasePose(const Vector3d& pos,
                            Eigen::Quaterniond ori,
@@ -0,0 +1,295 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_vis/cached_inverse_kinematics.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace xpp {
+
+constexpr int CachedInverseKinematics::kWays;
+
+double
+CachedInverseKinematics::Stats::GetHitRate () const
+{
+  uint64_t n = hits + misses;
+  return n == 0? 0.0 : double(hits)/n;
+}
+
+CachedInverseKinematics::Table::Table (int _n_sets, int _key_size, int _n_ee,
+                                       int _n_joints_per_ee)
+    : n_sets(_n_sets), key_size(_key_size), n_ee(_n_ee),
+      n_joints_per_ee(_n_joints_per_ee)
+{
+  int n = n_sets*kWays;
+  versions.reset(new std::atomic<uint32_t>[n]);
+  occupied.reset(new std::atomic<bool>[n]);
+  last_used.reset(new std::atomic<uint32_t>[n]);
+  keys.reset(new std::atomic<int32_t>[n*key_size]);
+  values.reset(new std::atomic<double>[n*n_ee*n_joints_per_ee]);
+
+  for (int i=0; i<n; ++i) {
+    versions[i]  = 0;
+    occupied[i]  = false;
+    last_used[i] = 0;
+  }
+}
+
+CachedInverseKinematics::CachedInverseKinematics (const InverseKinematics::Ptr& ik,
+                                                  double resolution,
+                                                  int capacity)
+    : ik_(ik),
+      resolution_(resolution),
+      table_(nullptr),
+      clock_(0), hits_(0), misses_(0), evictions_(0)
+{
+  if (resolution_ <= 0.0)
+    throw std::invalid_argument("xpp::CachedInverseKinematics: resolution must be positive");
+
+  // power of two number of sets, so the hash can simply be masked
+  n_sets_ = 1;
+  while (n_sets_*kWays < capacity)
+    n_sets_ *= 2;
+}
+
+void
+CachedInverseKinematics::Quantize (const EndeffectorsPos& pos_b, int32_t* key) const
+{
+  for (auto ee : pos_b.GetEEsOrdered())
+    for (int dim=0; dim<3; ++dim)
+      key[3*ee+dim] = std::lround(pos_b.at(ee)(dim)/resolution_);
+}
+
+uint64_t
+CachedInverseKinematics::Hash (const int32_t* key, int size)
+{
+  // FNV-1a over the quantized coordinates
+  uint64_t hash = 14695981039346656037ull;
+  for (int i=0; i<size; ++i) {
+    hash ^= uint32_t(key[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash ^ (hash >> 32);
+}
+
+Joints
+CachedInverseKinematics::GetAllJointAngles (const EndeffectorsPos& pos_b) const
+{
+  return GetCached(pos_b, nullptr);
+}
+
+Joints
+CachedInverseKinematics::GetAllJointAngles (const EndeffectorsPos& pos_b,
+                                            const Joints& q_init) const
+{
+  return GetCached(pos_b, &q_init);
+}
+
+Joints
+CachedInverseKinematics::GetCached (const EndeffectorsPos& pos_b,
+                                    const Joints* q_init) const
+{
+  int32_t key[3*kMaxEndeffectors];
+  int key_size = 3*pos_b.GetEECount();
+  Quantize(pos_b, key);
+  uint64_t hash = Hash(key, key_size);
+
+  Table* table = table_.load(std::memory_order_acquire);
+  if (table && table->key_size == key_size) {
+    Joints q(table->n_ee, table->n_joints_per_ee);
+    if (Find(*table, key, hash, q)) {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return q;
+    }
+  }
+
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  Joints q = q_init? ik_->GetAllJointAngles(pos_b, *q_init)
+                   : ik_->GetAllJointAngles(pos_b);
+  Insert(key, key_size, hash, q);
+  return q;
+}
+
+bool
+CachedInverseKinematics::Find (const Table& table, const int32_t* key,
+                               uint64_t hash, Joints& q) const
+{
+  int n_values = table.n_ee*table.n_joints_per_ee;
+  int set = hash & (table.n_sets-1);
+
+  for (int slot=set*kWays; slot<(set+1)*kWays; ++slot) {
+    uint32_t version = table.versions[slot].load(std::memory_order_acquire);
+    if (version & 1 || !table.occupied[slot].load(std::memory_order_relaxed))
+      continue; // being written or empty
+
+    bool same_key = true;
+    const std::atomic<int32_t>* slot_key = &table.keys[slot*table.key_size];
+    for (int i=0; i<table.key_size && same_key; ++i)
+      same_key = slot_key[i].load(std::memory_order_relaxed) == key[i];
+    if (!same_key)
+      continue;
+
+    const std::atomic<double>* slot_values = &table.values[slot*n_values];
+    for (int i=0; i<n_values; ++i)
+      q.GetJoint(i) = slot_values[i].load(std::memory_order_relaxed);
+
+    // only valid if no writer touched the entry while copying
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (table.versions[slot].load(std::memory_order_relaxed) != version)
+      return false;
+
+    table.last_used[slot].store(clock_.fetch_add(1, std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+    return true;
+  }
+
+  return false;
+}
+
+void
+CachedInverseKinematics::Insert (const int32_t* key, int key_size, uint64_t hash,
+                                 const Joints& q) const
+{
+  std::lock_guard<std::mutex> lock(write_mutex_);
+
+  Table* table = table_.load(std::memory_order_relaxed);
+  if (!table) {
+    table_storage_.reset(new Table(n_sets_, key_size, q.GetEECount(), q.GetNumJointsPerEE()));
+    table = table_storage_.get();
+    table_.store(table, std::memory_order_release);
+  }
+
+  // e.g. a varying number of endeffectors is simply not cached
+  if (table->key_size != key_size || table->n_ee != q.GetEECount()
+      || table->n_joints_per_ee != q.GetNumJointsPerEE())
+    return;
+
+  // empty or least recently used entry of the set, unless another thread
+  // stored this solution in the meantime.
+  int set = hash & (table->n_sets-1);
+  uint32_t now = clock_.fetch_add(1, std::memory_order_relaxed);
+  int empty = -1, lru = -1;
+  uint32_t max_age = 0;
+  for (int s=set*kWays; s<(set+1)*kWays; ++s) {
+    if (!table->occupied[s].load(std::memory_order_relaxed)) {
+      if (empty < 0)
+        empty = s;
+      continue;
+    }
+
+    bool same_key = true;
+    for (int i=0; i<key_size && same_key; ++i)
+      same_key = table->keys[s*key_size+i].load(std::memory_order_relaxed) == key[i];
+    if (same_key)
+      return;
+
+    uint32_t age = now - table->last_used[s].load(std::memory_order_relaxed);
+    if (lru < 0 || age > max_age) {
+      lru = s;
+      max_age = age;
+    }
+  }
+
+  int slot = empty >= 0? empty : lru;
+  if (empty < 0)
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+
+  // readers ignore the entry while the version is odd
+  uint32_t version = table->versions[slot].load(std::memory_order_relaxed);
+  table->versions[slot].store(version+1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  for (int i=0; i<key_size; ++i)
+    table->keys[slot*key_size+i].store(key[i], std::memory_order_relaxed);
+  const Eigen::VectorXd& values = q.ToVec();
+  for (int i=0; i<values.size(); ++i)
+    table->values[slot*values.size()+i].store(values[i], std::memory_order_relaxed);
+  table->occupied[slot].store(true, std::memory_order_relaxed);
+  table->last_used[slot].store(now, std::memory_order_relaxed);
+
+  table->versions[slot].store(version+2, std::memory_order_release);
+}
+
+InverseKinematics::Jacobians
+CachedInverseKinematics::GetJacobians (const Joints& q) const
+{
+  return ik_->GetJacobians(q);
+}
+
+InverseKinematics::Jacobians
+CachedInverseKinematics::GetJacobianDerivatives (const Joints& q, const Joints& qd) const
+{
+  return ik_->GetJacobianDerivatives(q, qd);
+}
+
+int
+CachedInverseKinematics::GetEECount () const
+{
+  return ik_->GetEECount();
+}
+
+CachedInverseKinematics::Stats
+CachedInverseKinematics::GetStats () const
+{
+  Stats stats;
+  stats.hits      = hits_.load(std::memory_order_relaxed);
+  stats.misses    = misses_.load(std::memory_order_relaxed);
+  stats.evictions = evictions_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void
+CachedInverseKinematics::ResetStats ()
+{
+  hits_      = 0;
+  misses_    = 0;
+  evictions_ = 0;
+}
+
+void
+CachedInverseKinematics::Clear ()
+{
+  std::lock_guard<std::mutex> lock(write_mutex_);
+
+  Table* table = table_.load(std::memory_order_relaxed);
+  if (!table)
+    return;
+
+  // versions keep counting up, so readers notice the change
+  for (int slot=0; slot<table->n_sets*kWays; ++slot) {
+    uint32_t version = table->versions[slot].load(std::memory_order_relaxed);
+    table->versions[slot].store(version+1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    table->occupied[slot].store(false, std::memory_order_relaxed);
+    table->versions[slot].store(version+2, std::memory_order_release);
+  }
+}
+
+} /* namespace xpp */
@@ -29,21 +29,29 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <xpp_vis/cartesian_joint_converter.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <ros/node_handle.h>
 
 #include <xpp_msgs/RobotStateJoint.h>
 #include <xpp_states/convert.h>
+#include <xpp_states/robot_state_cartesian_view.h>
 
 namespace xpp {
 
 CartesianJointConverter::CartesianJointConverter (const InverseKinematics::Ptr& ik,
                                                   const std::string& cart_topic,
-                                                  const std::string& joint_topic)
+                                                  const std::string& joint_topic,
+                                                  bool compact)
 {
   inverse_kinematics_ = ik;
 
   ::ros::NodeHandle n;
-  cart_state_sub_ = n.subscribe(cart_topic, 1, &CartesianJointConverter::StateCallback, this);
+  if (compact)
+    cart_state_sub_ = n.subscribe(cart_topic, 1, &CartesianJointConverter::CompactStateCallback, this);
+  else
+    cart_state_sub_ = n.subscribe(cart_topic, 1, &CartesianJointConverter::StateCallback, this);
   ROS_DEBUG("Subscribed to: %s", cart_state_sub_.getTopic().c_str());
 
   joint_state_pub_  = n.advertise<xpp_msgs::RobotStateJoint>(joint_topic, 1);
@@ -53,24 +61,259 @@ CartesianJointConverter::CartesianJointConverter (const InverseKinematics::Ptr&
 void
 CartesianJointConverter::StateCallback (const xpp_msgs::RobotStateCartesian& cart_msg)
 {
-  auto cart = Convert::ToXpp(cart_msg);
-
-  // transform feet from world -> base frame
-  Eigen::Matrix3d B_R_W = cart.base_.ang.q.normalized().toRotationMatrix().inverse();
-  EndeffectorsPos ee_B(cart.ee_motion_.GetEECount());
-  for (auto ee : ee_B.GetEEsOrdered())
-    ee_B.at(ee) = B_R_W * (cart.ee_motion_.at(ee).p_ - cart.base_.lin.p_);
-
-  Eigen::VectorXd q =  inverse_kinematics_->GetAllJointAngles(ee_B).ToVec();
+  RobotStateCartesianView cart(cart_msg);
+  GetJointState(*inverse_kinematics_, cart, joint_, svd_);
 
   xpp_msgs::RobotStateJoint joint_msg;
   joint_msg.base            = cart_msg.base;
   joint_msg.ee_contact      = cart_msg.ee_contact;
   joint_msg.time_from_start = cart_msg.time_from_start;
-  joint_msg.joint_state.position = std::vector<double>(q.data(), q.data()+q.size());
-  // Attention: Not filling joint velocities or torques
+  FillJointState(joint_msg);
 
   joint_state_pub_.publish(joint_msg);
 }
 
+void
+CartesianJointConverter::CompactStateCallback (const xpp_msgs::RobotStateCartesianCompact& cart_msg)
+{
+  Convert::ToXpp(cart_msg, cart_);
+  GetJointState(*inverse_kinematics_, cart_, joint_, svd_);
+
+  xpp_msgs::RobotStateJoint joint_msg;
+  joint_msg.base            = Convert::ToRos(cart_.base_);
+  joint_msg.time_from_start = cart_msg.time_from_start;
+  for (auto ee : cart_.ee_contact_.GetEEsOrdered())
+    joint_msg.ee_contact.push_back(cart_.ee_contact_.at(ee));
+  FillJointState(joint_msg);
+
+  joint_state_pub_.publish(joint_msg);
+}
+
+void
+CartesianJointConverter::SubscribeTrajectory (const std::string& cart_traj_topic,
+                                              const std::string& joint_traj_topic)
+{
+  ::ros::NodeHandle n;
+  cart_traj_sub_ = n.subscribe(cart_traj_topic, 1, &CartesianJointConverter::TrajectoryCallback, this);
+  ROS_DEBUG("Subscribed to: %s", cart_traj_sub_.getTopic().c_str());
+
+  joint_traj_pub_ = n.advertise<xpp_msgs::RobotStateJointTrajectory>(joint_traj_topic, 1);
+  ROS_DEBUG("Publishing to: %s", joint_traj_pub_.getTopic().c_str());
+}
+
+void
+CartesianJointConverter::TrajectoryCallback (const xpp_msgs::RobotStateCartesianTrajectory& cart_msg)
+{
+  GetJointTrajectory(*inverse_kinematics_, cart_msg, q_traj_);
+
+  int n = cart_msg.points.size();
+  xpp_msgs::RobotStateJointTrajectory joint_msg;
+  joint_msg.header = cart_msg.header;
+  joint_msg.points.resize(n);
+  Convert::ForEachPoint(n, [&](int k) {
+    const auto& cart = cart_msg.points[k];
+    auto& joint = joint_msg.points[k];
+    joint.base            = cart.base;
+    joint.ee_contact      = cart.ee_contact;
+    joint.time_from_start = cart.time_from_start;
+    joint.joint_state.position.assign(q_traj_.col(k).data(),
+                                      q_traj_.col(k).data() + q_traj_.rows());
+  });
+
+  joint_traj_pub_.publish(joint_msg);
+}
+
+void
+CartesianJointConverter::GetJointTrajectory (const InverseKinematics& ik,
+                                             const xpp_msgs::RobotStateCartesianTrajectory& msg,
+                                             Eigen::MatrixXd& q)
+{
+  int n = msg.points.size();
+  if (n == 0) {
+    q.resize(q.rows(), 0);
+    return;
+  }
+
+  auto get_joint_angles = [&ik, &msg](int k, const Joints& q_init) {
+    RobotStateCartesianView cart(msg.points[k]);
+    auto ee_B = ToBaseFrame(cart.GetBasePos(), cart.GetBaseOri(), cart.GetEEPositions());
+    return ik.GetAllJointAngles(ee_B, q_init);
+  };
+
+  // the number of joints is only known after the first conversion
+  Joints q0 = get_joint_angles(0, Joints(0, 0));
+  if (q.rows() != q0.GetNumJoints() || q.cols() != n)
+    q.resize(q0.GetNumJoints(), n);
+  q.col(0) = q0.ToVec();
+
+  // each thread converts a contiguous time interval, every state starting
+  // from the solution of the previous one. The first state of each interval
+  // starts from the solution of the first state, so the result does not
+  // depend on how the threads are scheduled.
+  Convert::ForEachInterval(n-1, [&](int k_start, int k_end) {
+    Joints q_prev = q0;
+    for (int k=k_start+1; k<=k_end; ++k) {
+      q_prev = get_joint_angles(k, q_prev);
+      q.col(k) = q_prev.ToVec();
+    }
+  });
+}
+
+Eigen::VectorXd
+CartesianJointConverter::GetJointAngles (const InverseKinematics& ik,
+                                         const Vector3d& base_pos,
+                                         const Eigen::Quaterniond& base_ori,
+                                         const EndeffectorsPos& ee_W)
+{
+  return ik.GetAllJointAngles(ToBaseFrame(base_pos, base_ori, ee_W)).ToVec();
+}
+
+EndeffectorsPos
+CartesianJointConverter::ToBaseFrame (const Vector3d& base_pos,
+                                      const Eigen::Quaterniond& base_ori,
+                                      const EndeffectorsPos& ee_W)
+{
+  // transform feet from world -> base frame
+  Eigen::Matrix3d B_R_W = base_ori.normalized().toRotationMatrix().inverse();
+  EndeffectorsPos ee_B(ee_W.GetEECount());
+  for (auto ee : ee_B.GetEEsOrdered())
+    ee_B.at(ee) = B_R_W * (ee_W.at(ee) - base_pos);
+
+  return ee_B;
+}
+
+namespace {
+
+// reads a RobotStateCartesian through the same accessors as a
+// RobotStateCartesianView, so both are converted by the same code.
+class CartesianAccess {
+public:
+  explicit CartesianAccess(const RobotStateCartesian& cart) : cart_(cart) {};
+
+  double GetTime() const { return cart_.t_global_; };
+
+  const Vector3d& GetBasePos()    const { return cart_.base_.lin.p_; };
+  const Vector3d& GetBaseVel()    const { return cart_.base_.lin.v_; };
+  const Vector3d& GetBaseAcc()    const { return cart_.base_.lin.a_; };
+  const Quaterniond& GetBaseOri() const { return cart_.base_.ang.q;  };
+  const Vector3d& GetBaseAngVel() const { return cart_.base_.ang.w;  };
+  const Vector3d& GetBaseAngAcc() const { return cart_.base_.ang.wd; };
+
+  int GetEECount() const { return cart_.ee_motion_.GetEECount(); };
+
+  const Vector3d& GetEEPos(EndeffectorID ee)   const { return cart_.ee_motion_.at(ee).p_; };
+  const Vector3d& GetEEVel(EndeffectorID ee)   const { return cart_.ee_motion_.at(ee).v_; };
+  const Vector3d& GetEEAcc(EndeffectorID ee)   const { return cart_.ee_motion_.at(ee).a_; };
+  const Vector3d& GetEEForce(EndeffectorID ee) const { return cart_.ee_forces_.at(ee);    };
+  const EndeffectorsContact& GetContact()      const { return cart_.ee_contact_;          };
+
+private:
+  const RobotStateCartesian& cart_;
+};
+
+} // namespace
+
+void
+CartesianJointConverter::GetJointState (const InverseKinematics& ik,
+                                        const RobotStateCartesian& cart,
+                                        RobotStateJoint& joint)
+{
+  SVDs svd;
+  GetJointState(ik, CartesianAccess(cart), joint, svd);
+}
+
+void
+CartesianJointConverter::GetJointState (const InverseKinematics& ik,
+                                        const RobotStateCartesianView& cart,
+                                        RobotStateJoint& joint)
+{
+  SVDs svd;
+  GetJointState(ik, cart, joint, svd);
+}
+
+void
+CartesianJointConverter::GetJointState (const InverseKinematics& ik,
+                                        const RobotStateCartesian& cart,
+                                        RobotStateJoint& joint, SVDs& svd)
+{
+  GetJointState(ik, CartesianAccess(cart), joint, svd);
+}
+
+template<typename Cart>
+void
+CartesianJointConverter::GetJointState (const InverseKinematics& ik,
+                                        const Cart& cart,
+                                        RobotStateJoint& joint, SVDs& svd)
+{
+  Eigen::Matrix3d W_R_B = cart.GetBaseOri().normalized().toRotationMatrix();
+  Eigen::Matrix3d B_R_W = W_R_B.transpose();
+  Vector3d w  = cart.GetBaseAngVel();
+  Vector3d wd = cart.GetBaseAngAcc();
+
+  // endeffector motion relative to the (rotating) base, expressed in base frame
+  int n_ee = cart.GetEECount();
+  EndeffectorsPos x_B(n_ee);
+  EndeffectorsVel v_B(n_ee);
+  EndeffectorsAcc a_B(n_ee);
+  for (auto ee : x_B.GetEEsOrdered()) {
+    Vector3d r = cart.GetEEPos(ee) - cart.GetBasePos();
+    x_B.at(ee) = B_R_W*r;
+    v_B.at(ee) = B_R_W*(cart.GetEEVel(ee) - cart.GetBaseVel() - w.cross(r));
+    a_B.at(ee) = B_R_W*(cart.GetEEAcc(ee) - cart.GetBaseAcc() - wd.cross(r) - w.cross(w.cross(r))
+                        - 2.0*w.cross(W_R_B*v_B.at(ee)));
+  }
+
+  Joints q = ik.GetAllJointAngles(x_B);
+  int n_joints_per_ee = q.GetNumJointsPerEE();
+  if (joint.q_.GetEECount() != q.GetEECount() || joint.q_.GetNumJointsPerEE() != n_joints_per_ee)
+    joint = RobotStateJoint(q.GetEECount(), n_joints_per_ee);
+
+  Eigen::VectorXd zero = Eigen::VectorXd::Zero(n_joints_per_ee);
+  joint.base_.lin.p_ = cart.GetBasePos();
+  joint.base_.lin.v_ = cart.GetBaseVel();
+  joint.base_.lin.a_ = cart.GetBaseAcc();
+  joint.base_.ang.q  = cart.GetBaseOri();
+  joint.base_.ang.w  = w;
+  joint.base_.ang.wd = wd;
+  joint.ee_contact_  = cart.GetContact();
+  joint.t_global_    = cart.GetTime();
+  joint.q_           = q;
+  joint.qd_.SetAll(zero);
+  joint.qdd_.SetAll(zero);
+  joint.torques_.SetAll(zero);
+
+  auto J = ik.GetJacobians(q);
+  if (J.GetEECount() == 0)
+    return; // only joint angles available from this implementation
+
+  // the inverse kinematics might expect more endeffectors than given
+  int n = std::min(n_ee, J.GetEECount());
+  if (static_cast<int>(svd.size()) < n)
+    svd.resize(n);
+  for (int ee=0; ee<n; ++ee) {
+    svd[ee].compute(J.at(ee), Eigen::ComputeThinU | Eigen::ComputeThinV);
+    joint.qd_.at(ee) = svd[ee].solve(v_B.at(ee));
+  }
+
+  auto Jd = ik.GetJacobianDerivatives(q, joint.qd_);
+  for (int ee=0; ee<n; ++ee) {
+    Vector3d a_joints = a_B.at(ee); // acceleration caused by qdd alone
+    if (ee < Jd.GetEECount())
+      a_joints -= Jd.at(ee)*joint.qd_.at(ee);
+    joint.qdd_.at(ee)     = svd[ee].solve(a_joints);
+    joint.torques_.at(ee) = -J.at(ee).transpose()*(B_R_W*cart.GetEEForce(ee));
+  }
+}
+
+void
+CartesianJointConverter::FillJointState (xpp_msgs::RobotStateJoint& joint_msg) const
+{
+  const Eigen::VectorXd& q   = joint_.q_.ToVec();
+  const Eigen::VectorXd& qd  = joint_.qd_.ToVec();
+  const Eigen::VectorXd& tau = joint_.torques_.ToVec();
+  joint_msg.joint_state.position.assign(q.data(),   q.data()+q.size());
+  joint_msg.joint_state.velocity.assign(qd.data(),  qd.data()+qd.size());
+  joint_msg.joint_state.effort.assign(tau.data(), tau.data()+tau.size());
+}
+
 } /* namespace xpp */
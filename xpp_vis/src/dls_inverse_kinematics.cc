@@ -0,0 +1,174 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_vis/dls_inverse_kinematics.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace xpp {
+
+DlsInverseKinematics::Params
+DlsInverseKinematics::GetDefaultParams ()
+{
+  Params params;
+  params.max_iterations = 20;
+  params.tolerance      = 1e-4;
+  params.damping        = 1e-2;
+  return params;
+}
+
+DlsInverseKinematics::DlsInverseKinematics (const std::vector<KinematicChain>& chains)
+    : DlsInverseKinematics(chains, GetDefaultParams())
+{
+}
+
+DlsInverseKinematics::DlsInverseKinematics (const std::vector<KinematicChain>& chains,
+                                            const Params& params)
+    : chains_(chains),
+      params_(params),
+      q_nominal_(chains.size(), chains.empty()? 0 : chains.front().GetJointCount()),
+      q_prev_(q_nominal_)
+{
+  if (chains_.empty())
+    throw std::invalid_argument("xpp::DlsInverseKinematics: no kinematic chains");
+
+  for (const auto& chain : chains_)
+    if (chain.GetJointCount() != chains_.front().GetJointCount())
+      throw std::invalid_argument("xpp::DlsInverseKinematics: all chains must have the same number of joints");
+
+  // start within the joint limits
+  for (auto ee : q_nominal_.GetEEsOrdered()) {
+    Eigen::VectorXd q = q_nominal_.at(ee);
+    chains_.at(ee).EnforceLimits(q);
+    q_nominal_.at(ee) = q;
+  }
+  q_prev_ = q_nominal_;
+}
+
+Joints
+DlsInverseKinematics::GetAllJointAngles (const EndeffectorsPos& pos_b) const
+{
+  Joints q_init = [this]() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return q_prev_;
+  }();
+
+  Joints q = GetAllJointAngles(pos_b, q_init);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  q_prev_ = q;
+  return q;
+}
+
+Joints
+DlsInverseKinematics::GetAllJointAngles (const EndeffectorsPos& pos_b,
+                                         const Joints& q_init) const
+{
+  return GetAllJointAngles(pos_b, q_init, nullptr);
+}
+
+Joints
+DlsInverseKinematics::GetAllJointAngles (const EndeffectorsPos& pos_b,
+                                         const Joints& q_init,
+                                         int* iterations) const
+{
+  Joints q_all = q_init.GetEECount() == 0? q_nominal_ : q_init;
+  Eigen::MatrixXd J;
+  double lambda_sq = params_.damping*params_.damping;
+  int iter = 0;
+
+  // endeffectors without a given position keep their initial joint angles
+  int n_ee = std::min<int>(pos_b.GetEECount(), chains_.size());
+  for (int ee=0; ee<n_ee; ++ee) {
+    const KinematicChain& chain = chains_[ee];
+    Eigen::VectorXd q = q_all.at(ee);
+
+    for (int i=0; i<params_.max_iterations; ++i) {
+      Vector3d err = pos_b.at(ee) - chain.GetPosition(q, J);
+      if (err.norm() < params_.tolerance)
+        break;
+
+      Eigen::Matrix3d JJt = J*J.transpose();
+      JJt.diagonal().array() += lambda_sq;
+      q += J.transpose()*JJt.ldlt().solve(err);
+      chain.EnforceLimits(q);
+      iter++;
+    }
+
+    q_all.at(ee) = q;
+  }
+
+  if (iterations)
+    *iterations = iter;
+
+  return q_all;
+}
+
+InverseKinematics::Jacobians
+DlsInverseKinematics::GetJacobians (const Joints& q) const
+{
+  Jacobians J(GetEECount());
+  for (auto ee : J.GetEEsOrdered())
+    chains_.at(ee).GetPosition(q.at(ee), J.at(ee));
+
+  return J;
+}
+
+int
+DlsInverseKinematics::GetEECount () const
+{
+  return chains_.size();
+}
+
+void
+DlsInverseKinematics::SetNominalJoints (const Joints& q)
+{
+  if (q.GetEECount() != q_nominal_.GetEECount()
+      || q.GetNumJointsPerEE() != q_nominal_.GetNumJointsPerEE())
+    throw std::invalid_argument("xpp::DlsInverseKinematics: nominal joints of wrong size");
+
+  q_nominal_ = q;
+  ResetWarmStart();
+}
+
+const Joints&
+DlsInverseKinematics::GetNominalJoints () const
+{
+  return q_nominal_;
+}
+
+void
+DlsInverseKinematics::ResetWarmStart ()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  q_prev_ = q_nominal_;
+}
+
+} /* namespace xpp */
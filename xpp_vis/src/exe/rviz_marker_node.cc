@@ -31,17 +31,47 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <xpp_msgs/topic_names.h>
 #include <xpp_msgs/TerrainInfo.h>
+#include <xpp_msgs/RobotStateCartesianCompact.h>
 
 #include <xpp_states/convert.h>
+#include <xpp_states/robot_state_cartesian_view.h>
 #include <xpp_vis/rviz_robot_builder.h>
 
 
 static ros::Publisher rviz_marker_pub;
 static xpp::RvizRobotBuilder robot_builder;
+static bool show_footholds = false;
+static xpp::FootholdMap footholds;
+
+// the footholds marker is only resent if new ones were added, rviz keeps
+// showing the last one otherwise.
+static void AddFootholds (const xpp::EndeffectorsPos& ee_pos,
+                          const xpp::EndeffectorsContact& contact, double t,
+                          xpp::RvizRobotBuilder::MarkerArray& rviz_marker_msg)
+{
+  if (footholds.Add(ee_pos, contact, t) > 0)
+    rviz_marker_msg.markers.push_back(robot_builder.BuildFootholds(footholds));
+}
 
 static void StateCallback (const xpp_msgs::RobotStateCartesian& state_msg)
 {
   auto rviz_marker_msg = robot_builder.BuildRobotState(state_msg);
+  if (show_footholds) {
+    xpp::RobotStateCartesianView state(state_msg);
+    AddFootholds(state.GetEEPositions(), state.GetContact(), state.GetTime(),
+                 rviz_marker_msg);
+  }
+  rviz_marker_pub.publish(rviz_marker_msg);
+}
+
+static void CompactStateCallback (const xpp_msgs::RobotStateCartesianCompact& state_msg)
+{
+  static xpp::RobotStateCartesian state(0); // reused to avoid allocations
+  xpp::Convert::ToXpp(state_msg, state);
+  auto rviz_marker_msg = robot_builder.BuildRobotState(state);
+  if (show_footholds)
+    AddFootholds(state.ee_motion_.Get(xpp::kPos), state.ee_contact_,
+                 state.t_global_, rviz_marker_msg);
   rviz_marker_pub.publish(rviz_marker_msg);
 }
 
@@ -66,8 +96,19 @@ int main(int argc, char *argv[])
   Subscriber parameters_sub;
   parameters_sub = n.subscribe(xpp_msgs::robot_parameters, 1, ParamsCallback);
 
+  // listen to the float32 version of the state instead, e.g. for bags
+  // recorded in the compact format.
+  bool compact = false;
+  NodeHandle("~").getParam("compact", compact);
+
+  // accumulate and draw all footholds of the motion.
+  NodeHandle("~").getParam("show_footholds", show_footholds);
+
   Subscriber state_sub_curr, state_sub_des, terrain_info_sub;
-  state_sub_des     = n.subscribe(xpp_msgs::robot_state_desired, 1, StateCallback);
+  if (compact)
+    state_sub_des   = n.subscribe(xpp_msgs::robot_state_desired_compact, 1, CompactStateCallback);
+  else
+    state_sub_des   = n.subscribe(xpp_msgs::robot_state_desired, 1, StateCallback);
   terrain_info_sub  = n.subscribe(xpp_msgs::terrain_info, 1,  TerrainInfoCallback);
 
   rviz_marker_pub = n.advertise<visualization_msgs::MarkerArray>("xpp/rviz_markers", 1);
@@ -0,0 +1,140 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_vis/kinematic_chain.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace xpp {
+
+constexpr int KinematicChain::kMaxJoints;
+
+KinematicChain::Isometry3d
+KinematicChain::GetTransform (const Vector3d& xyz, const Vector3d& rpy)
+{
+  // URDF convention: rotation about fixed axes X, then Y, then Z.
+  Isometry3d T = Isometry3d::Identity();
+  T.translation() = xyz;
+  T.linear() = (Eigen::AngleAxisd(rpy.z(), Vector3d::UnitZ())
+               *Eigen::AngleAxisd(rpy.y(), Vector3d::UnitY())
+               *Eigen::AngleAxisd(rpy.x(), Vector3d::UnitX())).toRotationMatrix();
+  return T;
+}
+
+void
+KinematicChain::AddJoint (const Joint& joint)
+{
+  if (joints_.size() == kMaxJoints)
+    throw std::runtime_error("xpp::KinematicChain: more than "
+                             + std::to_string(kMaxJoints) + " joints");
+
+  Joint j = joint;
+  j.origin = tip_*joint.origin;
+  j.axis.normalize();
+  joints_.push_back(j);
+  tip_.setIdentity();
+}
+
+void
+KinematicChain::AddFixed (const Isometry3d& origin)
+{
+  tip_ = tip_*origin;
+}
+
+int
+KinematicChain::GetJointCount () const
+{
+  return joints_.size();
+}
+
+const KinematicChain::Joint&
+KinematicChain::GetJoint (int i) const
+{
+  return joints_.at(i);
+}
+
+KinematicChain::Isometry3d
+KinematicChain::GetMotion (const Joint& joint, double q) const
+{
+  Isometry3d T = Isometry3d::Identity();
+  if (joint.type == Revolute)
+    T.linear() = Eigen::AngleAxisd(q, joint.axis).toRotationMatrix();
+  else
+    T.translation() = q*joint.axis;
+  return T;
+}
+
+KinematicChain::Vector3d
+KinematicChain::GetPosition (const VectorXd& q) const
+{
+  Isometry3d T = Isometry3d::Identity();
+  for (int i=0; i<int(joints_.size()); ++i)
+    T = T*joints_[i].origin*GetMotion(joints_[i], q[i]);
+
+  return T*tip_.translation();
+}
+
+KinematicChain::Vector3d
+KinematicChain::GetPosition (const VectorXd& q, MatrixXd& J) const
+{
+  int n = joints_.size();
+  if (J.rows() != 3 || J.cols() != n)
+    J.resize(3, n);
+
+  // joint axes and positions in root frame, fixed size to avoid the heap
+  Eigen::Matrix<double, 3, Eigen::Dynamic, 0, 3, kMaxJoints> axes(3, n), origins(3, n);
+
+  Isometry3d T = Isometry3d::Identity();
+  for (int i=0; i<n; ++i) {
+    T = T*joints_[i].origin;
+    axes.col(i)    = T.linear()*joints_[i].axis;
+    origins.col(i) = T.translation();
+    T = T*GetMotion(joints_[i], q[i]);
+  }
+  Vector3d pos = T*tip_.translation();
+
+  for (int i=0; i<n; ++i) {
+    if (joints_[i].type == Revolute)
+      J.col(i) = axes.col(i).cross(pos - origins.col(i));
+    else
+      J.col(i) = axes.col(i);
+  }
+
+  return pos;
+}
+
+void
+KinematicChain::EnforceLimits (VectorXd& q) const
+{
+  for (int i=0; i<int(joints_.size()); ++i)
+    q[i] = std::min(std::max(q[i], joints_[i].lower), joints_[i].upper);
+}
+
+} /* namespace xpp */
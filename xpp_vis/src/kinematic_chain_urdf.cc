@@ -0,0 +1,102 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <xpp_vis/kinematic_chain.h>
+
+#include <limits>
+#include <stdexcept>
+
+#include <urdf_model/model.h>
+
+namespace xpp {
+
+// kept apart from kinematic_chain.cc, so only this file depends on urdfdom.
+KinematicChain
+KinematicChain::FromUrdf (const urdf::ModelInterface& model,
+                          const std::string& root_link,
+                          const std::string& tip_link)
+{
+  auto link = model.getLink(tip_link);
+  if (!link)
+    throw std::runtime_error("xpp::KinematicChain: link " + tip_link + " not in URDF");
+
+  // walk up from the tip, then build the chain from the root downwards
+  std::vector<urdf::JointConstSharedPtr> joints;
+  while (link->name != root_link) {
+    if (!link->parent_joint)
+      throw std::runtime_error("xpp::KinematicChain: " + tip_link
+                               + " is not attached to " + root_link);
+    joints.push_back(link->parent_joint);
+    link = model.getLink(link->parent_joint->parent_link_name);
+  }
+
+  KinematicChain chain;
+  for (auto it = joints.rbegin(); it != joints.rend(); ++it) {
+    const urdf::Joint& j = **it;
+    const urdf::Pose& pose = j.parent_to_joint_origin_transform;
+
+    Isometry3d origin = Isometry3d::Identity();
+    origin.translation() << pose.position.x, pose.position.y, pose.position.z;
+    origin.linear() = Eigen::Quaterniond(pose.rotation.w, pose.rotation.x,
+                                         pose.rotation.y, pose.rotation.z).toRotationMatrix();
+
+    Joint joint;
+    joint.name   = j.name;
+    joint.origin = origin;
+    joint.axis   = Vector3d(j.axis.x, j.axis.y, j.axis.z);
+    joint.lower  = -std::numeric_limits<double>::infinity();
+    joint.upper  =  std::numeric_limits<double>::infinity();
+    if (j.limits && j.type != urdf::Joint::CONTINUOUS) {
+      joint.lower = j.limits->lower;
+      joint.upper = j.limits->upper;
+    }
+
+    switch (j.type) {
+      case urdf::Joint::FIXED:
+        chain.AddFixed(origin);
+        break;
+      case urdf::Joint::REVOLUTE:
+      case urdf::Joint::CONTINUOUS:
+        joint.type = Revolute;
+        chain.AddJoint(joint);
+        break;
+      case urdf::Joint::PRISMATIC:
+        joint.type = Prismatic;
+        chain.AddJoint(joint);
+        break;
+      default:
+        throw std::runtime_error("xpp::KinematicChain: joint " + j.name
+                                 + " is not fixed, revolute or prismatic");
+    }
+  }
+
+  return chain;
+}
+
+} /* namespace xpp */
@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <xpp_vis/rviz_robot_builder.h>
 
 #include <xpp_states/convert.h>
+#include <xpp_states/robot_state_cartesian_view.h>
 #include <xpp_vis/rviz_colors.h>
 
 namespace xpp {
@@ -62,43 +63,63 @@ RvizRobotBuilder::FillWithInvisible(int max_size, MarkerVec& vec) const
 RvizRobotBuilder::MarkerArray
 RvizRobotBuilder::BuildRobotState (const xpp_msgs::RobotStateCartesian& state_msg) const
 {
-  MarkerArray msg;
+  RobotStateCartesianView state(state_msg);
+  return BuildRobotState(state.GetBasePos(),
+                         state.GetBaseOri(),
+                         state.GetEEPositions(),
+                         state.GetEEForces(),
+                         state.GetContact());
+}
 
-  auto state = Convert::ToXpp(state_msg);
-  auto ee_pos = state.ee_motion_.Get(kPos);
+RvizRobotBuilder::MarkerArray
+RvizRobotBuilder::BuildRobotState (const RobotState& state) const
+{
+  return BuildRobotState(state.base_.lin.p_,
+                         state.base_.ang.q,
+                         state.ee_motion_.Get(kPos),
+                         state.ee_forces_,
+                         state.ee_contact_);
+}
+
+RvizRobotBuilder::MarkerArray
+RvizRobotBuilder::BuildRobotState (const Vector3d& base_pos,
+                                   const Eigen::Quaterniond& base_q,
+                                   const EEPos& ee_pos,
+                                   const EEForces& ee_forces,
+                                   const ContactState& contact) const
+{
+  MarkerArray msg;
 
-  Marker base = CreateBasePose(state.base_.lin.p_,
-                               state.base_.ang.q,
-                               state.ee_contact_);
+  Marker base = CreateBasePose(base_pos, base_q, contact);
   msg.markers.push_back(base);
 
-  MarkerVec m_ee_pos = CreateEEPositions(ee_pos, state.ee_contact_);
+  MarkerVec m_ee_pos = CreateEEPositions(ee_pos, contact);
   FillWithInvisible(max_ee_, m_ee_pos);
   msg.markers.insert(msg.markers.begin(), m_ee_pos.begin(), m_ee_pos.end());
 
-  MarkerVec ee_forces = CreateEEForces(state.ee_forces_, ee_pos, state.ee_contact_);
-  FillWithInvisible(max_ee_, ee_forces);
-  msg.markers.insert(msg.markers.begin(), ee_forces.begin(), ee_forces.end());
+  MarkerVec m_ee_forces = CreateEEForces(ee_forces, ee_pos, contact);
+  FillWithInvisible(max_ee_, m_ee_forces);
+  msg.markers.insert(msg.markers.begin(), m_ee_forces.begin(), m_ee_forces.end());
 
-  MarkerVec rom = CreateRangeOfMotion(state.base_);
+  MarkerVec rom = CreateRangeOfMotion(base_pos, base_q);
   FillWithInvisible(max_ee_, rom);
   msg.markers.insert(msg.markers.begin(), rom.begin(), rom.end());
 
-  MarkerVec support = CreateSupportArea(state.ee_contact_, ee_pos);
+  MarkerVec support = CreateSupportArea(contact, ee_pos);
   FillWithInvisible(max_ee_, support);
   msg.markers.insert(msg.markers.begin(), support.begin(), support.end());
 
-  MarkerVec friction = CreateFrictionCones(ee_pos, state.ee_contact_);
+  MarkerVec friction = CreateFrictionCones(ee_pos, contact);
   FillWithInvisible(max_ee_, friction);
   msg.markers.insert(msg.markers.begin(), friction.begin(), friction.end());
 
-  Marker cop = CreateCopPos(state.ee_forces_, ee_pos);
+  Marker cop = CreateCopPos(ee_forces, ee_pos);
   msg.markers.push_back(cop);
 
-  Marker ip = CreatePendulum(state.base_.lin.p_, state.ee_forces_, ee_pos);
+  Marker ip = CreatePendulum(base_pos, ee_forces, ee_pos);
   msg.markers.push_back(ip);
 
-  msg.markers.push_back(CreateGravityForce(state.base_.lin.p_));
+  msg.markers.push_back(CreateGravityForce(base_pos));
 
   int id = 0;
   for (Marker& m : msg.markers) {
@@ -109,6 +130,24 @@ RvizRobotBuilder::BuildRobotState (const xpp_msgs::RobotStateCartesian& state_ms
   return msg;
 }
 
+RvizRobotBuilder::Marker
+RvizRobotBuilder::BuildFootholds (const FootholdMap& footholds) const
+{
+  Marker m;
+  m.header.frame_id = frame_id_;
+  m.ns      = "footholds";
+  m.type    = Marker::SPHERE_LIST;
+  m.pose.orientation.w = 1.0;
+  m.scale.x = m.scale.y = m.scale.z = 0.03;
+  m.color   = color.brown;
+
+  m.points.reserve(footholds.GetCount());
+  for (const auto& f : footholds.GetFootholds())
+    m.points.push_back(Convert::ToRos<geometry_msgs::Point>(f.pos));
+
+  return m;
+}
+
 RvizRobotBuilder::MarkerVec
 RvizRobotBuilder::CreateEEPositions (const EEPos& ee_pos,
                                      const ContactState& in_contact) const
@@ -287,17 +326,18 @@ RvizRobotBuilder::CreatePendulum (const Vector3d& pos,
 }
 
 RvizRobotBuilder::MarkerVec
-RvizRobotBuilder::CreateRangeOfMotion (const State3d& base) const
+RvizRobotBuilder::CreateRangeOfMotion (const Vector3d& base_pos,
+                                       const Eigen::Quaterniond& base_ori) const
 {
   MarkerVec vec;
 
-  auto w_R_b = base.ang.q.toRotationMatrix();
+  auto w_R_b = base_ori.toRotationMatrix();
 
   for (const auto& pos_B : params_msg_.nominal_ee_pos) {
-    Vector3d pos_W = base.lin.p_ + w_R_b*Convert::ToXpp(pos_B);
+    Vector3d pos_W = base_pos + w_R_b*Convert::ToXpp(pos_B);
 
     Vector3d edge_length = 2*Convert::ToXpp(params_msg_.ee_max_dev);
-    Marker m  = CreateBox(pos_W, base.ang.q, edge_length);
+    Marker m  = CreateBox(pos_W, base_ori, edge_length);
     m.color   = color.blue;
     m.color.a = 0.2;
     m.ns      = "range_of_motion";
@@ -0,0 +1,139 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <xpp_vis/cached_inverse_kinematics.h>
+
+using namespace xpp;
+
+// "joint angles" are the endeffector positions, counting every solve.
+class CountingIK : public InverseKinematics {
+public:
+  Joints GetAllJointAngles(const EndeffectorsPos& pos_b) const override
+  {
+    n_calls++;
+    Joints q(pos_b.GetEECount(), 3);
+    for (auto ee : pos_b.GetEEsOrdered())
+      q.at(ee) = pos_b.at(ee);
+    return q;
+  }
+  int GetEECount() const override { return 2; };
+
+  mutable std::atomic<int> n_calls{0};
+};
+
+static EndeffectorsPos
+GetFeet (double x)
+{
+  EndeffectorsPos pos(2);
+  pos.at(0) = Eigen::Vector3d(x,  0.2, -0.5);
+  pos.at(1) = Eigen::Vector3d(x, -0.2, -0.5);
+  return pos;
+}
+
+TEST(CachedInverseKinematics, ReturnsStoredSolution)
+{
+  auto ik = std::make_shared<CountingIK>();
+  CachedInverseKinematics cache(ik, 1e-3);
+
+  Joints q1 = cache.GetAllJointAngles(GetFeet(0.1));
+  Joints q2 = cache.GetAllJointAngles(GetFeet(0.1));
+  Joints q3 = cache.GetAllJointAngles(GetFeet(0.1 + 0.2e-3)); // same grid cell
+  Joints q4 = cache.GetAllJointAngles(GetFeet(0.1 + 2e-3));
+
+  EXPECT_EQ(2, ik->n_calls);
+  EXPECT_EQ(q1.ToVec(), q2.ToVec());
+  EXPECT_EQ(q1.ToVec(), q3.ToVec());
+  EXPECT_NE(q1.ToVec(), q4.ToVec());
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(2, stats.hits);
+  EXPECT_EQ(2, stats.misses);
+  EXPECT_DOUBLE_EQ(0.5, stats.GetHitRate());
+
+  cache.Clear();
+  cache.ResetStats();
+  cache.GetAllJointAngles(GetFeet(0.1));
+  EXPECT_EQ(3, ik->n_calls);
+  EXPECT_EQ(0, cache.GetStats().hits);
+}
+
+TEST(CachedInverseKinematics, EvictsLeastRecentlyUsed)
+{
+  auto ik = std::make_shared<CountingIK>();
+  CachedInverseKinematics cache(ik, 1e-3, 8); // a single set of 8 entries
+
+  for (int i=0; i<8; ++i)
+    cache.GetAllJointAngles(GetFeet(0.01*i));
+  cache.GetAllJointAngles(GetFeet(0.0)); // now entry 1 is the oldest
+  EXPECT_EQ(8, ik->n_calls);
+  EXPECT_EQ(0, cache.GetStats().evictions);
+
+  cache.GetAllJointAngles(GetFeet(0.5));
+  EXPECT_EQ(1, cache.GetStats().evictions);
+
+  cache.GetAllJointAngles(GetFeet(0.0));
+  EXPECT_EQ(9, ik->n_calls);
+  cache.GetAllJointAngles(GetFeet(0.01));
+  EXPECT_EQ(10, ik->n_calls);
+}
+
+// a looping bag solves every state once, then only reads.
+TEST(CachedInverseKinematics, ConcurrentLoops)
+{
+  auto ik = std::make_shared<CountingIK>();
+  CachedInverseKinematics cache(ik, 1e-4, 4096);
+
+  int n_states = 500, n_loops = 20;
+  std::atomic<int> wrong(0);
+  std::vector<std::thread> threads;
+  for (int t=0; t<4; ++t) {
+    threads.emplace_back([&]() {
+      for (int loop=0; loop<n_loops; ++loop) {
+        for (int k=0; k<n_states; ++k) {
+          EndeffectorsPos pos = GetFeet(0.001*k);
+          Joints q = cache.GetAllJointAngles(pos);
+          if ((q.at(0) - pos.at(0)).norm() > 1e-4)
+            wrong++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(0, wrong);
+  EXPECT_GT(cache.GetStats().GetHitRate(), 0.95);
+  EXPECT_LE(ik->n_calls, 4*n_states);
+}
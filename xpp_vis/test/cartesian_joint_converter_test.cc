@@ -0,0 +1,188 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+
+#include <xpp_states/convert.h>
+#include <xpp_vis/cartesian_joint_converter.h>
+
+using namespace xpp;
+
+// "joint angles" are the endeffector positions in base frame.
+class PositionIK : public InverseKinematics {
+public:
+  Joints GetAllJointAngles(const EndeffectorsPos& pos_b) const override
+  {
+    Joints q(pos_b.GetEECount(), 3);
+    for (auto ee : pos_b.GetEEsOrdered())
+      q.at(ee) = pos_b.at(ee);
+    return q;
+  }
+  int GetEECount() const override { return 2; };
+};
+
+static xpp_msgs::RobotStateCartesianTrajectory
+GetTrajectory (int n)
+{
+  std::vector<RobotStateCartesian> states;
+  for (int k=0; k<n; ++k) {
+    RobotStateCartesian state(2);
+    state.t_global_ = 0.001*k;
+    state.base_.lin.p_ << 0.001*k, 0.0, 0.5;
+    state.base_.ang.q = GetQuaternionFromEulerZYX(0.001*k, 0.0, 0.0);
+    state.ee_motion_.at(0).p_ << 0.3, 0.2, 0.0;
+    state.ee_motion_.at(1).p_ << 0.3, -0.2, 0.01*k;
+    states.push_back(state);
+  }
+  return Convert::ToRos(states);
+}
+
+TEST(CartesianJointConverter, GetJointTrajectory)
+{
+  PositionIK ik;
+  auto msg = GetTrajectory(5000); // converted by multiple threads
+
+  Eigen::MatrixXd q;
+  CartesianJointConverter::GetJointTrajectory(ik, msg, q);
+  ASSERT_EQ(6, q.rows());
+  ASSERT_EQ(msg.points.size(), q.cols());
+
+  for (int k : {0, 1, 2500, 4999}) {
+    auto state = Convert::ToXpp(msg.points.at(k));
+    Eigen::VectorXd q_k = CartesianJointConverter::GetJointAngles(ik,
+        state.base_.lin.p_, state.base_.ang.q, state.ee_motion_.Get(kPos));
+    EXPECT_TRUE(q.col(k).isApprox(q_k)) << k;
+
+    // the foot expressed in the base frame
+    Vector3d ee_B = state.base_.ang.q.inverse()*(state.ee_motion_.at(1).p_ - state.base_.lin.p_);
+    EXPECT_TRUE(q.col(k).tail(3).isApprox(ee_B)) << k;
+  }
+
+  // reused for the same size
+  const double* data = q.data();
+  CartesianJointConverter::GetJointTrajectory(ik, msg, q);
+  EXPECT_EQ(data, q.data());
+
+  CartesianJointConverter::GetJointTrajectory(ik, GetTrajectory(0), q);
+  EXPECT_EQ(0, q.cols());
+}
+
+// as above, so the Jacobians are identities.
+class PositionIKWithJacobians : public PositionIK {
+public:
+  Jacobians GetJacobians(const Joints& q) const override
+  {
+    Jacobians J(q.GetEECount());
+    J.SetAll(Eigen::MatrixXd::Identity(3,3));
+    return J;
+  }
+  Jacobians GetJacobianDerivatives(const Joints& q, const Joints& qd) const override
+  {
+    Jacobians Jd(q.GetEECount());
+    Jd.SetAll(Eigen::MatrixXd::Zero(3,3));
+    return Jd;
+  }
+};
+
+// base rotating with constant angular velocity and accelerating, foot moving in world.
+static RobotStateCartesian
+GetRotatingState (double t)
+{
+  RobotStateCartesian state(1);
+  double yaw_rate = 0.8;
+  state.t_global_ = t;
+  state.base_.lin.p_ << 0.1*t*t, 0.2*t, 0.5;
+  state.base_.lin.v_ << 0.2*t,   0.2,   0.0;
+  state.base_.lin.a_ << 0.2,     0.0,   0.0;
+  state.base_.ang.q  = GetQuaternionFromEulerZYX(yaw_rate*t, 0.0, 0.0);
+  state.base_.ang.w  << 0.0, 0.0, yaw_rate;
+  state.ee_motion_.at(0).p_ << 0.3+0.5*t, -0.2, 0.1*t*t*t;
+  state.ee_motion_.at(0).v_ << 0.5,        0.0, 0.3*t*t;
+  state.ee_motion_.at(0).a_ << 0.0,        0.0, 0.6*t;
+  state.ee_forces_.at(0) << 10.0, 0.0, 100.0;
+  state.ee_contact_.at(0) = true;
+  return state;
+}
+
+TEST(CartesianJointConverter, GetJointState)
+{
+  PositionIKWithJacobians ik;
+  double t = 0.7, h = 1e-4;
+
+  RobotStateJoint joint, joint_prev, joint_next;
+  CartesianJointConverter::GetJointState(ik, GetRotatingState(t),   joint);
+  CartesianJointConverter::GetJointState(ik, GetRotatingState(t-h), joint_prev);
+  CartesianJointConverter::GetJointState(ik, GetRotatingState(t+h), joint_next);
+  ASSERT_EQ(3, joint.q_.GetNumJoints());
+  EXPECT_TRUE(joint.ee_contact_.at(0));
+  EXPECT_DOUBLE_EQ(t, joint.t_global_);
+
+  // the joint derivatives must match the change of the joint angles over time
+  Eigen::VectorXd qd_diff  = (joint_next.q_.ToVec() - joint_prev.q_.ToVec())/(2*h);
+  Eigen::VectorXd qdd_diff = (joint_next.q_.ToVec() - 2*joint.q_.ToVec() + joint_prev.q_.ToVec())/(h*h);
+  EXPECT_LT((joint.qd_.ToVec()  - qd_diff).norm(),  1e-6);
+  EXPECT_LT((joint.qdd_.ToVec() - qdd_diff).norm(), 1e-4);
+
+  // the force the foot must push the ground with, expressed in base frame
+  Eigen::Matrix3d B_R_W = GetRotatingState(t).base_.ang.q.toRotationMatrix().transpose();
+  Eigen::Vector3d tau_expected = -(B_R_W*Eigen::Vector3d(10.0, 0.0, 100.0));
+  EXPECT_LT((joint.torques_.ToVec() - tau_expected).norm(), 1e-9);
+}
+
+TEST(CartesianJointConverter, GetJointStateFromView)
+{
+  PositionIKWithJacobians ik;
+  auto cart = GetRotatingState(0.7);
+  auto msg  = Convert::ToRos(cart);
+
+  RobotStateJoint joint, joint_view;
+  CartesianJointConverter::GetJointState(ik, cart, joint);
+  CartesianJointConverter::GetJointState(ik, RobotStateCartesianView(msg), joint_view);
+
+  EXPECT_TRUE(joint_view.q_.ToVec().isApprox(joint.q_.ToVec()));
+  EXPECT_TRUE(joint_view.qd_.ToVec().isApprox(joint.qd_.ToVec()));
+  EXPECT_TRUE(joint_view.qdd_.ToVec().isApprox(joint.qdd_.ToVec()));
+  EXPECT_TRUE(joint_view.torques_.ToVec().isApprox(joint.torques_.ToVec()));
+  EXPECT_EQ(joint.ee_contact_, joint_view.ee_contact_);
+  EXPECT_DOUBLE_EQ(joint.t_global_, joint_view.t_global_);
+}
+
+TEST(CartesianJointConverter, GetJointStateWithoutJacobians)
+{
+  PositionIK ik;
+  RobotStateJoint joint;
+  CartesianJointConverter::GetJointState(ik, GetRotatingState(0.7), joint);
+
+  EXPECT_EQ(3, joint.q_.GetNumJoints());
+  EXPECT_DOUBLE_EQ(0.0, joint.qd_.ToVec().norm());
+  EXPECT_DOUBLE_EQ(0.0, joint.torques_.ToVec().norm());
+}
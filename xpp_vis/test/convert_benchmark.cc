@@ -0,0 +1,270 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <dlfcn.h>
+
+#include <gtest/gtest.h>
+
+#include <xpp_states/convert.h>
+#include <xpp_states/robot_state_cartesian_view.h>
+
+// counts every heap allocation made by this test executable. Replacing
+// malloc and calloc covers operator new as well as dynamic Eigen types,
+// whose zero initialization the compiler may turn into a calloc.
+static std::atomic<long> n_allocations(0);
+
+extern "C" void* malloc(std::size_t size)
+{
+  using MallocFn = void* (*)(std::size_t);
+  static MallocFn next_malloc = nullptr;
+  if (!next_malloc)
+    next_malloc = reinterpret_cast<MallocFn>(dlsym(RTLD_NEXT, "malloc"));
+
+  n_allocations++;
+  return next_malloc(size);
+}
+
+extern "C" void* calloc(std::size_t n, std::size_t size)
+{
+  using CallocFn = void* (*)(std::size_t, std::size_t);
+  static CallocFn next_calloc = nullptr;
+  static bool resolving = false;
+  if (!next_calloc) {
+    if (resolving)
+      return nullptr; // dlsym itself may calloc, but copes with a failure
+    resolving = true;
+    next_calloc = reinterpret_cast<CallocFn>(dlsym(RTLD_NEXT, "calloc"));
+  }
+
+  n_allocations++;
+  return next_calloc(n, size);
+}
+
+using namespace xpp;
+
+static const EndeffectorID quad_ee = 2;
+
+static xpp_msgs::RobotStateCartesianTrajectory
+BuildTrajectoryMsg (int n_states, int n_ee)
+{
+  xpp_msgs::RobotStateCartesianTrajectory traj;
+  for (int i=0; i<n_states; ++i) {
+    xpp_msgs::RobotStateCartesian state;
+    state.time_from_start = ros::Duration(0.01*i);
+    state.base.pose.position.z = 0.5;
+    state.ee_motion.resize(n_ee);
+    state.ee_forces.resize(n_ee);
+    state.ee_contact.resize(n_ee, true);
+    traj.points.push_back(state);
+  }
+  return traj;
+}
+
+TEST(ConvertBenchmark, StateLinAllocations)
+{
+  const int n = 10000;
+
+  // reserve up front, so only the allocations of the states are counted.
+  std::vector<StateLinXd> states_xd;
+  states_xd.reserve(n);
+  std::vector<StateLin3d> states_3d;
+  states_3d.reserve(n);
+
+  long start = n_allocations;
+  for (int i=0; i<n; ++i)
+    states_xd.emplace_back(kDim3d);
+  long allocs_xd = n_allocations - start;
+
+  start = n_allocations;
+  for (int i=0; i<n; ++i)
+    states_3d.emplace_back();
+  long allocs_3d = n_allocations - start;
+
+  std::cout << "allocations per state: StateLinXd(3)=" << double(allocs_xd)/n
+            << ", StateLin3d=" << double(allocs_3d)/n << std::endl;
+
+  EXPECT_EQ(3*n, allocs_xd); // position, velocity and acceleration
+  EXPECT_EQ(0, allocs_3d);
+}
+
+TEST(ConvertBenchmark, StateLinToXpp)
+{
+  const int n = 10000;
+  xpp_msgs::StateLin3d msg;
+  std::vector<StateLin3d> states;
+  states.reserve(n);
+
+  long start = n_allocations;
+  for (int i=0; i<n; ++i) {
+    msg.pos.x = i;
+    states.push_back(Convert::ToXpp(msg));
+  }
+
+  EXPECT_EQ(0, n_allocations - start);
+}
+
+TEST(ConvertBenchmark, RobotStateToXpp)
+{
+  auto msg = BuildTrajectoryMsg(1, 4).points.front();
+  RobotStateCartesian state(0);
+
+  long start = n_allocations;
+  for (int i=0; i<1000; ++i) {
+    msg.base.pose.position.x = i;
+    state = Convert::ToXpp(msg);
+    state.ee_motion_.Get(kPos);
+  }
+
+  EXPECT_EQ(0, n_allocations - start);
+}
+
+TEST(ConvertBenchmark, TrajectoryToXpp)
+{
+  const int n_states = 10000;
+  const int n_ee = 4;
+  auto traj_msg = BuildTrajectoryMsg(n_states, n_ee);
+
+  long start = n_allocations;
+  auto t_start = std::chrono::steady_clock::now();
+  auto traj = Convert::ToXpp(traj_msg);
+  auto t_end = std::chrono::steady_clock::now();
+  long allocs = n_allocations - start;
+
+  double ms = std::chrono::duration<double, std::milli>(t_end-t_start).count();
+  std::cout << "Convert::ToXpp of " << n_states << " states with " << n_ee
+            << " endeffectors: " << ms << " ms, "
+            << double(allocs)/n_states << " allocations per state" << std::endl;
+
+  ASSERT_EQ(n_states, traj.size());
+  // only the vector of states and the worker threads allocate, not the states.
+  EXPECT_GT(0.01, double(allocs)/n_states);
+}
+
+TEST(ConvertBenchmark, ColumnarForceScan)
+{
+  const int n_states = 10000;
+  const int n_ee = 4;
+  auto traj_msg = BuildTrajectoryMsg(n_states, n_ee);
+  for (int k=0; k<n_states; ++k)
+    traj_msg.points.at(k).ee_forces.at(quad_ee).z = k;
+
+  auto states = Convert::ToXpp(traj_msg);
+  CartesianTrajectory columns;
+  Convert::ToXpp(traj_msg, columns);
+
+  auto t_start = std::chrono::steady_clock::now();
+  double max_rows = 0.0;
+  for (const auto& state : states)
+    max_rows = std::max(max_rows, state.ee_forces_.at(quad_ee).z());
+  auto t_rows = std::chrono::steady_clock::now();
+  double max_columns = columns.GetEEForce(quad_ee, Z).maxCoeff();
+  auto t_columns = std::chrono::steady_clock::now();
+
+  std::cout << "max z-force over " << n_states << " states: "
+            << std::chrono::duration<double, std::micro>(t_rows-t_start).count()
+            << " us (vector of states), "
+            << std::chrono::duration<double, std::micro>(t_columns-t_rows).count()
+            << " us (columnar)" << std::endl;
+
+  EXPECT_DOUBLE_EQ(n_states-1, max_rows);
+  EXPECT_DOUBLE_EQ(max_rows, max_columns);
+
+  // converting back must reproduce the message
+  auto msg = Convert::ToRos(columns);
+  ASSERT_EQ(n_states, msg.points.size());
+  EXPECT_DOUBLE_EQ(n_states-1, msg.points.back().ee_forces.at(quad_ee).z);
+  EXPECT_DOUBLE_EQ(0.5, msg.points.back().base.pose.position.z);
+}
+
+TEST(ConvertBenchmark, TrajectoryInPlace)
+{
+  const int n_states = 100; // below threading threshold, so single-threaded
+  const int n_ee = 4;
+  auto traj_msg = BuildTrajectoryMsg(n_states, n_ee);
+
+  std::vector<RobotStateCartesian> states;
+  xpp_msgs::RobotStateCartesianTrajectory msg_out;
+  Convert::ToXpp(traj_msg, states);
+  Convert::ToRos(states, msg_out);
+
+  // repeated conversions into the same outputs reuse their memory
+  long start = n_allocations;
+  for (int i=0; i<100; ++i) {
+    traj_msg.points.back().base.pose.position.x = i;
+    Convert::ToXpp(traj_msg, states);
+    Convert::ToRos(states, msg_out);
+  }
+
+  EXPECT_EQ(0, n_allocations - start);
+  EXPECT_DOUBLE_EQ(99, msg_out.points.back().base.pose.position.x);
+  EXPECT_DOUBLE_EQ(0.5, states.front().base_.lin.p_.z());
+}
+
+TEST(ConvertBenchmark, TrajectoryParallel)
+{
+  const int n_states = 20*Convert::kMinPointsPerThread;
+  const int n_ee = 4;
+  auto traj_msg = BuildTrajectoryMsg(n_states, n_ee);
+  for (int k=0; k<n_states; ++k)
+    traj_msg.points.at(k).ee_forces.at(quad_ee).z = k;
+
+  std::vector<RobotStateCartesian> states;
+  auto t_start = std::chrono::steady_clock::now();
+  Convert::ToXpp(traj_msg, states);
+  auto t_end = std::chrono::steady_clock::now();
+
+  std::cout << "Convert::ToXpp in-place of " << n_states << " states: "
+            << std::chrono::duration<double, std::milli>(t_end-t_start).count()
+            << " ms" << std::endl;
+
+  ASSERT_EQ(n_states, states.size());
+  for (int k=0; k<n_states; ++k)
+    ASSERT_DOUBLE_EQ(k, states.at(k).ee_forces_.at(quad_ee).z());
+
+  auto msg = Convert::ToRos(states);
+  ASSERT_EQ(n_states, msg.points.size());
+  EXPECT_DOUBLE_EQ(n_states-1, msg.points.back().ee_forces.at(quad_ee).z);
+}
+
+TEST(ConvertBenchmark, RobotStateViewAllocations)
+{
+  auto msg = BuildTrajectoryMsg(1, 4).points.front();
+
+  long start = n_allocations;
+  RobotStateCartesianView view(msg);
+  auto ee_pos = view.GetEEPositions();
+  auto contact = view.GetContact();
+  EXPECT_EQ(0, n_allocations - start);
+
+  EXPECT_EQ(4, ee_pos.GetEECount());
+  EXPECT_EQ(4, contact.GetEECount());
+}
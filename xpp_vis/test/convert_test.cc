@@ -0,0 +1,115 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <xpp_states/convert.h>
+#include <xpp_states/robot_state_cartesian_view.h>
+
+using namespace xpp;
+
+static const EndeffectorID quad_ee = 2;
+
+static xpp_msgs::RobotStateCartesianTrajectory
+BuildTrajectoryMsg (int n_states, int n_ee)
+{
+  xpp_msgs::RobotStateCartesianTrajectory traj;
+  for (int i=0; i<n_states; ++i) {
+    xpp_msgs::RobotStateCartesian state;
+    state.time_from_start = ros::Duration(0.01*i);
+    state.base.pose.position.z = 0.5;
+    state.ee_motion.resize(n_ee);
+    state.ee_forces.resize(n_ee);
+    state.ee_contact.resize(n_ee, true);
+    traj.points.push_back(state);
+  }
+  return traj;
+}
+
+TEST(Convert, ColumnarMalformed)
+{
+  auto traj_msg = BuildTrajectoryMsg(10, 4);
+  traj_msg.points.at(5) = BuildTrajectoryMsg(1, 5).points.front(); // more endeffectors
+
+  CartesianTrajectory columns;
+  EXPECT_THROW(Convert::ToXpp(traj_msg, columns), std::invalid_argument);
+
+  traj_msg.points.at(5) = traj_msg.points.at(4);
+  traj_msg.points.at(5).ee_contact.pop_back();
+  EXPECT_THROW(Convert::ToXpp(traj_msg, columns), std::invalid_argument);
+}
+
+TEST(Convert, TrajectoryParallelThrows)
+{
+  const int n_states = 20*Convert::kMinPointsPerThread;
+  auto traj_msg = BuildTrajectoryMsg(n_states, 4);
+  traj_msg.points.at(n_states/2).ee_forces.pop_back(); // malformed point
+
+  std::vector<RobotStateCartesian> states;
+  EXPECT_THROW(Convert::ToXpp(traj_msg, states), std::out_of_range);
+
+  traj_msg.points.at(n_states/2).ee_motion.resize(kMaxEndeffectors+1);
+  EXPECT_THROW(Convert::ToXpp(traj_msg, states), std::length_error);
+}
+
+TEST(Convert, RobotStateView)
+{
+  auto msg = BuildTrajectoryMsg(1, 4).points.front();
+  msg.base.pose.orientation.x = 0.5;
+  msg.base.pose.orientation.w = 0.5;
+  msg.ee_motion.at(quad_ee).pos.y = 0.3;
+  msg.ee_forces.at(quad_ee).z = 100.0;
+  msg.ee_contact.at(quad_ee) = false;
+
+  RobotStateCartesianView view(msg);
+
+  // the view maps onto the message instead of copying it
+  EXPECT_EQ(&msg.base.pose.position.x, view.GetBasePos().data());
+  EXPECT_EQ(&msg.ee_forces.at(quad_ee).x, view.GetEEForce(quad_ee).data());
+
+  auto state = Convert::ToXpp(msg);
+  EXPECT_EQ(state.base_.lin.p_, view.GetBasePos());
+  EXPECT_EQ(state.base_.ang.q.coeffs(), view.GetBaseOri().coeffs());
+  EXPECT_EQ(state.ee_motion_.at(quad_ee).p_, view.GetEEPositions().at(quad_ee));
+  EXPECT_EQ(state.ee_forces_.at(quad_ee), view.GetEEForce(quad_ee));
+  EXPECT_EQ(state.ee_contact_, view.GetContact());
+  EXPECT_FALSE(view.IsInContact(quad_ee));
+}
+
+TEST(Convert, CompactMalformed)
+{
+  auto compact = Convert::ToRosCompact(Convert::ToXpp(BuildTrajectoryMsg(1, 4).points.front()));
+  compact.base_ori = {0.0f, 0.0f, 0.0f, 0.0f};
+
+  auto state = Convert::ToXpp(compact);
+  EXPECT_EQ(Eigen::Vector4d::Zero(), state.base_.ang.q.coeffs()); // no NaN
+
+  compact.ee_forces.resize(3*2);
+  EXPECT_THROW(Convert::ToXpp(compact), std::length_error);
+}
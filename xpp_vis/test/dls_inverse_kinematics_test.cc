@@ -0,0 +1,309 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+#include <xpp_states/convert.h>
+#include <xpp_vis/cartesian_joint_converter.h>
+#include <xpp_vis/dls_inverse_kinematics.h>
+
+using namespace xpp;
+using Joint = KinematicChain::Joint;
+
+static Joint
+GetJoint (const std::string& name, const Eigen::Vector3d& xyz, const Eigen::Vector3d& rpy,
+          double lower, double upper)
+{
+  Joint joint;
+  joint.name   = name;
+  joint.type   = KinematicChain::Revolute;
+  joint.origin = KinematicChain::GetTransform(xyz, rpy);
+  joint.axis   = Eigen::Vector3d::UnitZ();
+  joint.lower  = lower;
+  joint.upper  = upper;
+  return joint;
+}
+
+// the left-front leg as in xpp_hyq/urdf/hyq.urdf.xacro.
+static KinematicChain
+GetHyqLegLF ()
+{
+  KinematicChain leg;
+  leg.AddFixed(KinematicChain::GetTransform(Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero()));
+  leg.AddJoint(GetJoint("lf_haa_joint", {0.3735, 0.207, 0.0}, {0.0, M_PI/2, M_PI}, -7*M_PI/18, M_PI/6));
+  leg.AddJoint(GetJoint("lf_hfe_joint", {0.082, 0.0, 0.0}, {M_PI/2, 0.0, 0.0}, -10*M_PI/36, 14*M_PI/36));
+  leg.AddJoint(GetJoint("lf_kfe_joint", {0.35, 0.0, 0.0}, {0.0, 0.0, 0.0}, -14*M_PI/18, -M_PI/9));
+  leg.AddFixed(KinematicChain::GetTransform({0.35, 0.0, 0.0}, {M_PI/2, 0.0, -M_PI/2}));
+  return leg;
+}
+
+// a 6-DOF arm with alternating joint axes.
+static KinematicChain
+GetArm ()
+{
+  KinematicChain arm;
+  arm.AddJoint(GetJoint("j1", {0.0, 0.0, 0.1}, {0.0, 0.0, 0.0},    -M_PI, M_PI));
+  arm.AddJoint(GetJoint("j2", {0.0, 0.0, 0.1}, {M_PI/2, 0.0, 0.0}, -M_PI/2, M_PI/2));
+  arm.AddJoint(GetJoint("j3", {0.4, 0.0, 0.0}, {0.0, 0.0, 0.0},    -M_PI, M_PI));
+  arm.AddJoint(GetJoint("j4", {0.3, 0.0, 0.0}, {0.0, M_PI/2, 0.0}, -M_PI, M_PI));
+  arm.AddJoint(GetJoint("j5", {0.0, 0.0, 0.1}, {0.0,-M_PI/2, 0.0}, -M_PI/2, M_PI/2));
+  arm.AddJoint(GetJoint("j6", {0.1, 0.0, 0.0}, {0.0, M_PI/2, 0.0}, -M_PI, M_PI));
+  arm.AddFixed(KinematicChain::GetTransform({0.0, 0.0, 0.05}, {0.0, 0.0, 0.0}));
+  return arm;
+}
+
+TEST(KinematicChain, JacobianMatchesFiniteDifferences)
+{
+  KinematicChain arm = GetArm();
+  Eigen::VectorXd q(6);
+  q << 0.3, -0.4, 1.1, 0.2, -0.7, 0.5;
+
+  Eigen::MatrixXd J;
+  Eigen::Vector3d pos = arm.GetPosition(q, J);
+  EXPECT_TRUE(pos.isApprox(arm.GetPosition(q)));
+  ASSERT_EQ(6, J.cols());
+
+  double h = 1e-6;
+  for (int j=0; j<6; ++j) {
+    Eigen::VectorXd dq = Eigen::VectorXd::Unit(6, j)*h;
+    Eigen::Vector3d diff = (arm.GetPosition(q+dq) - arm.GetPosition(q-dq))/(2*h);
+    EXPECT_LT((J.col(j) - diff).norm(), 1e-8) << j;
+  }
+}
+
+TEST(KinematicChain, HyqLegGeometry)
+{
+  KinematicChain leg = GetHyqLegLF();
+  ASSERT_EQ(3, leg.GetJointCount());
+  EXPECT_EQ("lf_kfe_joint", leg.GetJoint(2).name);
+
+  // fully stretched the foot is below the hip by the hip offset, thigh and shank
+  Eigen::Vector3d pos = leg.GetPosition(Eigen::Vector3d::Zero());
+  EXPECT_TRUE(pos.isApprox(Eigen::Vector3d(0.3735, 0.207, -0.082-0.7), 1e-9)) << pos.transpose();
+}
+
+static std::shared_ptr<DlsInverseKinematics>
+GetHyqLegIK ()
+{
+  auto ik = std::make_shared<DlsInverseKinematics>(std::vector<KinematicChain>{GetHyqLegLF()});
+  Joints q_nominal(1, 3);
+  q_nominal.at(0) = Eigen::Vector3d(0.0, 0.6, -1.2); // knee bent forward
+  ik->SetNominalJoints(q_nominal);
+  return ik;
+}
+
+// foot moving forward and up and down in a swing, sampled at 1kHz.
+static Eigen::Vector3d
+GetSwingPosition (double t)
+{
+  return Eigen::Vector3d(0.3735 + 0.1*std::sin(M_PI*t), 0.207 + 0.02*t, -0.6 + 0.08*std::sin(2*M_PI*t));
+}
+
+TEST(DlsInverseKinematics, ReachesFootholds)
+{
+  KinematicChain leg = GetHyqLegLF();
+  auto ik = GetHyqLegIK();
+  auto params = DlsInverseKinematics::GetDefaultParams();
+
+  for (double t=0.0; t<1.0; t+=0.1) {
+    EndeffectorsPos pos(1);
+    pos.at(0) = GetSwingPosition(t);
+
+    int iterations = 0;
+    Joints q = ik->GetAllJointAngles(pos, ik->GetNominalJoints(), &iterations);
+    EXPECT_LT((leg.GetPosition(q.at(0)) - pos.at(0)).norm(), params.tolerance) << t;
+    EXPECT_LT(iterations, params.max_iterations);
+    EXPECT_LT(q.at(0)[2], 0.0); // stays on the nominal knee bend
+  }
+}
+
+TEST(DlsInverseKinematics, ReachesWithRedundantArm)
+{
+  KinematicChain arm = GetArm();
+  DlsInverseKinematics ik({arm});
+  auto params = DlsInverseKinematics::GetDefaultParams();
+
+  Eigen::VectorXd q_des(6);
+  q_des << 0.5, 0.3, -1.0, 0.4, 0.8, -0.2;
+  EndeffectorsPos pos(1);
+  pos.at(0) = arm.GetPosition(q_des);
+
+  Joints q = ik.GetAllJointAngles(pos);
+  EXPECT_LT((arm.GetPosition(q.at(0)) - pos.at(0)).norm(), params.tolerance);
+}
+
+TEST(DlsInverseKinematics, UnreachableStaysWithinLimits)
+{
+  KinematicChain leg = GetHyqLegLF();
+  auto ik = GetHyqLegIK();
+
+  EndeffectorsPos pos(1);
+  pos.at(0) = Eigen::Vector3d(0.3735, 0.207, -2.0);
+
+  int iterations = 0;
+  Joints q = ik->GetAllJointAngles(pos, ik->GetNominalJoints(), &iterations);
+  EXPECT_EQ(DlsInverseKinematics::GetDefaultParams().max_iterations, iterations);
+  for (int i=0; i<3; ++i) {
+    EXPECT_GE(q.at(0)[i], leg.GetJoint(i).lower);
+    EXPECT_LE(q.at(0)[i], leg.GetJoint(i).upper);
+  }
+}
+
+TEST(DlsInverseKinematics, WarmStartNeedsFewerIterations)
+{
+  auto ik = GetHyqLegIK();
+  EndeffectorsPos pos(1);
+
+  int cold = 0, warm = 0, n = 1000;
+  for (int k=0; k<n; ++k) {
+    pos.at(0) = GetSwingPosition(k*0.001);
+
+    int iterations = 0;
+    ik->GetAllJointAngles(pos, ik->GetNominalJoints(), &iterations);
+    cold += iterations;
+
+    Joints q = ik->GetAllJointAngles(pos); // warm-started
+    ik->GetAllJointAngles(pos, q, &iterations);
+    EXPECT_EQ(0, iterations); // already converged
+  }
+
+  // the warm-started iterations of the trajectory itself
+  ik->ResetWarmStart();
+  Joints q_prev = ik->GetNominalJoints();
+  for (int k=0; k<n; ++k) {
+    pos.at(0) = GetSwingPosition(k*0.001);
+    int iterations = 0;
+    q_prev = ik->GetAllJointAngles(pos, q_prev, &iterations);
+    warm += iterations;
+  }
+
+  std::cout << "iterations per solve: cold=" << double(cold)/n
+            << ", warm=" << double(warm)/n << std::endl;
+  EXPECT_LT(warm, cold/2);
+  EXPECT_LE(warm, 2*n);
+}
+
+TEST(DlsInverseKinematics, TrajectoryIndependentOfWarmStart)
+{
+  auto ik = GetHyqLegIK();
+  auto params = DlsInverseKinematics::GetDefaultParams();
+
+  std::vector<RobotStateCartesian> states;
+  int n = 5000; // converted by multiple threads
+  for (int k=0; k<n; ++k) {
+    RobotStateCartesian state(1);
+    state.ee_motion_.at(0).p_ = GetSwingPosition(k*0.0002);
+    states.push_back(state);
+  }
+  auto msg = Convert::ToRos(states);
+
+  // warm start of e.g. the robot state topic
+  EndeffectorsPos pos(1);
+  pos.at(0) = GetSwingPosition(0.5);
+  Joints q_state = ik->GetAllJointAngles(pos);
+
+  Eigen::MatrixXd q1, q2;
+  CartesianJointConverter::GetJointTrajectory(*ik, msg, q1);
+  CartesianJointConverter::GetJointTrajectory(*ik, msg, q2);
+  EXPECT_EQ(q1, q2);
+
+  KinematicChain leg = GetHyqLegLF();
+  for (int k=0; k<n; ++k) {
+    EXPECT_LT((leg.GetPosition(q1.col(k)) - states.at(k).ee_motion_.at(0).p_).norm(),
+              params.tolerance) << k;
+    EXPECT_LT(q1(2,k), 0.0) << k; // stays on the nominal knee bend
+  }
+
+  // already converged from the untouched warm start
+  EXPECT_EQ(q_state.ToVec(), ik->GetAllJointAngles(pos).ToVec());
+}
+
+TEST(DlsInverseKinematics, Jacobians)
+{
+  DlsInverseKinematics ik({GetArm(), GetArm()});
+  Joints q(2, 6, 0.2);
+  auto J = ik.GetJacobians(q);
+  ASSERT_EQ(2, J.GetEECount());
+  EXPECT_EQ(3, J.at(1).rows());
+  EXPECT_EQ(6, J.at(1).cols());
+
+  EXPECT_THROW(DlsInverseKinematics({GetArm(), GetHyqLegLF()}), std::invalid_argument);
+}
+
+// one solve per control cycle must stay well within 1ms.
+TEST(DlsInverseKinematics, Timing)
+{
+  using Clock = std::chrono::steady_clock;
+  int n = 1000;
+
+  std::vector<KinematicChain> legs(4, GetHyqLegLF());
+  DlsInverseKinematics quad(legs);
+  Joints q_nominal(4, 3);
+  q_nominal.SetAll(Eigen::Vector3d(0.0, 0.6, -1.2));
+  quad.SetNominalJoints(q_nominal);
+
+  KinematicChain arm = GetArm();
+  DlsInverseKinematics arm_ik({arm});
+  Eigen::VectorXd q_arm(6);
+
+  for (bool warm : {false, true}) {
+    EndeffectorsPos pos_quad(4), pos_arm(1);
+    int iter_quad = 0, iter_arm = 0, iterations = 0;
+    Joints q_prev_quad = quad.GetNominalJoints();
+    Joints q_prev_arm  = arm_ik.GetNominalJoints();
+
+    auto start = Clock::now();
+    for (int k=0; k<n; ++k) {
+      pos_quad.SetAll(GetSwingPosition(k*0.001));
+      q_prev_quad = quad.GetAllJointAngles(pos_quad, warm? q_prev_quad : quad.GetNominalJoints(), &iterations);
+      iter_quad += iterations;
+    }
+    double us_quad = std::chrono::duration<double, std::micro>(Clock::now()-start).count()/n;
+
+    start = Clock::now();
+    for (int k=0; k<n; ++k) {
+      q_arm << 0.5+0.001*k, 0.3, -1.0, 0.4, 0.8, -0.2;
+      pos_arm.at(0) = arm.GetPosition(q_arm);
+      q_prev_arm = arm_ik.GetAllJointAngles(pos_arm, warm? q_prev_arm : arm_ik.GetNominalJoints(), &iterations);
+      iter_arm += iterations;
+    }
+    double us_arm = std::chrono::duration<double, std::micro>(Clock::now()-start).count()/n;
+
+    std::cout << (warm? "warm" : "cold") << " start: 4x3-DOF legs "
+              << us_quad << " us (" << double(iter_quad)/n << " iterations), 6-DOF arm "
+              << us_arm  << " us (" << double(iter_arm)/n  << " iterations)" << std::endl;
+    EXPECT_LT(us_quad, 1000.0);
+    EXPECT_LT(us_arm,  1000.0);
+  }
+}
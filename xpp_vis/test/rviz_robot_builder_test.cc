@@ -59,3 +59,15 @@ TEST(RvizRobotBuilder, BuildRobotState)
   // mostly checking for segfaults here
   EXPECT_FALSE(rviz_markers.markers.empty());
 }
+
+TEST(RvizRobotBuilder, BuildFootholds)
+{
+  FootholdMap footholds;
+  for (int step=0; step<100; ++step)
+    footholds.Add(Vector3d(0.3*step, 0.2, 0.0), 0, step);
+
+  auto m = RvizRobotBuilder().BuildFootholds(footholds);
+  EXPECT_EQ(RvizRobotBuilder::Marker::SPHERE_LIST, m.type);
+  ASSERT_EQ(100, m.points.size());
+  EXPECT_DOUBLE_EQ(0.3*99, m.points.back().x);
+}
@@ -0,0 +1,236 @@
+/******************************************************************************
+Copyright (c) 2017, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include <xpp_states/convert.h>
+#include <xpp_states/serialization.h>
+
+using namespace xpp;
+namespace ser = ros::serialization;
+
+template<typename T>
+static std::vector<uint8_t>
+Serialize(const T& t)
+{
+  ros::SerializedMessage m = ser::serializeMessage(t);
+  return std::vector<uint8_t>(m.buf.get(), m.buf.get()+m.num_bytes);
+}
+
+template<typename T>
+static void
+Deserialize(std::vector<uint8_t> buffer, T& t)
+{
+  // skip the length prefix, as roscpp does before deserializing
+  ser::IStream stream(buffer.data()+4, buffer.size()-4);
+  ser::deserialize(stream, t);
+}
+
+static RobotStateCartesian
+BuildCartesianState(double t)
+{
+  RobotStateCartesian state(4);
+  state.t_global_ = t;
+  state.base_.lin.p_ << 0.1, 0.2, 0.6;
+  state.base_.lin.v_ << 1.0, 0.0, 0.0;
+  state.base_.ang.q = Eigen::Quaterniond(Eigen::AngleAxisd(0.3, Vector3d::UnitZ()));
+  state.base_.ang.w << 0.0, 0.0, 0.5;
+  for (auto ee : state.ee_motion_.GetEEsOrdered()) {
+    state.ee_motion_.at(ee).p_ << ee, -double(ee), 0.0;
+    state.ee_motion_.at(ee).a_ << 0.0, 0.0, ee;
+    state.ee_forces_.at(ee) << 0.0, 0.0, 100.0+ee;
+  }
+  state.ee_contact_.at(1) = false;
+  return state;
+}
+
+TEST(Serialization, CartesianSameBytesAsMsg)
+{
+  auto state = BuildCartesianState(1.5);
+
+  auto bytes_xpp = Serialize(state);
+  EXPECT_EQ(bytes_xpp, Serialize(Convert::ToRos(state)));
+  EXPECT_STREQ(ros::message_traits::md5sum<xpp_msgs::RobotStateCartesian>(),
+               ros::message_traits::md5sum<RobotStateCartesian>());
+
+  RobotStateCartesian read(0);
+  Deserialize(bytes_xpp, read);
+  EXPECT_DOUBLE_EQ(state.t_global_, read.t_global_);
+  EXPECT_EQ(state.base_.lin, read.base_.lin);
+  EXPECT_EQ(state.base_.ang.q.coeffs(), read.base_.ang.q.coeffs());
+  EXPECT_EQ(state.ee_motion_.at(3), read.ee_motion_.at(3));
+  EXPECT_EQ(state.ee_forces_.at(2), read.ee_forces_.at(2));
+  EXPECT_EQ(state.ee_contact_, read.ee_contact_);
+}
+
+TEST(Serialization, TrajectorySameBytesAsMsg)
+{
+  RobotStateCartesianTrajectory traj;
+  for (int k=0; k<10; ++k)
+    traj.points.push_back(BuildCartesianState(0.1*k));
+
+  auto bytes_xpp = Serialize(traj);
+  EXPECT_EQ(bytes_xpp, Serialize(Convert::ToRos(traj.points)));
+  EXPECT_STREQ(ros::message_traits::md5sum<xpp_msgs::RobotStateCartesianTrajectory>(),
+               ros::message_traits::md5sum<RobotStateCartesianTrajectory>());
+
+  RobotStateCartesianTrajectory read;
+  Deserialize(bytes_xpp, read);
+  ASSERT_EQ(traj.points.size(), read.points.size());
+  EXPECT_DOUBLE_EQ(0.9, read.points.back().t_global_);
+  EXPECT_EQ(traj.points.back().ee_forces_.at(1), read.points.back().ee_forces_.at(1));
+
+  // plain vectors of states keep the default array serialization
+  std::vector<RobotStateCartesian> vec = traj.points;
+  EXPECT_NE(ser::serializationLength(traj), ser::serializationLength(vec));
+}
+
+TEST(Serialization, TrajectoryRoundTripThroughMsg)
+{
+  RobotStateCartesianTrajectory traj;
+  for (int k=0; k<3; ++k)
+    traj.points.push_back(BuildCartesianState(0.5*k));
+
+  // xpp -> message
+  xpp_msgs::RobotStateCartesianTrajectory msg;
+  Deserialize(Serialize(traj), msg);
+  ASSERT_EQ(3, msg.points.size());
+  const auto& p = msg.points.back();
+  EXPECT_DOUBLE_EQ(1.0, p.time_from_start.toSec());
+  EXPECT_DOUBLE_EQ(0.6, p.base.pose.position.z);
+  EXPECT_DOUBLE_EQ(traj.points.back().base_.ang.q.z(), p.base.pose.orientation.z);
+  EXPECT_DOUBLE_EQ(0.5, p.base.twist.angular.z);
+  ASSERT_EQ(4, p.ee_motion.size());
+  EXPECT_DOUBLE_EQ(-3.0, p.ee_motion.at(3).pos.y);
+  EXPECT_DOUBLE_EQ(3.0, p.ee_motion.at(3).acc.z);
+  EXPECT_DOUBLE_EQ(102.0, p.ee_forces.at(2).z);
+  EXPECT_FALSE(p.ee_contact.at(1));
+  EXPECT_TRUE(p.ee_contact.at(2));
+
+  // message -> xpp
+  msg.points.back().ee_forces.at(2).z = 50.0;
+  RobotStateCartesianTrajectory read;
+  Deserialize(Serialize(msg), read);
+  ASSERT_EQ(3, read.points.size());
+  EXPECT_DOUBLE_EQ(50.0, read.points.back().ee_forces_.at(2).z());
+  EXPECT_EQ(traj.points.back().ee_motion_.at(3), read.points.back().ee_motion_.at(3));
+  EXPECT_EQ(traj.points.back().ee_contact_, read.points.back().ee_contact_);
+}
+
+TEST(Serialization, CartesianWireLayout)
+{
+  RobotStateCartesian state(1);
+  state.t_global_ = 2.5;
+  state.base_.lin.p_ << 1, 2, 3;
+  state.base_.ang.q = Eigen::Quaterniond(0.5, 0.5, 0.5, 0.5); // w, x, y, z
+  state.ee_motion_.at(0).p_ << 4, 5, 6;
+  state.ee_forces_.at(0) << 7, 8, 9;
+  state.ee_contact_.at(0) = true;
+
+  // the bytes spelled out from RobotStateCartesian.msg
+  std::vector<uint8_t> expected;
+  auto append = [&](const void* data, size_t size) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    expected.insert(expected.end(), bytes, bytes+size);
+  };
+  auto append_u32 = [&](uint32_t v) { append(&v, sizeof(v)); };
+  auto append_dbl = [&](std::initializer_list<double> v) {
+    for (double d : v) append(&d, sizeof(d));
+  };
+
+  int32_t sec = 2, nsec = 500000000;
+  append(&sec, 4); append(&nsec, 4);         // time_from_start
+  append_dbl({1, 2, 3, 0.5, 0.5, 0.5, 0.5}); // base.pose (position, x y z w)
+  append_dbl({0, 0, 0, 0, 0, 0});            // base.twist
+  append_dbl({0, 0, 0, 0, 0, 0});            // base.accel
+  append_u32(1);                             // ee_motion
+  append_dbl({4, 5, 6, 0, 0, 0, 0, 0, 0});
+  append_u32(1);                             // ee_forces
+  append_dbl({7, 8, 9});
+  append_u32(1);                             // ee_contact
+  expected.push_back(1);
+
+  auto bytes = Serialize(state);
+  ASSERT_EQ(expected.size()+4, bytes.size()); // plus length prefix
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), bytes.begin()+4));
+}
+
+TEST(Serialization, JointSameBytesAsMsg)
+{
+  RobotStateJoint state(2, 3);
+  state.t_global_ = 0.25;
+  state.base_.lin.p_.z() = 0.5;
+  state.q_.SetFromVec((VectorXd(6) << 1, 2, 3, 4, 5, 6).finished());
+  state.torques_.SetAll(Vector3d(10, 20, 30));
+  state.ee_contact_.at(0) = false;
+
+  xpp_msgs::RobotStateJoint msg;
+  msg.time_from_start = ros::Duration(state.t_global_);
+  msg.base = Convert::ToRos(state.base_);
+  const VectorXd& q = state.q_.ToVec();
+  const VectorXd& qd = state.qd_.ToVec();
+  const VectorXd& tau = state.torques_.ToVec();
+  msg.joint_state.position.assign(q.data(), q.data()+q.size());
+  msg.joint_state.velocity.assign(qd.data(), qd.data()+qd.size());
+  msg.joint_state.effort.assign(tau.data(), tau.data()+tau.size());
+  msg.ee_contact = { false, true };
+
+  auto bytes_xpp = Serialize(state);
+  EXPECT_EQ(bytes_xpp, Serialize(msg));
+
+  RobotStateJoint read(0, 0);
+  Deserialize(bytes_xpp, read);
+  EXPECT_EQ(state.q_.ToVec(), read.q_.ToVec());
+  EXPECT_EQ(state.torques_.ToVec(), read.torques_.ToVec());
+  EXPECT_EQ(3, read.q_.GetNumJointsPerEE());
+  EXPECT_EQ(state.ee_contact_, read.ee_contact_);
+}
+
+TEST(Serialization, CompactHalvesSize)
+{
+  auto state = BuildCartesianState(1.5);
+
+  auto compact = Convert::ToRosCompact(state);
+  uint32_t size_full    = ser::serializationLength(Convert::ToRos(state));
+  uint32_t size_compact = ser::serializationLength(compact);
+  EXPECT_LT(size_compact, 0.55*size_full);
+
+  RobotStateCartesian read = Convert::ToXpp(compact);
+  EXPECT_DOUBLE_EQ(state.t_global_, read.t_global_);
+  EXPECT_TRUE(state.base_.lin.p_.isApprox(read.base_.lin.p_, 1e-6));
+  EXPECT_TRUE(state.base_.ang.q.isApprox(read.base_.ang.q, 1e-6));
+  EXPECT_NEAR(1.0, read.base_.ang.q.norm(), 1e-12);
+  for (auto ee : state.ee_motion_.GetEEsOrdered()) {
+    EXPECT_TRUE(state.ee_motion_.at(ee).p_.isApprox(read.ee_motion_.at(ee).p_, 1e-6));
+    EXPECT_TRUE(state.ee_forces_.at(ee).isApprox(read.ee_forces_.at(ee), 1e-6));
+  }
+  EXPECT_EQ(state.ee_contact_, read.ee_contact_);
+}